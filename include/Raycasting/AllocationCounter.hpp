@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+
+// Heap allocations per subsystem, compiled in with RAYCASTING_ALLOCATION_COUNTER only
+// ("make debug", "make benchmark"). Counted: operator new (replaced) and SDL's allocator
+// (hooked before SDL_Init). An allocation is charged to the subsystem of the innermost
+// AllocationScope of its thread (OpenMP workers: "other").
+enum class AllocationSubsystem
+{
+    other,
+    input,
+    simulation,
+    casting,
+    rendering,
+    sprites,
+    text,
+    count
+};
+
+class AllocationCounter
+{
+    public:
+    static void initialise();
+    static void reset();
+    static void recordAllocation();
+
+    static unsigned long long getNumberOfAllocations(const AllocationSubsystem subsystem);
+    static unsigned long long getNumberOfAllocations();
+    static const char *getSubsystemName(const AllocationSubsystem subsystem);
+
+#if defined(RAYCASTING_ALLOCATION_COUNTER)
+    static constexpr bool isEnabled() { return true; }
+#else
+    static constexpr bool isEnabled() { return false; }
+#endif
+
+    private:
+    friend class AllocationScope;
+
+    static std::atomic<unsigned long long> m_numberOfAllocations[(int)AllocationSubsystem::count];
+    static thread_local AllocationSubsystem m_currentSubsystem;
+};
+
+class AllocationScope
+{
+    public:
+#if defined(RAYCASTING_ALLOCATION_COUNTER)
+    inline explicit AllocationScope(const AllocationSubsystem subsystem)
+    {
+        m_previousSubsystem = AllocationCounter::m_currentSubsystem;
+        AllocationCounter::m_currentSubsystem = subsystem;
+    }
+    inline ~AllocationScope() { AllocationCounter::m_currentSubsystem = m_previousSubsystem; }
+
+    private:
+    AllocationSubsystem m_previousSubsystem;
+#else
+    inline explicit AllocationScope(const AllocationSubsystem) {}
+#endif
+};
\ No newline at end of file
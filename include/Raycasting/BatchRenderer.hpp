@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+#include "SDL.h"
+#include "MapManager.hpp"
+#include "Player.hpp"
+
+// One pixel of an observation: shaded color and distance to the camera plane
+struct ObservationPixel
+{
+    Uint8 r;
+    Uint8 g;
+    Uint8 b;
+    Uint8 a;
+    float depth;
+};
+
+// Renders many small first-person views (one per camera pose) over a shared,
+// read-only map into a single preallocated buffer laid out [view][row][col].
+// Views are spread across the OpenMP threads.
+class BatchRenderer
+{
+    public:
+    BatchRenderer(const unsigned int viewWidth, const unsigned int viewHeight, const unsigned int maxViews);
+    ~BatchRenderer();
+
+    bool render(const MapManager &mapManager, const PlayerState *poses, const unsigned int numberOfViews, const unsigned int fov = 90);
+
+    inline const ObservationPixel *getObservations() const { return m_observations; }
+    inline const ObservationPixel *getObservation(unsigned int view) const { return m_observations + view * m_viewWidth * m_viewHeight; }
+    inline unsigned int getViewWidth() const { return m_viewWidth; }
+    inline unsigned int getViewHeight() const { return m_viewHeight; }
+    inline unsigned int getMaxViews() const { return m_maxViews; }
+
+    private:
+    void renderView(const MapManager &mapManager, const double maximumHeight, const PlayerState &pose, ObservationPixel *view) const;
+
+    ObservationPixel *m_observations;
+    unsigned int m_viewWidth;
+    unsigned int m_viewHeight;
+    unsigned int m_maxViews;
+
+    std::vector<SDL_Color> m_texture;
+    std::vector<ObservationPixel> m_background;
+    std::vector<double> m_rayAngleOffsets;
+
+    const unsigned char TEXTURE_SIZE = 32;
+};
\ No newline at end of file
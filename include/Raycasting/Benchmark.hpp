@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "MapManager.hpp"
+#include "Player.hpp"
+
+// Headless micro benchmarks of the engine kernels (no window, no SDL calls)
+class Benchmark
+{
+    public:
+    Benchmark();
+
+    bool run(const std::string &name);
+
+    private:
+    bool runBatch();
+    bool runLidar();
+    bool runVisibilitySet();
+    bool runEntities();
+    bool runMapConnectivity();
+    bool runDoors();
+    bool runSpans();
+    bool runResolution();
+    bool runAdaptive();
+    bool runTemporal();
+    bool runColumns();
+    bool runTranspose();
+    bool runUpscale();
+    bool runGeometry();
+    bool runSimd();
+    bool runSprites();
+    bool runAllocations();
+    bool runStartup();
+    bool runOpenMaps();
+    bool runCapture();
+    bool runPacing();
+
+    void generateTestMaps(const unsigned int size, std::vector<char> &roomsCells, std::vector<char> &pillarsCells);
+    std::vector<PlayerState> generatePoses(MapManager &mapManager, const unsigned int count);
+
+    unsigned long long m_seed;
+};
\ No newline at end of file
@@ -1,13 +1,30 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "SDL.h"
 #include "SDL_ttf.h"
+#include "FrameArena.hpp"
+#include "FrameBuffer.hpp"
+#include "FrameCapture.hpp"
+#include "FramePacer.hpp"
+#include "FramePipeline.hpp"
+#include "GeometryBatch.hpp"
+#include "GlyphAtlas.hpp"
+#include "InputRecorder.hpp"
 #include "MapManager.hpp"
 #include "Player.hpp"
 #include "Raycaster.hpp"
+#include "ResolutionController.hpp"
+#include "SpriteManager.hpp"
+#include "SpscQueue.hpp"
+#include "StateBuffer.hpp"
+#include "Toolbox.hpp"
+#include "VisibilitySet.hpp"
 
 class Capp
 {
@@ -15,38 +32,178 @@ class Capp
     Capp();
     bool run();
 
+    inline void setRecordFile(const std::string &path) { m_recordPath = path; }
+    inline void setReplayFile(const std::string &path) { m_replayPath = path; }
+    inline void setCaptureFile(const std::string &path) { m_capturePath = path; }
+    inline void setHeadless(bool isHeadless) { m_isHeadless = isHeadless; }
+    // Headless replay drawn by a software renderer into a surface: the whole frame loop, no window
+    inline void setOffscreen(bool isOffscreen) { m_isOffscreen = isOffscreen; }
+    inline void setFixedTimestep(unsigned int dtMicroseconds) { m_fixedTimestepMicroseconds = dtMicroseconds; }
+    inline void setSimulationRate(unsigned int ticksPerSecond) { m_simulationRate = ticksPerSecond; }
+    inline void setPipelineDepth(unsigned int depth) { m_pipelineDepth = depth; }
+    inline void setFrameBudget(double budgetMilliseconds) { m_resolutionController.setBudget(budgetMilliseconds); }
+    inline void setAdaptiveStride(unsigned int stride) { m_raycaster.setAdaptiveStride(stride); m_framePipeline.setAdaptiveStride(stride); }
+    inline void setTemporal(bool isTemporal) { m_raycaster.setTemporal(isTemporal); m_framePipeline.setTemporal(isTemporal); }
+    inline void setIdleWait(bool isIdleWaitEnabled) { m_isIdleWaitEnabled = isIdleWaitEnabled; }
+    inline void setFrameBufferRendering(bool isFrameBufferEnabled) { m_isFrameBufferEnabled = isFrameBufferEnabled; }
+    inline void setGeometryRendering(bool isGeometryEnabled) { m_isGeometryEnabled = isGeometryEnabled; }
+    inline void setColumnMajor(bool isColumnMajor) { m_isColumnMajor = isColumnMajor; m_isFrameBufferEnabled |= isColumnMajor; }
+    inline void setUpscaleFilter(UpscaleFilter filter) { m_frameBuffer.setUpscaleFilter(filter); }
+    inline void setFrameRate(double framesPerSecond) { m_frameRate = framesPerSecond; }
+    inline void setVsync(bool isVsyncEnabled) { m_isVsyncEnabled = isVsyncEnabled; }
+    inline void setLateLatch(bool isLateLatchEnabled) { m_isLateLatchEnabled = isLateLatchEnabled; }
+    inline void setSpecialWalls(bool hasSpecialWalls) { m_hasSpecialWalls = hasSpecialWalls; }
+    inline void setCastPoses(std::vector<PlayerState> *castPoses) { m_castPoses = castPoses; }
+
+    // After run: frames, counted allocations (RAYCASTING_ALLOCATION_COUNTER) & frame arena overflows from the warm-up on
+    inline unsigned long long getNumberOfFrames() const { return m_numberOfFrames; }
+    inline unsigned long long getNumberOfAllocationsAfterWarmUp() const { return m_numberOfAllocationsAfterWarmUp; }
+    inline unsigned int getNumberOfArenaOverflowsAfterWarmUp() const { return m_numberOfArenaOverflowsAfterWarmUp; }
+    static const unsigned long long ALLOCATION_WARM_UP_FRAMES = 120;
+
     private:
     bool initialise();
 
     void input();
+    void processEvent(const SDL_Event &event);
+    void latchInput();
+    bool replayFrame();
     void update();
+    unsigned long long computeFrameVersion(unsigned int numberOfRays);
+    void updateFPS(unsigned long long elapsedTime);
+    void simulate(unsigned long long dt);
+    void simulationLoop();
     void render();
+    void recordLatency(double latency);
+    void printLatencyReport();
+    void printReplayReport();
+    void printAllocationReport();
+    void printCaptureReport();
 
     SDL_Window *m_window;
     SDL_Renderer *m_renderer;
     TTF_Font *m_font;
-    SDL_Surface *m_FPStextSurface;
-    SDL_Texture *m_FPStextTexture;
-    SDL_Rect m_FPStextTextureRect;
-    std::string m_FPSstring;
+    GlyphAtlas m_glyphAtlas;
+    static const unsigned int FPS_TEXT_CAPACITY = 64;
+    char m_FPStext[FPS_TEXT_CAPACITY];
     SDL_Color m_FPStextColor;
     unsigned int m_screenWidth;
     unsigned int m_screenHeight;
     Uint32 m_windowFlags;
-    bool m_isRunning;
+    std::atomic<bool> m_isRunning;
 
     std::chrono::high_resolution_clock::time_point m_previousTimePoint;
+    double m_simulationTime;
+    double m_renderTime;
+
+    // Record & replay
+    InputRecorder m_inputRecorder;
+    std::string m_recordPath;
+    std::string m_replayPath;
+    bool m_isHeadless;
+    bool m_isOffscreen;
+    SDL_Surface *m_offscreenSurface;
+    unsigned int m_fixedTimestepMicroseconds;
+    unsigned int m_replayTimestepMicroseconds;
+    unsigned long long m_castTimeTotal;
+    unsigned long long m_castTimeMin;
+    unsigned long long m_castTimeMax;
+    unsigned long long m_castRaysTotal;
+    std::vector<PlayerState> *m_castPoses; // Optional: every pose cast from (benchmarks replay recordings through it)
     
+    // Capture of the presented frames (PPM or Y4M stream), written by its own thread
+    FrameCapture m_frameCapture;
+    std::string m_capturePath;
+
+    // Fixed-timestep simulation thread (m_simulationRate == 0: simulate in the render loop)
+    struct SimulationSnapshot
+    {
+        PlayerState previous;
+        PlayerState current;
+        double time;
+        long long tickTimePoint;
+        // Mouse motion processed up to each state (live: the render pose adds the rest at once)
+        long long previousMouseMotion;
+        long long currentMouseMotion;
+    };
+    unsigned int m_simulationRate;
+    std::thread m_simulationThread;
+    StateBuffer<SimulationSnapshot> m_simulationState;
+    SpscQueue<SDL_Event, 256> m_eventQueue;
+    // Polled while the queue was full: handed over first on the next input, so none is lost or reordered
+    SDL_Event m_pendingEvent;
+    bool m_hasPendingEvent;
+
     MapManager m_mapManager;
+    bool m_hasSpecialWalls;
     Player m_player;
+    Player m_renderPlayer;
     Raycaster m_raycaster;
+    SpriteManager m_spriteManager;
+    VisibilitySet m_visibilitySet;
+
+    // Pipelined casting (m_pipelineDepth < 2: cast & submit serially)
+    FramePipeline m_framePipeline;
+    unsigned int m_pipelineDepth;
+
+    // Pacing (disabled without a frame rate, or vsync: the display's) & late input latching
+    FramePacer m_framePacer;
+    double m_frameRate;
+    bool m_isVsyncEnabled;
+    bool m_isLateLatchEnabled;
+    long long m_polledMouseMotion;
+    long long m_simulatedMouseMotion;
+
+    // Input sample to present latency, 0.1 ms bins
+    static const unsigned int LATENCY_HISTOGRAM_SIZE = 1000;
+    long long m_inputSampleTimePoint;
+    unsigned int m_latencyHistogram[LATENCY_HISTOGRAM_SIZE];
+    double m_latencyAverage;
+    double m_latencyTotal;
+    double m_latencyMax;
+    unsigned long long m_latencyFrameCount;
+
+    // Dirty frames: an unchanged frame version reuses the composed frame (live & not pipelined)
+    SDL_Texture *m_frameTexture;
+    unsigned long long m_frameVersion;
+    bool m_isFrameDirty;
+    std::atomic<bool> m_isPresentNeeded;
+    bool m_isIdleWaitEnabled;
+
+    // Software background & walls (column span kernels), uploaded once per frame
+    FrameBuffer m_frameBuffer;
+    bool m_isFrameBufferEnabled;
+    bool m_isColumnMajor;
+
+    // Background & walls as batched quads (SDL_RenderGeometry)
+    GeometryBatch m_geometryBatch;
+    bool m_isGeometryEnabled;
+    unsigned int m_numberOfDrawCalls;
+
+    // Transient per frame data (reset at the end of each loop), allocations counted after the warm-up
+    FrameArena m_frameArena;
+    unsigned long long m_numberOfFrames;
+    unsigned long long m_numberOfAllocationsAfterWarmUp;
+    unsigned int m_numberOfArenaOverflowsAtWarmUp;
+    unsigned int m_numberOfArenaOverflowsAfterWarmUp;
+
+    // Dynamic resolution (disabled without a frame budget)
+    ResolutionController m_resolutionController;
+
     double m_accelForward;
     double m_accelSide;
     double m_angularSpeed;
-    bool m_mouseMoved;
     bool m_isSprinting;
-    unsigned int m_fov;
+    bool m_isUsing;
+    std::atomic<unsigned int> m_fov;
 
     //const unsigned int DELTA_TIME_MILLISECONDS = 5;
     const unsigned char MINIMAP_SCALE_FACTOR = 4;
+    const unsigned int NUMBER_OF_SPRITES = 64;
+    const double USE_DISTANCE = 1;
+    const unsigned int IDLE_WAIT_MILLISECONDS = 100;
+    const size_t FRAME_ARENA_CAPACITY = 256 * 1024;
+    const unsigned int CAPTURE_FRAME_RATE = 60;
+    const double MOUSE_SENSITIVITY = 0.15 * Math::DEGREE_TO_RADIAN;
+    static const unsigned int LATCH_EVENT_CAPACITY = 32;
 };
\ No newline at end of file
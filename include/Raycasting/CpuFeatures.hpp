@@ -0,0 +1,37 @@
+#pragma once
+
+// Instruction set levels of the multi-versioned kernels (span fill, transpose, lidar
+// traversal). Every level is compiled into the binary (GCC/Clang target attributes), the
+// best one the CPU supports is selected once from CPUID. A lower level can be forced for
+// testing & benchmarking: "--simd <level>" or the RAYCASTING_SIMD environment variable.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define RAYCASTING_X86_DISPATCH
+#endif
+
+enum class SimdLevel
+{
+    scalar,
+    sse42,
+    avx2,
+    avx512
+};
+
+class CpuFeatures
+{
+    public:
+    static SimdLevel getLevel();
+    static SimdLevel getSupportedLevel();
+    // False if the CPU does not support the level
+    static bool setLevel(const SimdLevel level);
+    static bool setLevel(const char *name);
+
+    static const char *getLevelName(const SimdLevel level);
+    static bool parseLevel(const char *name, SimdLevel &level);
+
+    private:
+    static SimdLevel detectLevel();
+    static SimdLevel initialiseLevel();
+
+    static SimdLevel m_level;
+    static bool m_isInitialised;
+};
\ No newline at end of file
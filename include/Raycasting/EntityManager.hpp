@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+
+#include "MapManager.hpp"
+#include "Toolbox.hpp"
+
+// Moving entities (NPCs, projectiles...) stored as structure of arrays.
+// Each tick: integrate & sweep every entity against the map grid (in parallel),
+// update the spatial grid for the entities that changed cell, then push
+// overlapping entities apart and sweep those corrections too.
+class EntityManager
+{
+    public:
+    EntityManager();
+
+    // Sweep an axis aligned box (half size) by (dx, dy) through the grid, one axis
+    // after the other: every crossed cell is tested, so nothing tunnels through walls
+    static void moveAndCollide(const MapManager &mapManager, double &x, double &y, const double halfSize, const double dx, const double dy, bool &isXblocked, bool &isYblocked);
+
+    void initialiseEntities(const MapManager &mapManager);
+    unsigned int addEntity(const double x, const double y, const double halfSize, const double vx = 0, const double vy = 0);
+    // The last entity takes the index of the removed one
+    void removeEntity(const unsigned int entity);
+    void clear();
+    void update(const MapManager &mapManager, const double dt);
+
+    inline void setRestitution(const double restitution) { m_restitution = restitution; }
+    inline void setVelocity(unsigned int entity, double vx, double vy) { m_vx[entity] = vx; m_vy[entity] = vy; }
+    inline unsigned int getNumberOfEntities() const { return m_x.size(); }
+    inline double getX(unsigned int entity) const { return m_x[entity]; }
+    inline double getY(unsigned int entity) const { return m_y[entity]; }
+    inline unsigned int getNumberOfCellChanges() const { return m_numberOfCellChanges; }
+    inline unsigned int getNumberOfContacts() const { return m_numberOfContacts; }
+
+    private:
+    static bool isBlocked(const MapManager &mapManager, int x, int y);
+    inline unsigned int positionToCell(double x, double y) const { return Math::limitToInterval<int>(x, 0, m_gridWidth - 1) + Math::limitToInterval<int>(y, 0, m_gridHeight - 1) * m_gridWidth; }
+    void insertInCell(const unsigned int entity, const unsigned int cell);
+    void removeFromCell(const unsigned int entity);
+    void updateGrid();
+    void separateEntities(const MapManager &mapManager);
+
+    // Entities
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_vx;
+    std::vector<double> m_vy;
+    std::vector<double> m_halfSize;
+
+    // Spatial grid, one bucket per map cell, entities only move between buckets when they change cell
+    std::vector<std::vector<unsigned int>> m_cellEntities;
+    std::vector<unsigned int> m_entityCell;
+    std::vector<unsigned int> m_entitySlot;
+    std::vector<unsigned int> m_nextCell;
+    unsigned int m_gridWidth;
+    unsigned int m_gridHeight;
+
+    // Separation pushes, computed for all before being applied
+    std::vector<double> m_pushX;
+    std::vector<double> m_pushY;
+
+    double m_restitution;
+    unsigned int m_numberOfCellChanges;
+    unsigned int m_numberOfContacts;
+
+    const double COLLISION_EPSILON = 1e-6;
+    // Entities are at most one cell wide, neighbours are within the 3x3 cells around
+    const double MAX_HALF_SIZE = 0.5;
+};
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Linear allocator for the data that only lives during one frame, reset at the frame end.
+// Nothing is destroyed: trivially destructible types only. A request that does not fit is
+// served from the heap until the next reset, which then grows the arena to the frame's peak:
+// after the first frames, allocating is a pointer bump.
+class FrameArena
+{
+    public:
+    FrameArena();
+    ~FrameArena();
+
+    bool initialiseArena(const size_t capacity);
+    void reset();
+    void *allocate(const size_t size, const size_t alignment = alignof(std::max_align_t));
+    template <typename T>
+    inline T *allocateArray(const size_t count) { return (T *)allocate(count * sizeof(T), alignof(T)); }
+
+    inline size_t getCapacity() const { return m_capacity; }
+    inline size_t getUsed() const { return m_used; }
+    inline size_t getPeak() const { return m_peak; }
+    inline unsigned int getNumberOfOverflows() const { return m_numberOfOverflows; }
+
+    private:
+    void releaseBuffer();
+
+    unsigned char *m_buffer;
+    size_t m_capacity;
+    size_t m_used;
+    // Bytes asked since the reset, overflows included
+    size_t m_requested;
+    size_t m_peak;
+    unsigned int m_numberOfOverflows;
+    std::vector<void *> m_overflowBlocks;
+};
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+
+#include "SDL.h"
+
+// CPU frame (ARGB8888 pixels, row-major) uploaded to a streaming texture once per frame,
+// and the column span kernels drawing into it. Spans are clipped by the caller: the
+// kernels write exactly "count" pixels, "stride" pixels apart.
+// Column-major: columns are drawn contiguously into a scratch buffer, transposed into the
+// row-major frame (cache blocks, bands of rows in parallel) before the upload.
+// Scaled (dynamic resolution): fewer columns are drawn, the rows are upscaled to the frame
+// width (nearest or bilinear) before the upload.
+enum class UpscaleFilter
+{
+    nearest,
+    bilinear
+};
+
+class FrameBuffer
+{
+    public:
+    FrameBuffer();
+    ~FrameBuffer();
+
+    bool initialiseFrameBuffer(const unsigned int width, const unsigned int height, const bool isColumnMajor = false);
+    // Before the renderer is destroyed
+    void SDL_releaseTextures();
+    bool SDL_renderFrameBuffer(SDL_Renderer *renderer);
+    // Column-major: row-major frame from the drawn columns (done by SDL_renderFrameBuffer)
+    void transposeColumns();
+    // Columns drawn from now on (2 to the frame width), the frame width: not scaled
+    void setDrawWidth(const unsigned int drawWidth);
+    void setUpscaleFilter(const UpscaleFilter filter);
+    // Scaled: frame from the drawn rows (done by SDL_renderFrameBuffer, after the transpose)
+    void upscaleRows();
+
+    // Column x of the frame being drawn (x < getDrawWidth()), pixel y at y * getColumnStride()
+    inline Uint32 *getColumn(const unsigned int x) { return m_isColumnMajor ? m_columnPixels.data() + x * m_height : m_drawPixels + x; }
+    inline int getColumnStride() const { return m_isColumnMajor ? 1 : m_drawWidth; }
+    inline bool isColumnMajor() const { return m_isColumnMajor; }
+    inline bool isScaled() const { return m_drawWidth != m_width; }
+    inline Uint32 *getPixels() { return m_pixels.data(); }
+    inline unsigned int getWidth() const { return m_width; }
+    inline unsigned int getDrawWidth() const { return m_drawWidth; }
+    inline unsigned int getHeight() const { return m_height; }
+    static constexpr Uint32 packColor(Uint8 r, Uint8 g, Uint8 b) { return 0xFF000000u | (r << 16) | (g << 8) | b; }
+
+    // Shade: 0 (black) to 256 (unchanged), texture v: 16.16 fixed point, wrapped by textureMask.
+    // The textured fill & the transpose run the version of the CpuFeatures level, all bit exact.
+    static void fillColumnSolid(Uint32 *destination, const int stride, const int count, const Uint32 color);
+    static void blendColumnSolid(Uint32 *destination, const int stride, const int count, const Uint32 color, const unsigned int alpha);
+    static void fillColumnTextured(Uint32 *destination, const int stride, const int count, const Uint32 *textureColumn, const unsigned int textureMask, unsigned int v, const unsigned int vStep, const unsigned int shade);
+    // Rows [firstRow, lastRow[ of the column-major source (height pixels per column) into the row-major destination
+    static void transposeBand(const Uint32 *columns, Uint32 *rows, const unsigned int width, const unsigned int height, const unsigned int firstRow, const unsigned int lastRow);
+    // Destination pixel x from source pixel sourceIndices[x] (bilinear: & the next one, weighted
+    // by weights[4 * x] out of 256, repeated for the 4 channels)
+    static void upscaleRow(const Uint32 *source, Uint32 *destination, const unsigned int width, const unsigned int *sourceIndices, const Uint16 *weights, const UpscaleFilter filter);
+
+    private:
+    static void fillColumnTextured_scalar(Uint32 *destination, const int stride, const int count, const Uint32 *textureColumn, const unsigned int textureMask, unsigned int v, const unsigned int vStep, const unsigned int shade);
+    static void fillColumnTextured_SSE42(Uint32 *destination, const int stride, const int count, const Uint32 *textureColumn, const unsigned int textureMask, unsigned int v, const unsigned int vStep, const unsigned int shade);
+    static void fillColumnTextured_AVX2(Uint32 *destination, const int stride, const int count, const Uint32 *textureColumn, const unsigned int textureMask, unsigned int v, const unsigned int vStep, const unsigned int shade);
+    static void fillColumnTextured_AVX512(Uint32 *destination, const int stride, const int count, const Uint32 *textureColumn, const unsigned int textureMask, unsigned int v, const unsigned int vStep, const unsigned int shade);
+    static void transposeBand_scalar(const Uint32 *columns, Uint32 *rows, const unsigned int width, const unsigned int height, const unsigned int firstRow, const unsigned int lastRow);
+    static void transposeBand_SSE42(const Uint32 *columns, Uint32 *rows, const unsigned int width, const unsigned int height, const unsigned int firstRow, const unsigned int lastRow);
+    static void transposeBand_AVX2(const Uint32 *columns, Uint32 *rows, const unsigned int width, const unsigned int height, const unsigned int firstRow, const unsigned int lastRow);
+    void computeUpscaleTables();
+    static void upscaleRow_scalar(const Uint32 *source, Uint32 *destination, const unsigned int width, const unsigned int *sourceIndices, const Uint16 *weights, const UpscaleFilter filter);
+    static void upscaleRow_SSE42(const Uint32 *source, Uint32 *destination, const unsigned int width, const unsigned int *sourceIndices, const Uint16 *weights, const UpscaleFilter filter);
+    static void upscaleRow_AVX2(const Uint32 *source, Uint32 *destination, const unsigned int width, const unsigned int *sourceIndices, const Uint16 *weights, const UpscaleFilter filter);
+
+    std::vector<Uint32> m_pixels;
+    std::vector<Uint32> m_columnPixels;
+    unsigned int m_width;
+    unsigned int m_height;
+    bool m_isColumnMajor;
+    SDL_Texture *m_texture;
+
+    // Scaled: rows drawn into m_scaledPixels, the source pixels & weights of each frame column
+    std::vector<Uint32> m_scaledPixels;
+    Uint32 *m_drawPixels;
+    unsigned int m_drawWidth;
+    UpscaleFilter m_upscaleFilter;
+    std::vector<unsigned int> m_upscaleIndices;
+    std::vector<Uint16> m_upscaleWeights;
+
+    // Square blocks of pixels transposed at once, bands of that many rows per thread
+    static const unsigned int TRANSPOSE_BLOCK_SIZE = 64;
+};
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SDL.h"
+#include "SpscQueue.hpp"
+
+enum class CaptureFormat
+{
+    ppm,
+    y4m
+};
+
+// Streams the composed frames to a single file: binary PPM frames back to back (P6, RGB) or
+// a Y4M sequence (4:2:0, full range BT.601). The render loop copies each frame into one of a
+// pool of preallocated buffers and queues it, a writer thread converts & writes it in one
+// large sequential write. No free buffer (the disk fell behind): the frame is dropped, the
+// render loop never waits.
+class FrameCapture
+{
+    public:
+    FrameCapture();
+    ~FrameCapture();
+
+    // Nominal frame rate, Y4M header only (frames are captured as they are presented)
+    bool start(const std::string &path, CaptureFormat format, const unsigned int width, const unsigned int height, const unsigned int frameRate = 60);
+    // Writes the queued frames, then closes the file
+    void stop();
+
+    // Render side: buffer for the next frame (ARGB8888, row-major, width * 4 bytes a row),
+    // nullptr when none is free (counted as dropped). A buffer not submitted is kept for the next frame
+    Uint32 *acquireFrame();
+    void submitFrame();
+
+    inline bool isRunning() const { return m_isRunning; }
+    inline unsigned long long getNumberOfCapturedFrames() const { return m_numberOfCapturedFrames; }
+    inline unsigned long long getNumberOfWrittenFrames() const { return m_numberOfWrittenFrames; }
+    inline unsigned long long getNumberOfDroppedFrames() const { return m_numberOfDroppedFrames; }
+    inline unsigned long long getNumberOfWrittenBytes() const { return m_numberOfWrittenBytes; }
+
+    static CaptureFormat getFormatFromPath(const std::string &path);
+
+    private:
+    void writerLoop();
+    void convertFrame(const Uint32 *pixels);
+
+    static const unsigned int NUMBER_OF_BUFFERS = 8;
+
+    std::ofstream m_output;
+    CaptureFormat m_format;
+    unsigned int m_width;
+    unsigned int m_height;
+    std::vector<Uint32> m_buffers[NUMBER_OF_BUFFERS];
+    // Frame as written (header & converted pixels), reused for every frame
+    std::vector<unsigned char> m_frameBytes;
+    size_t m_frameHeaderSize;
+
+    // Buffer indices: free ones back to the render loop, filled ones to the writer
+    SpscQueue<unsigned int, 2 * NUMBER_OF_BUFFERS> m_freeBuffers;
+    SpscQueue<unsigned int, 2 * NUMBER_OF_BUFFERS> m_filledBuffers;
+    int m_acquiredBuffer;
+
+    std::thread m_writer;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::atomic<bool> m_isRunning;
+    std::atomic<bool> m_isStopping;
+
+    std::atomic<unsigned long long> m_numberOfCapturedFrames;
+    std::atomic<unsigned long long> m_numberOfWrittenFrames;
+    std::atomic<unsigned long long> m_numberOfDroppedFrames;
+    std::atomic<unsigned long long> m_numberOfWrittenBytes;
+};
\ No newline at end of file
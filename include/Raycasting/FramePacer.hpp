@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+
+// Frame pacing at a target rate: instead of sampling the input as soon as the previous
+// frame is out and then waiting for the deadline, waits first and starts the frame as
+// late as it can still be presented on time (deadline - predicted frame work - safety
+// margin). The wait sleeps until a spin margin before that point, then spins: the sleeps'
+// overshoot (timer resolution, scheduling) is measured, the spin margin follows its percentile.
+// Free running: the deadlines are one period apart. Vsync: the next deadline is one
+// period after the last present returned (the swap), so the frame starts late in the
+// refresh interval instead of queuing behind the swap.
+// The predicted work is a high percentile of the recent frames' work, the safety margin a
+// high percentile of the recent start lateness (late wake ups) plus the jitter of the present
+// returns, plus a back off which grows on every missed deadline or refresh and decays after.
+class FramePacer
+{
+    public:
+    FramePacer();
+
+    void setTargetRate(double framesPerSecond);
+    inline void setAnchoredToPresent(bool isAnchoredToPresent) { m_isAnchoredToPresent = isAnchoredToPresent; }
+
+    // Frame start (before the input is sampled), just before the present call, after the present
+    void waitForFrame();
+    void markPresent();
+    void endFrame();
+
+    inline bool isEnabled() const { return m_period.count() != 0; }
+    inline double getTargetRate() const { return isEnabled() ? 1e6 / m_period.count() : 0; }
+    inline unsigned long long getNumberOfFrames() const { return m_numberOfFrames; }
+    inline unsigned long long getNumberOfMissedDeadlines() const { return m_numberOfMissedDeadlines; }
+    // Vsync: presents which returned more than one refresh after the previous one
+    inline unsigned long long getNumberOfMissedRefreshes() const { return m_numberOfMissedRefreshes; }
+    inline double getPredictedWork() const { return 1e-3 * m_predictedWork.count(); }
+    inline double getSafetyMargin() const { return 1e-3 * m_safetyMargin.count(); }
+    inline double getSpinMargin() const { return 1e-3 * m_spinMargin.count(); }
+    // Averages per paced frame, in milliseconds
+    inline double getAverageWakeError() const { return (m_numberOfWaits != 0) ? 1e-3 * m_wakeErrorTotal.count() / m_numberOfWaits : 0; }
+    inline double getAverageSpinTime() const { return (m_numberOfWaits != 0) ? 1e-3 * m_spinTimeTotal.count() / m_numberOfWaits : 0; }
+
+    private:
+    typedef std::chrono::steady_clock Clock;
+
+    // Last samples (microseconds) & their percentile
+    static const unsigned int HISTORY_SIZE = 256;
+    struct History
+    {
+        long long samples[HISTORY_SIZE];
+        unsigned int count;
+        unsigned int next;
+
+        void clear();
+        void add(const std::chrono::microseconds sample);
+        std::chrono::microseconds getPercentile(const unsigned int percent) const;
+    };
+
+    void updateMargins();
+
+    std::chrono::microseconds m_period;
+    bool m_isAnchoredToPresent;
+    bool m_hasDeadline;
+    bool m_isPresentMarked;
+    bool m_isDeadlineMissed;
+    bool m_hasPresentTimePoint;
+    Clock::time_point m_deadline;
+    Clock::time_point m_frameStartTimePoint;
+    Clock::time_point m_presentTimePoint;
+    std::chrono::microseconds m_predictedWork;
+    std::chrono::microseconds m_safetyMargin;
+    std::chrono::microseconds m_backOff;
+    std::chrono::microseconds m_spinMargin;
+    History m_workHistory;
+    History m_latenessHistory;
+    History m_presentJitterHistory;
+    History m_overshootHistory;
+
+    unsigned long long m_numberOfFrames;
+    unsigned long long m_numberOfMissedDeadlines;
+    unsigned long long m_numberOfMissedRefreshes;
+    unsigned long long m_numberOfWaits;
+    std::chrono::microseconds m_wakeErrorTotal;
+    std::chrono::microseconds m_spinTimeTotal;
+
+    const unsigned int PERCENTILE = 99;
+    const unsigned int MIN_SAMPLES = 32;
+    // Back off: up by a quarter of the period per miss (up to a period: not paced), down by 1/BACK_OFF_DECAY per frame
+    const long long BACK_OFF_DECAY = 64;
+    const std::chrono::microseconds MIN_SAFETY_MARGIN = std::chrono::microseconds(100);
+    const std::chrono::microseconds MIN_SPIN_MARGIN = std::chrono::microseconds(200);
+    const std::chrono::microseconds MAX_SPIN_MARGIN = std::chrono::microseconds(4000);
+};
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "MapManager.hpp"
+#include "Player.hpp"
+#include "Raycaster.hpp"
+#include "StateBuffer.hpp"
+
+// What a frame is cast from
+struct FrameSample
+{
+    PlayerState state;
+    unsigned int fov;
+    unsigned int numberOfRays;
+    double time;
+    long long sampleTimePoint;
+};
+
+// Casts frames ahead of their submission: a worker thread (and its OpenMP team)
+// casts frame N+1 from the latest sample into its own ray buffers while the
+// main thread submits & presents frame N. Up to "depth" frames are in flight.
+class FramePipeline
+{
+    public:
+    FramePipeline();
+    ~FramePipeline();
+
+    bool start(unsigned int depth, unsigned int numberOfRays, MapManager &mapManager);
+    void stop();
+    void setAdaptiveStride(unsigned int stride);
+    void setTemporal(bool isTemporal);
+
+    void submitSample(const FrameSample &sample);
+    bool acquireFrame();
+    void releaseFrame();
+
+    inline bool isRunning() { return m_isRunning; }
+    inline unsigned int getDepth() { return m_depth; }
+    inline Raycaster &getRaycaster() { return m_raycasters[m_presentCount % m_depth]; }
+    inline Player &getPlayer() { return m_players[m_presentCount % m_depth]; }
+    inline const FrameSample &getSample() { return m_samples[m_presentCount % m_depth]; }
+
+    static const unsigned int MAX_DEPTH = 4;
+
+    private:
+    void workerLoop();
+
+    MapManager *m_mapManager;
+    Raycaster m_raycasters[MAX_DEPTH];
+    Player m_players[MAX_DEPTH];
+    FrameSample m_samples[MAX_DEPTH];
+    unsigned int m_depth;
+
+    StateBuffer<FrameSample> m_latestSample;
+    std::atomic<bool> m_hasSample;
+
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    unsigned long long m_castCount;
+    unsigned long long m_presentCount;
+    bool m_isRunning;
+};
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+
+#include "SDL.h"
+
+// Axis aligned quads submitted with SDL_RenderGeometry: vertices & indices are kept from
+// one frame to the next (grown, never shrunk), the quads added since the last submission
+// are drawn in one call. The texture is the wall texture with an extra white row, sampled
+// by the untextured quads so that they can share the textured call.
+class GeometryBatch
+{
+    public:
+    GeometryBatch();
+    ~GeometryBatch();
+
+    bool SDL_loadTexture(SDL_Renderer *renderer, const std::vector<SDL_Color> &texture, const unsigned int textureSize);
+    // Before the renderer is destroyed
+    void SDL_releaseTextures();
+
+    void clear();
+    void reserve(const unsigned int numberOfQuads);
+    // Colors of the top & bottom edges (modulating the texture), texture coordinates in texels
+    void addQuad(const float x0, const float y0, const float x1, const float y1, const SDL_Color topColor, const SDL_Color bottomColor, const float u, const float v0, const float v1);
+    void addSolidQuad(const float x0, const float y0, const float x1, const float y1, const SDL_Color topColor, const SDL_Color bottomColor);
+    bool SDL_submit(SDL_Renderer *renderer, const bool isTextured);
+
+    inline bool hasTexture() const { return m_texture != nullptr; }
+    inline unsigned int getNumberOfQuads() const { return m_numberOfQuads; }
+    inline unsigned int getNumberOfDrawCalls() const { return m_numberOfDrawCalls; }
+
+    private:
+    std::vector<SDL_Vertex> m_vertices;
+    std::vector<int> m_indices;
+    unsigned int m_capacity;
+    unsigned int m_numberOfQuads;
+    unsigned int m_numberOfSubmittedQuads;
+    unsigned int m_numberOfDrawCalls;
+
+    SDL_Texture *m_texture;
+    float m_textureWidth;
+    float m_textureHeight;
+};
\ No newline at end of file
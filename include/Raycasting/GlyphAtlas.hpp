@@ -0,0 +1,38 @@
+#pragma once
+
+#include "SDL.h"
+#include "SDL_ttf.h"
+
+// Printable ASCII glyphs rendered once into a texture (16 glyphs per row), a text is then
+// drawn glyph by glyph from it: no surface nor texture created per frame. The atlas can be
+// rasterised at startup from the font or baked beforehand (tools/AssetBaker.cpp).
+class GlyphAtlas
+{
+    public:
+    GlyphAtlas();
+    ~GlyphAtlas();
+
+    bool SDL_loadFont(SDL_Renderer *renderer, TTF_Font *font, const SDL_Color color);
+    // ARGB8888 atlas, NUMBER_OF_GLYPHS rectangles
+    bool SDL_loadAtlas(SDL_Renderer *renderer, const Uint32 *pixels, const int width, const int height, const SDL_Rect *glyphs, const int glyphHeight);
+    // ARGB8888 atlas surface (freed by the caller) & glyph rectangles, nullptr on failure
+    static SDL_Surface *rasteriseFont(TTF_Font *font, const SDL_Color color, SDL_Rect *glyphs, int &glyphHeight);
+    // Before the renderer is destroyed
+    void SDL_releaseTextures();
+
+    // Top left corner, returns the width drawn
+    int SDL_renderText(SDL_Renderer *renderer, const char *text, const int x, const int y);
+
+    inline bool isLoaded() const { return m_texture != nullptr; }
+    inline int getGlyphHeight() const { return m_glyphHeight; }
+
+    static const char FIRST_GLYPH = ' ';
+    static const char LAST_GLYPH = '~';
+    static const int NUMBER_OF_GLYPHS = LAST_GLYPH - FIRST_GLYPH + 1;
+    static const int GLYPHS_PER_ROW = 16;
+
+    private:
+    SDL_Texture *m_texture;
+    SDL_Rect m_glyphs[NUMBER_OF_GLYPHS];
+    int m_glyphHeight;
+};
\ No newline at end of file
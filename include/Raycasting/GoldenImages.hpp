@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "FrameBuffer.hpp"
+#include "MapManager.hpp"
+#include "Player.hpp"
+#include "Raycaster.hpp"
+
+// Allowed differences with the golden files. Defaults: pixel exact frames, rays within
+// rounding of their text form
+struct GoldenTolerances
+{
+    double ray;                     // cells, on the distance & the hit point
+    unsigned int rayMismatches;     // rays out of tolerance per kernel
+    unsigned int pixel;             // levels, per channel
+    double pixelMismatchRatio;      // pixels out of tolerance per frame
+};
+
+// Golden-image regression harness (headless, no SDL calls). Fixed maps (the default one, a
+// walled one & an open one) are cast from fixed poses with every casting kernel, their rays
+// (distance & hit point, one text file per scene) and the software frames of the single &
+// multi-hit kernels (binary PPM) are compared with the files of the golden directory. The
+// frames are drawn at every supported SIMD level, row & column-major: all must match the same
+// golden frame. A frame out of tolerance writes <name>.actual.ppm & <name>.diff.ppm (differing
+// pixels in red) next to its golden file.
+class GoldenImages
+{
+    public:
+    GoldenImages();
+
+    inline GoldenTolerances &getTolerances() { return m_tolerances; }
+    // Writes the golden files instead of comparing (after an intended visual change)
+    inline void setUpdate(bool isUpdate) { m_isUpdate = isUpdate; }
+    bool run(const std::string &directory);
+
+    private:
+    struct Scene
+    {
+        const char *name;
+        MapManager *mapManager;
+        PlayerState pose;
+    };
+
+    bool runScene(const std::string &directory, const Scene &scene);
+    void castRays(const unsigned int kernel, const Scene &scene);
+    bool compareRays(const std::string &path, const std::string &rays);
+    bool compareFrame(const std::string &path, const std::vector<Uint32> &pixels);
+
+    static MapManager *createMap(const unsigned int width, const unsigned int height, const char *rows);
+    static bool writePPM(const std::string &path, const Uint32 *pixels, const unsigned int width, const unsigned int height);
+    static bool readPPM(const std::string &path, std::vector<Uint32> &pixels, unsigned int &width, unsigned int &height);
+
+    GoldenTolerances m_tolerances;
+    bool m_isUpdate;
+    Raycaster m_raycaster;
+    Raycaster m_temporalRaycaster;
+    FrameBuffer m_frameBuffer;
+    FrameBuffer m_columnMajorFrameBuffer;
+    Player m_player;
+    unsigned int m_numberOfFailures;
+
+    static const unsigned int FRAME_WIDTH = 96;
+    static const unsigned int FRAME_HEIGHT = 60;
+    static const unsigned int NUMBER_OF_KERNELS = 6;
+};
\ No newline at end of file
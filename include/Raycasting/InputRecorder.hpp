@@ -0,0 +1,83 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "SDL.h"
+
+// Records the SDL events and frame deltas driving Capp into a compact binary file,
+// and plays them back so two runs produce the exact same camera path.
+//
+// File layout (little endian):
+//   header : "RCRP" | version (u16) | seed (u64) | screen width (u16) | screen height (u16) | special walls (u8)
+//   frame  : dt in microseconds (u32) | event count (u16) | events...
+//   event  : kind (u8) | payload (key: scancode u16, motion: xrel i16, wheel: y i16, quit: none)
+class InputRecorder
+{
+    public:
+    InputRecorder();
+    ~InputRecorder();
+
+    bool openRecord(const std::string &path, unsigned long long seed, unsigned int screenWidth, unsigned int screenHeight, bool hasSpecialWalls);
+    bool openReplay(const std::string &path);
+    void close();
+
+    // Recording
+    void recordEvent(const SDL_Event &event);
+    void recordFrame(unsigned int dtMicroseconds);
+
+    // Replay
+    bool readFrame(unsigned int &dtMicroseconds);
+    bool pollEvent(SDL_Event &event);
+
+    inline bool isRecording() { return m_isRecording; }
+    inline bool isReplaying() { return m_isReplaying; }
+    inline unsigned long long getSeed() { return m_seed; }
+    inline unsigned int getScreenWidth() { return m_screenWidth; }
+    inline unsigned int getScreenHeight() { return m_screenHeight; }
+    inline bool hasSpecialWalls() { return m_hasSpecialWalls; }
+    inline unsigned int getFrameCount() { return m_frameCount; }
+
+    private:
+    struct RecordedEvent
+    {
+        unsigned char kind;
+        short value;
+    };
+
+    void writeU8(unsigned char value);
+    void writeU16(unsigned short value);
+    void writeU32(unsigned int value);
+    void writeU64(unsigned long long value);
+    bool readU8(unsigned char &value);
+    bool readU16(unsigned short &value);
+    bool readU32(unsigned int &value);
+    bool readU64(unsigned long long &value);
+
+    std::ofstream m_output;
+    std::ifstream m_input;
+    std::vector<RecordedEvent> m_frameEvents;
+    unsigned int m_frameEventIndex;
+    unsigned int m_frameCount;
+    bool m_isRecording;
+    bool m_isReplaying;
+    unsigned long long m_seed;
+    unsigned int m_screenWidth;
+    unsigned int m_screenHeight;
+    bool m_hasSpecialWalls;
+
+    // 2: mouse motion turns by a fixed angle per pixel (was a speed over the frame), 3: special walls flag
+    const unsigned short FILE_VERSION = 3;
+    // The event count of a frame is a u16: reserved once, no frame grows the events
+    const unsigned int MAX_FRAME_EVENTS = 65535;
+
+    enum EventKind : unsigned char
+    {
+        quit = 0,
+        keyDown = 1,
+        keyUp = 2,
+        mouseMotion = 3,
+        mouseWheel = 4
+    };
+};
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <random>
+#include <vector>
+
+#include "MapManager.hpp"
+
+// 360 degree depth-only scan: uniform angular sampling, distances only
+// (no color, light or texture work), optional gaussian noise & max range.
+// The grid traversal runs in packets of 8 beams with AVX-512, scalar below (the SSE4.2 & AVX2
+// packets were slower than scalar), both give the same distances.
+class LidarScanner
+{
+    public:
+    LidarScanner(const unsigned int numberOfBeams, const double maxRange, const double noiseStandardDeviation = 0, const unsigned long long seed = 0);
+
+    // distances must hold getNumberOfBeams() values, beam 0 points at angle
+    void scan(const MapManager &mapManager, const double x, const double y, const double angle, float *distances);
+
+    inline unsigned int getNumberOfBeams() const { return m_numberOfBeams; }
+    inline double getMaxRange() const { return m_maxRange; }
+
+    private:
+    // Beams [first, last[ from the rotated directions into m_distances
+    void traverse_scalar(const MapManager &mapManager, const double x, const double y, const unsigned int first, const unsigned int last);
+    void traverse_AVX512(const MapManager &mapManager, const double x, const double y, const unsigned int first, const unsigned int last);
+
+    unsigned int m_numberOfBeams;
+    double m_maxRange;
+    double m_noiseStandardDeviation;
+    std::vector<double> m_beamCos;
+    std::vector<double> m_beamSin;
+    std::vector<double> m_rayDirectionX;
+    std::vector<double> m_rayDirectionY;
+    std::vector<double> m_distances;
+    std::default_random_engine m_generator;
+    std::normal_distribution<double> m_noise;
+};
\ No newline at end of file
@@ -1,28 +1,157 @@
 #pragma once
 
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <vector>
+
 #include "SDL.h"
 
+// Cell change, in the order they were applied
+struct MapChange
+{
+    unsigned int x;
+    unsigned int y;
+    char previousElement;
+    char element;
+};
+
+// How a wall element is drawn
+struct Material
+{
+    double height;
+    bool isSeeThrough;
+    SDL_Color color;
+};
+
 class MapManager
 {
     public: 
     MapManager();
     MapManager(const unsigned int width, const unsigned int height);
+    MapManager(const unsigned int width, const unsigned int height, const char *cells);
     ~MapManager();
 
     int SDL_renderMap(SDL_Renderer *renderer, const unsigned int screenWidth, const unsigned int screenHeight);
     int SDL_renderMiniMap(SDL_Renderer *renderer, const unsigned int screenWidth, const unsigned int screenHeight, unsigned char scaleFactor);
+    // Before the renderer is destroyed
+    void SDL_releaseTextures();
+
+    inline unsigned int coordinateToIndex(unsigned int x, unsigned int y) const { return x + (y * m_width); }
+    inline unsigned int getWidth() const { return m_width; }
+    inline unsigned int getHeight() const { return m_height; }
+    // The cells are stored with a ring of OUTSIDE_ELEMENT around them (BORDER_SIZE cells wide):
+    // a traversal stepping one cell at a time reads the ring before it can leave the storage,
+    // so it needs no bounds checks as long as it stops on any non free cell
+    inline int coordinateToPaddedIndex(int x, int y) const { return (x + BORDER_SIZE) + (y + BORDER_SIZE) * (int)m_stride; }
+    inline char getMapElement(int x, int y) const { return m_mapArray[coordinateToPaddedIndex(x, y)]; }
+    // Padded storage, rows of getStride() cells, the map starts at (BORDER_SIZE, BORDER_SIZE)
+    inline const char *getMapArray() const { return m_mapArray; }
+    inline unsigned int getStride() const { return m_stride; }
+    // Cell of a position, floored down to -BORDER_SIZE (a cast truncates towards 0)
+    static inline int positionToCell(double position) { return (int)(position + BORDER_SIZE) - BORDER_SIZE; }
+    void setMapElement(unsigned int x, unsigned int y, char element);
+
+    // Materials: height (in cells) & see-through walls. Special cells (any other than full
+    // height & opaque) need the multi-hit traversal to be drawn
+    static const Material &getMaterial(char element);
+    static inline bool isSpecialElement(char element) { return element != 0 && (getMaterial(element).height != 1 || getMaterial(element).isSeeThrough); }
+    unsigned int getNumberOfSpecialCells() const;
+    double getMaximumHeight() const;
+    // Default map only: a few cells of each special material (opt-in, the casting becomes multi-hit)
+    void addSpecialWalls();
+
+    // Doors: free when open, DOOR_ELEMENT when closed (they start closed)
+    void addDoor(unsigned int x, unsigned int y);
+    bool toggleDoor(unsigned int x, unsigned int y);
+    inline bool isDoor(unsigned int x, unsigned int y) const { return m_isDoorCell[coordinateToIndex(x, y)]; }
+    inline unsigned int getNumberOfDoors() const { return m_doorCells.size(); }
+    inline unsigned int getDoorX(unsigned int door) const { return m_doorCells[door] % m_width; }
+    inline unsigned int getDoorY(unsigned int door) const { return m_doorCells[door] / m_width; }
+
+    // Change journal: the revision counts the changes, derived data keeps the revision it was built at
+    inline unsigned long long getRevision() const { return m_revision; }
+    // Cells read on other threads than the one changing them (simulation thread, pipeline worker):
+    // the readers hold it shared, the writer exclusive around setMapElement & the door changes
+    inline std::shared_mutex &getCellsMutex() const { return m_cellsMutex; }
+    // Appends the changes made after revision, false if the journal no longer holds them all (rebuild)
+    bool getChangesSince(unsigned long long revision, std::vector<MapChange> &changes) const;
 
-    inline unsigned int coordinateToIndex(unsigned int x, unsigned int y) { return x + (y * m_height); }
-    inline unsigned int getWidth() { return m_width; }
-    inline unsigned int getHeight() { return m_height; }
-    inline char getMapElement(unsigned int x, unsigned int y) { return m_mapArray[coordinateToIndex(x, y)]; }
-    
-    
+    // Walkable space: free cells & their 4-connected components, kept up to date by setMapElement
+    inline unsigned int getNumberOfFreeCells() const { return m_freeCells.size(); }
+    inline unsigned int getNumberOfComponents() const { return m_numberOfComponents; }
+    inline unsigned int getLargestComponent() const { return m_largestComponent; }
+    inline unsigned int getComponent(unsigned int x, unsigned int y) const { return m_cellComponent[coordinateToIndex(x, y)]; }
+    inline unsigned int getComponentSize(unsigned int component) const { return m_componentCells[component].size(); }
+    inline bool isReachable(unsigned int xFrom, unsigned int yFrom, unsigned int xTo, unsigned int yTo) const { return getComponent(xFrom, yFrom) != NO_COMPONENT && getComponent(xFrom, yFrom) == getComponent(xTo, yTo); }
+    // Uniform over the free cells of a component (default: the largest one), false if it has none
+    bool getRandomFreeCell(std::default_random_engine &generator, unsigned int &x, unsigned int &y) const;
+    bool getRandomFreeCell(std::default_random_engine &generator, unsigned int component, unsigned int &x, unsigned int &y) const;
+
+    static const unsigned int NO_COMPONENT = 0xFFFFFFFF;
+    static const char DOOR_ELEMENT = 6;
+    // Sentinel ring, drawn as the default (black, opaque) material
+    static const char OUTSIDE_ELEMENT = -1;
+    static const int BORDER_SIZE = 1;
 
     private:
+    void allocateMapArray(const char *cells);
+    void initialiseDerivedData();
+    void buildWalkableSpace();
+    void addFreeCell(unsigned int cell);
+    void removeFreeCell(unsigned int cell);
+    unsigned int createComponent();
+    void setCellComponent(unsigned int cell, unsigned int component);
+    void releaseComponent(unsigned int component);
+    void findLargestComponent();
+    void splitComponent(const unsigned int neighbours[4], const unsigned int numberOfNeighbours);
+    unsigned int getFreeNeighbours(unsigned int cell, unsigned int neighbours[4]) const;
+    SDL_Color getMiniMapColor(char element) const;
+
     char *m_mapArray;
     unsigned int m_width;
     unsigned int m_height;
+    unsigned int m_stride;
+
+    // Free cells (O(1) removal: slot of each cell in the list)
+    std::vector<unsigned int> m_freeCells;
+    std::vector<unsigned int> m_freeCellSlot;
+
+    // Components: label of each cell, cells of each label & slot of each cell in it
+    std::vector<unsigned int> m_cellComponent;
+    std::vector<std::vector<unsigned int>> m_componentCells;
+    std::vector<unsigned int> m_componentSlot;
+    std::vector<unsigned int> m_releasedComponents;
+    unsigned int m_numberOfComponents;
+    unsigned int m_largestComponent;
+
+    // Flood fill scratch, cells are visited when their stamp is the current one
+    std::vector<unsigned int> m_visitStamp;
+    std::vector<unsigned int> m_floodCells;
+    std::vector<unsigned int> m_splitFloods[4];
+    unsigned int m_currentStamp;
+
+    // Number of cells of each element (materials in use)
+    std::atomic<unsigned int> m_numberOfCellsPerElement[256];
+
+    // Doors
+    std::vector<bool> m_isDoorCell;
+    std::vector<unsigned int> m_doorCells;
+
+    // Change journal (appended by the simulation, read by the renderer)
+    std::vector<MapChange> m_journal;
+    unsigned long long m_journalFirstRevision;
+    std::atomic<unsigned long long> m_revision;
+    mutable std::mutex m_journalMutex;
+    mutable std::shared_mutex m_cellsMutex;
+
+    // Minimap, one texel per cell, only the changed cells are uploaded
+    SDL_Texture *m_miniMapTexture;
+    std::vector<SDL_Color> m_miniMapPixels;
+    std::vector<MapChange> m_miniMapChanges;
+    unsigned long long m_miniMapRevision;
 
     const unsigned int DEFAULT_SIZE = 32;
+    const unsigned int MAX_JOURNAL_SIZE = 4096;
 };
\ No newline at end of file
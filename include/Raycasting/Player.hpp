@@ -3,18 +3,31 @@
 #include "SDL.h"
 #include "MapManager.hpp"
 
+// Pose & speed of the player, what the renderer needs from the simulation
+struct PlayerState
+{
+    double x;
+    double y;
+    double angle;
+    double velocity;
+};
+
 class Player
 {
     public:
     Player() = default;
 
-    void initialisePlayer(MapManager &mapManager);
+    void initialisePlayer(MapManager &mapManager, unsigned long long seed);
     void movePlayer(MapManager &mapManager, double accelForward, double accelSide, bool isSprinting, double dt);
     inline void rotatePlayer(double angularSpeed, double dt) { m_angle += m_rotationSpeed * angularSpeed * dt; };
+    inline void turnPlayer(double angle) { m_angle += angle; }
     inline double getX() { return m_xPosition; }
     inline double getY() { return m_yPosition; }
     inline double getAngle() { return m_angle; }
     inline double getVelocity() {return m_vMagnitude; }
+    bool isOverlappingCell(const unsigned int x, const unsigned int y);
+    inline PlayerState getState() { return PlayerState { m_xPosition, m_yPosition, m_angle, m_vMagnitude }; }
+    inline void setState(const PlayerState &state) { m_xPosition = state.x; m_yPosition = state.y; m_angle = state.angle; m_vMagnitude = state.velocity; }
     int SDL_renderPlayer(SDL_Renderer *renderer, MapManager &mapManager, const unsigned int screenWidth, const unsigned int screenHeight);
     int SDL_renderPlayerMiniMap(SDL_Renderer *renderer, MapManager &mapManager, const unsigned int screenWidth, const unsigned int screenHeight, unsigned char scaleFactor);
 
@@ -33,4 +46,5 @@ class Player
     const double MOVE_SPEED = 5;
     const double SPRINT_SPEED = 10;
     const double PLAYER_SIZE = 1;
+    const double COLLISION_HALF_SIZE = 0.2;
 };
\ No newline at end of file
@@ -2,30 +2,97 @@
 
 #include <vector>
 
+#include "FrameBuffer.hpp"
+#include "GeometryBatch.hpp"
 #include "MapManager.hpp"
 #include "Player.hpp"
 #include "SDL.h"
 #include "Player.hpp"
 
+// Visible part of a wall in a column (multi-hit traversal), in screen heights
+struct WallSpan
+{
+    double distance;
+    double wallTop;
+    double wallHeight;
+    double visibleTop;
+    double visibleBottom;
+    SDL_Color color;
+    int textureXIndex;
+    bool isTextured;
+    bool isSeeThrough;
+};
+
 class Raycaster
 {
     public:
     Raycaster();
     ~Raycaster();
 
+    static void generateTexture(std::vector<SDL_Color> &texture, const unsigned char textureSize);
+    // Multi-hit traversal of one column from (x, y): its visible spans front to back (up to MAX_SPANS),
+    // the nearest opaque wall's corrected distance & the first hit (any wall). Shared with BatchRenderer
+    static unsigned int castSpans(const MapManager &mapManager, const double x, const double y, const double rayDirectionX, const double rayDirectionY, const double cosRayAngleOffset, const double maximumHeight,
+                                  WallSpan *spans, double &depth, double &firstHitX, double &firstHitY, double &firstLightFactor);
+    static const unsigned int MAX_SPANS = 8;
+
     void initialiseRaycaster(const unsigned int numberOfRays);
+    void setNumberOfRays(const unsigned int numberOfRays);
     void calculateRaysDistance(Player &player, MapManager &mapManager, unsigned int fov = 90);
     void calculateRaysDistance_fishEyeAndRayDistributionCorrected(Player &player, MapManager &mapManager, unsigned int fov = 90);
     void calculateRaysDistance_OMP(Player &player, MapManager &mapManager, unsigned int fov = 90);
+    void calculateRaysSpans_OMP(Player &player, MapManager &mapManager, unsigned int fov = 90);
+    void calculateRaysAdaptive_OMP(Player &player, MapManager &mapManager, unsigned int fov = 90, unsigned int stride = 8);
+    void calculateRaysTemporal_OMP(Player &player, MapManager &mapManager, unsigned int fov = 90);
+    // Multi-hit only when the map has special cells (see-through or not full height), temporal or adaptive casting when enabled
+    inline void calculateRays_OMP(Player &player, MapManager &mapManager, unsigned int fov = 90)
+    {
+        if (mapManager.getNumberOfSpecialCells() != 0)
+            calculateRaysSpans_OMP(player, mapManager, fov);
+        else if (m_isTemporal)
+            calculateRaysTemporal_OMP(player, mapManager, fov);
+        else if (m_adaptiveStride > 1)
+            calculateRaysAdaptive_OMP(player, mapManager, fov, m_adaptiveStride);
+        else
+            calculateRaysDistance_OMP(player, mapManager, fov);
+    }
     void SDL_renderRaycast2DMap(SDL_Renderer *renderer, MapManager &mapManager, Player &player, const unsigned int screenWidth, const unsigned int screenHeigth);
     void SDL_renderRaycast2DMiniMap(SDL_Renderer *renderer, MapManager &mapManager, Player &player, const unsigned int screenWidth, const unsigned int screenHeigth, const unsigned int scaleFactor);
     void SDL_renderRaycast(SDL_Renderer *renderer, const double currentVelocity, const double time, const unsigned int screenWidth, const unsigned int screenHeigth);
+    void SDL_renderRaycastSpans(SDL_Renderer *renderer, const unsigned int screenWidth, const unsigned int screenHeigth);
     void SDL_renderRaycastBackground(SDL_Renderer *renderer, const double currentVelocity, const double time, const unsigned int screenWidth, const unsigned int screenHeigth);
+    // Background & walls as quads, in two SDL_RenderGeometry calls
+    bool SDL_renderRaycastGeometry(SDL_Renderer *renderer, GeometryBatch &batch, const double currentVelocity, const double time, const unsigned int screenWidth, const unsigned int screenHeigth);
+    // Software path: background & walls drawn into the frame buffer with the column span kernels
+    void renderRaycastFrameBuffer(FrameBuffer &frameBuffer, const double currentVelocity, const double time);
+
+    inline unsigned int getNumberOfRays() const { return m_numberOfRays; }
+    inline const double *getRaysDistance() const { return m_raysDistance; }
+    inline double getMovingOffset() const { return m_movingOffset; }
+    inline bool isMultiHit() const { return m_isMultiHit; }
+    // Draw calls of the last frame (from the background on)
+    inline unsigned int getNumberOfDrawCalls() const { return m_numberOfDrawCalls; }
+    inline void setAdaptiveStride(unsigned int stride) { m_adaptiveStride = stride; }
+    inline void setTemporal(bool isTemporal) { m_isTemporal = isTemporal; }
+    inline unsigned int getAdaptiveStride() const { return m_adaptiveStride; }
+    inline bool isTemporal() const { return m_isTemporal; }
+    inline unsigned int getNumberOfCastRays() const { return m_numberOfCastRays; }
+    inline const double *getRaysX() const { return m_raysX; }
+    inline const double *getRaysY() const { return m_raysY; }
+    inline unsigned int getNumberOfSpans(unsigned int ray) const { return m_numberOfSpans[ray]; }
+    inline const WallSpan *getSpans(unsigned int ray) const { return m_spans + ray * MAX_SPANS; }
     
 
     private:
+    void releaseRays();
+    void drawWallSpan(FrameBuffer &frameBuffer, const int firstX, const int lastX, const double wallTop, const double wallHeight, double visibleTop, double visibleBottom, const bool isTextured, const int textureXIndex, const SDL_Color color);
+
     std::vector<SDL_Color> m_texture;
+    // Same texture, column-major ARGB8888 (one texture column per wall column)
+    std::vector<Uint32> m_textureColumns;
+    std::vector<Uint32> m_backgroundColumn;
     unsigned int m_numberOfRays;
+    unsigned int m_raysCapacity;
     double *m_raysDistance;
     double *m_raysX;
     double *m_raysY;
@@ -39,8 +106,14 @@ class Raycaster
     double *m_raysTextureYStep;
     bool *m_raysIsTextured;
     double m_movingOffset;
+    unsigned int m_numberOfDrawCalls;
+
+    // Multi-hit: up to MAX_SPANS spans per ray, front to back
+    bool m_isMultiHit;
+    WallSpan *m_spans;
+    unsigned char *m_numberOfSpans;
 
-    const unsigned char TEXTURE_SIZE = 32;
+    static const unsigned char TEXTURE_SIZE = 32;
     const double MOVING_OFFSET_MAGNITUDE = 3000;
 
     enum class WallSide
@@ -50,4 +123,43 @@ class Raycaster
         west,
         east
     };
+
+    // Adaptive casting: cast every stride-th ray, the rays between two hits of the same
+    // cell face are intersected with that face, the others are cast (recursively)
+    void castRay(const int i, const double playerX, const double playerY, const MapManager &mapManager);
+    void intersectFace(const int i, const double playerX, const double playerY, const MapManager &mapManager, const int cell, const WallSide side);
+    unsigned int resolveRays(const int first, const int last, const double playerX, const double playerY, const MapManager &mapManager);
+
+    void updateRaysDirection(const double playerAngle, const unsigned int fov);
+
+    unsigned int m_adaptiveStride;
+    unsigned int m_numberOfCastRays;
+    unsigned int m_offsetsNumberOfRays;
+    unsigned int m_offsetsFov;
+    double *m_rayOffsets;
+    double *m_rayOffsetsCos;
+    double *m_rayOffsetsSin;
+    double *m_raysDirectionX;
+    double *m_raysDirectionY;
+    int *m_raysCell;
+    WallSide *m_raysSide;
+
+    // Temporal casting: the previous frame's hits (swapped with the current ones) tell where
+    // the face boundaries are in the new view, only the rays around them are cast
+    void swapPreviousRays();
+
+    bool m_isTemporal;
+    bool m_hasPreviousRays;
+    unsigned int m_previousNumberOfRays;
+    double *m_previousRaysX;
+    double *m_previousRaysY;
+    double *m_previousRaysAngle;
+    int *m_previousRaysCell;
+    WallSide *m_previousRaysSide;
+    bool *m_raysIsAnchor;
+    std::vector<int> m_anchors;
+    // Anchor list compaction: where each thread's block of columns starts in m_anchors
+    std::vector<int> m_anchorsBlockOffset;
+
+    const unsigned int TEMPORAL_STRIDE = 8;
 };
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+// Dynamic resolution: picks the horizontal render scale (rays per screen column) from
+// an exponential moving average of the frame time against a budget. Scales down as
+// soon as the average is over budget, up slowly once there is headroom, and waits a
+// few frames after each change so the average reflects the new scale.
+class ResolutionController
+{
+    public:
+    ResolutionController();
+
+    void setBudget(double budgetMilliseconds);
+    bool update(double frameTimeMilliseconds);
+    unsigned int getNumberOfRays(unsigned int screenWidth) const;
+
+    inline bool isEnabled() const { return m_budget > 0; }
+    inline double getScale() const { return m_scale; }
+    inline double getAverageFrameTime() const { return m_averageFrameTime; }
+
+    private:
+    double m_budget;
+    double m_scale;
+    double m_averageFrameTime;
+    unsigned int m_cooldown;
+
+    const double SMOOTHING_FACTOR = 0.1;
+    const double MIN_SCALE = 0.25;
+    const double MAX_SCALE = 1;
+    const double HEADROOM = 0.8;
+    const double TARGET = 0.9;
+    const double SCALE_UP_FACTOR = 1.05;
+    const unsigned int COOLDOWN_FRAMES = 15;
+    const unsigned int MIN_NUMBER_OF_RAYS = 64;
+};
\ No newline at end of file
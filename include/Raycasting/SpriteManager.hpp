@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+
+#include "SDL.h"
+#include "FrameArena.hpp"
+#include "MapManager.hpp"
+#include "Player.hpp"
+#include "Raycaster.hpp"
+#include "Toolbox.hpp"
+#include "VisibilitySet.hpp"
+
+// Billboards (pickups, NPCs, projectiles...) stored as structure of arrays, bucketed
+// per map cell. Each frame: gather the sprites of the cells in the frustum's bounding
+// box that the viewer can see (PVS), frustum cull them, radix sort on quantized depth
+// (far to near), reject sprites fully hidden by nearer walls, then draw only the
+// visible column spans, using the raycaster distances as a per-column depth buffer.
+class SpriteManager
+{
+    public:
+    SpriteManager();
+    ~SpriteManager();
+
+    // Sizes the grid on the map, removes the sprites
+    void initialiseSprites(const MapManager &mapManager);
+    bool loadTexture(SDL_Renderer *renderer, const char *path);
+    // Square ARGB8888 texture, transparent background (e.g. baked)
+    bool loadTexture(SDL_Renderer *renderer, const Uint32 *pixels, const int size);
+    // Before the renderer is destroyed
+    void SDL_releaseTextures();
+    unsigned int addSprite(const double x, const double y, const double size, const SDL_Color color);
+    void addRandomSprites(MapManager &mapManager, const unsigned int count, const unsigned long long seed);
+    void clear();
+
+    inline void setVisibilitySet(const VisibilitySet *visibilitySet) { m_visibilitySet = visibilitySet; }
+    void setSpritePosition(const unsigned int sprite, const double x, const double y);
+    inline unsigned int getNumberOfSprites() const { return m_x.size(); }
+    inline unsigned int getNumberOfCandidateSprites() const { return m_numberOfCandidateSprites; }
+    inline unsigned int getNumberOfVisibleSprites() const { return m_numberOfVisibleSprites; }
+    inline unsigned int getNumberOfDrawnSprites() const { return m_numberOfDrawnSprites; }
+
+    // The per frame arrays come from the arena
+    void SDL_renderSprites(SDL_Renderer *renderer, FrameArena &arena, Player &player, const Raycaster &raycaster, const unsigned int fov, const unsigned int screenWidth, const unsigned int screenHeight);
+
+    private:
+    inline unsigned int positionToCell(double x, double y) const { return Math::limitToInterval<int>(x, 0, m_gridWidth - 1) + Math::limitToInterval<int>(y, 0, m_gridHeight - 1) * m_gridWidth; }
+    // Sprites of the cells the viewer may see, only counted when candidates is null
+    unsigned int gatherCandidates(Player &player, const unsigned int fov, unsigned int *candidates) const;
+    void cullSprites(FrameArena &arena, Player &player, const unsigned int fov);
+    void sortVisibleSprites(FrameArena &arena);
+    void computeTilesMaxDistance(FrameArena &arena, const Raycaster &raycaster);
+    // Multi-hit: column by column, clipped by the nearer opaque walls' coverage & faded behind
+    // the nearer see-through ones
+    bool SDL_drawSpriteSpans(SDL_Renderer *renderer, const Raycaster &raycaster, const double depth, const int firstRay, const int lastRay, const double xStep,
+                             const double spriteLeft, const double spriteWidth, const double spriteTop, const double spriteHeight, const unsigned int screenHeight, const SDL_Color &color);
+
+    // Sprites
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_size;
+    std::vector<SDL_Color> m_color;
+    double m_maximumSize;
+
+    // Spatial grid, one bucket per map cell, sprites only move between buckets when they change cell
+    std::vector<std::vector<unsigned int>> m_cellSprites;
+    std::vector<unsigned int> m_spriteCell;
+    std::vector<unsigned int> m_spriteSlot;
+    unsigned int m_gridWidth;
+    unsigned int m_gridHeight;
+
+    // Per frame, visible sprites only (in the frame arena, valid until its reset): sprite,
+    // depth & lateral offset per slot, slots sorted far to near
+    unsigned int *m_visibleSprites;
+    unsigned int *m_drawOrder;
+    unsigned short *m_depthKeys;
+    double *m_depth;
+    double *m_lateralOffset;
+    double *m_tilesMaxDistance;
+    unsigned int m_numberOfCandidateSprites;
+    unsigned int m_numberOfVisibleSprites;
+    unsigned int m_numberOfDrawnSprites;
+
+    const VisibilitySet *m_visibilitySet;
+    SDL_Texture *m_texture;
+    int m_textureSize;
+
+    const double NEAR_PLANE = 0.1;
+    const double MAX_DEPTH = 128;
+    const unsigned int TILE_WIDTH = 16;
+};
\ No newline at end of file
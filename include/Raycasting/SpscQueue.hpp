@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// CAPACITY must be a power of two, one slot is kept empty to tell full from empty.
+template <typename T, size_t CAPACITY>
+class SpscQueue
+{
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+    public:
+    SpscQueue()
+    {
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+    }
+
+    // Producer side, returns false when the queue is full
+    bool push(const T &value)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t nextTail = (tail + 1) & (CAPACITY - 1);
+        if (nextTail == m_head.load(std::memory_order_acquire))
+            return false;
+
+        m_items[tail] = value;
+        m_tail.store(nextTail, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, returns false when the queue is empty
+    bool pop(T &value)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false;
+
+        value = m_items[head];
+        m_head.store((head + 1) & (CAPACITY - 1), std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool isEmpty() const
+    {
+        return m_head.load(std::memory_order_relaxed) == m_tail.load(std::memory_order_acquire);
+    }
+
+    private:
+    T m_items[CAPACITY];
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) std::atomic<size_t> m_tail;
+};
\ No newline at end of file
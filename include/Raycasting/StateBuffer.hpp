@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+
+// Lock-free double buffer for a single writer and any number of readers.
+// The writer fills the slot that is not published then flips the index;
+// a per-slot sequence number lets a reader detect (and retry) the rare case
+// where the writer came back to the slot it was copying.
+// T must be trivially copyable.
+template <typename T>
+class StateBuffer
+{
+    public:
+    StateBuffer()
+    {
+        m_publishedIndex.store(0, std::memory_order_relaxed);
+        m_sequence[0].store(0, std::memory_order_relaxed);
+        m_sequence[1].store(0, std::memory_order_relaxed);
+    }
+
+    void publish(const T &state)
+    {
+        const unsigned int index = m_publishedIndex.load(std::memory_order_relaxed) ^ 1;
+        const unsigned int sequence = m_sequence[index].load(std::memory_order_relaxed);
+
+        m_sequence[index].store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_slots[index] = state;
+        m_sequence[index].store(sequence + 2, std::memory_order_release);
+
+        m_publishedIndex.store(index, std::memory_order_release);
+    }
+
+    T read() const
+    {
+        T state;
+        unsigned int sequenceBefore;
+        unsigned int sequenceAfter;
+        do
+        {
+            const unsigned int index = m_publishedIndex.load(std::memory_order_acquire);
+            sequenceBefore = m_sequence[index].load(std::memory_order_acquire);
+            state = m_slots[index];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            sequenceAfter = m_sequence[index].load(std::memory_order_relaxed);
+        } while ((sequenceBefore & 1) || sequenceBefore != sequenceAfter);
+
+        return state;
+    }
+
+    private:
+    T m_slots[2];
+    std::atomic<unsigned int> m_sequence[2];
+    std::atomic<unsigned int> m_publishedIndex;
+};
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "MapManager.hpp"
+
+// Potentially visible set: for each region of the map (regionSize x regionSize cells),
+// the cells that can be seen from anywhere inside it. Computed once by casting fans of
+// rays from sample points of every free cell (in parallel), stored as run-length
+// encoded bitsets (varint runs on disk) and serialised next to the map.
+class VisibilitySet
+{
+    public:
+    VisibilitySet();
+
+    // raysPerSample = 0: enough rays to keep them less than half a cell apart across the map
+    void compute(const MapManager &mapManager, const unsigned int regionSize = 1, unsigned int raysPerSample = 0);
+    bool save(const std::string &path) const;
+    bool load(const std::string &path, const MapManager &mapManager);
+    // Same format, from a file image in memory (e.g. baked)
+    bool load(const unsigned char *bytes, const size_t size, const MapManager &mapManager);
+    bool loadOrCompute(const std::string &path, const MapManager &mapManager, const unsigned int regionSize = 1);
+
+    // Queries
+    bool isVisible(const unsigned int fromX, const unsigned int fromY, const unsigned int toX, const unsigned int toY) const;
+    void setViewerCell(const unsigned int x, const unsigned int y);
+    inline bool isVisibleFromViewer(const unsigned int x, const unsigned int y) const { return (m_viewerVisibleCells[coordinateToIndex(x, y) >> 6] >> (coordinateToIndex(x, y) & 63)) & 1; }
+
+    inline bool isComputed() const { return !m_regionsRuns.empty(); }
+    inline unsigned int getRegionSize() const { return m_regionSize; }
+    size_t getCompressedSize() const;
+
+    static unsigned int hashMap(const MapManager &mapManager);
+
+    private:
+    inline unsigned int coordinateToIndex(unsigned int x, unsigned int y) const { return x + y * m_width; }
+    inline unsigned int coordinateToRegion(unsigned int x, unsigned int y) const { return (x / m_regionSize) + (y / m_regionSize) * m_regionsPerRow; }
+    bool read(std::istream &input, const MapManager &mapManager);
+    void encodeRegion(const std::vector<unsigned long long> &bits, std::vector<unsigned int> &runs) const;
+
+    unsigned int m_width;
+    unsigned int m_height;
+    unsigned int m_regionSize;
+    unsigned int m_regionsPerRow;
+    unsigned int m_mapHash;
+
+    // Per region: alternating run lengths (hidden, visible, hidden...) and their end positions
+    std::vector<std::vector<unsigned int>> m_regionsRuns;
+    std::vector<std::vector<unsigned int>> m_regionsRunEnds;
+
+    // Decoded set of the viewer's region
+    std::vector<unsigned long long> m_viewerVisibleCells;
+    unsigned int m_viewerRegion;
+
+    const unsigned short FILE_VERSION = 2;
+};
\ No newline at end of file
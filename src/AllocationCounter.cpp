@@ -0,0 +1,113 @@
+#include <cstdlib>
+#include <new>
+
+#include "AllocationCounter.hpp"
+#include "SDL.h"
+
+std::atomic<unsigned long long> AllocationCounter::m_numberOfAllocations[(int)AllocationSubsystem::count];
+thread_local AllocationSubsystem AllocationCounter::m_currentSubsystem = AllocationSubsystem::other;
+
+#if defined(RAYCASTING_ALLOCATION_COUNTER)
+namespace
+{
+    SDL_malloc_func sdlMalloc = nullptr;
+    SDL_calloc_func sdlCalloc = nullptr;
+    SDL_realloc_func sdlRealloc = nullptr;
+    SDL_free_func sdlFree = nullptr;
+
+    void *countedMalloc(size_t size)
+    {
+        AllocationCounter::recordAllocation();
+        return sdlMalloc(size);
+    }
+
+    void *countedCalloc(size_t count, size_t size)
+    {
+        AllocationCounter::recordAllocation();
+        return sdlCalloc(count, size);
+    }
+
+    void *countedRealloc(void *pointer, size_t size)
+    {
+        AllocationCounter::recordAllocation();
+        return sdlRealloc(pointer, size);
+    }
+}
+
+void *operator new(size_t size)
+{
+    AllocationCounter::recordAllocation();
+    void *pointer = malloc(size != 0 ? size : 1);
+    if (pointer == nullptr)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void operator delete(void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    free(pointer);
+}
+#endif
+
+void AllocationCounter::initialise()
+{
+#if defined(RAYCASTING_ALLOCATION_COUNTER)
+    // SDL's allocator can only be replaced before SDL allocates anything
+    if (sdlMalloc == nullptr)
+    {
+        SDL_GetMemoryFunctions(&sdlMalloc, &sdlCalloc, &sdlRealloc, &sdlFree);
+        SDL_SetMemoryFunctions(countedMalloc, countedCalloc, countedRealloc, sdlFree);
+    }
+#endif
+    reset();
+}
+
+void AllocationCounter::reset()
+{
+    for (int i = 0; i < (int)AllocationSubsystem::count; i++)
+        m_numberOfAllocations[i] = 0;
+}
+
+void AllocationCounter::recordAllocation()
+{
+    m_numberOfAllocations[(int)m_currentSubsystem].fetch_add(1, std::memory_order_relaxed);
+}
+
+unsigned long long AllocationCounter::getNumberOfAllocations(const AllocationSubsystem subsystem)
+{
+    return m_numberOfAllocations[(int)subsystem];
+}
+
+unsigned long long AllocationCounter::getNumberOfAllocations()
+{
+    unsigned long long total = 0;
+    for (int i = 0; i < (int)AllocationSubsystem::count; i++)
+        total += m_numberOfAllocations[i];
+    return total;
+}
+
+const char *AllocationCounter::getSubsystemName(const AllocationSubsystem subsystem)
+{
+    switch (subsystem)
+    {
+        case AllocationSubsystem::input:
+            return "input";
+        case AllocationSubsystem::simulation:
+            return "simulation";
+        case AllocationSubsystem::casting:
+            return "casting";
+        case AllocationSubsystem::rendering:
+            return "rendering";
+        case AllocationSubsystem::sprites:
+            return "sprites";
+        case AllocationSubsystem::text:
+            return "text";
+        default:
+            return "other";
+    }
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include <cmath>
+#include <omp.h>
+
+#include "BatchRenderer.hpp"
+#include "Raycaster.hpp"
+#include "Toolbox.hpp"
+
+BatchRenderer::BatchRenderer(const unsigned int viewWidth, const unsigned int viewHeight, const unsigned int maxViews)
+{
+    m_viewWidth = viewWidth;
+    m_viewHeight = viewHeight;
+    m_maxViews = maxViews;
+    m_observations = new ObservationPixel[(size_t)m_maxViews * m_viewWidth * m_viewHeight];
+
+    Raycaster::generateTexture(m_texture, TEXTURE_SIZE);
+    m_rayAngleOffsets.resize(m_viewWidth);
+
+    // Sky & ground gradient, depth of the ground (or ceiling) plane seen by each row
+    const double maxBrightness = 45;
+    const double halfHeight = 0.5 * m_viewHeight;
+    m_background.resize(m_viewHeight);
+    for (unsigned int row = 0; row < m_viewHeight; row++)
+    {
+        double rowFromHorizon = std::fabs(row + 0.5 - halfHeight);
+        Uint8 brightness = maxBrightness * rowFromHorizon / halfHeight;
+        m_background[row] = ObservationPixel { brightness, brightness, brightness, 255, (float)(0.5 * m_viewHeight / rowFromHorizon) };
+    }
+}
+
+BatchRenderer::~BatchRenderer()
+{
+    delete[] m_observations;
+}
+
+bool BatchRenderer::render(const MapManager &mapManager, const PlayerState *poses, const unsigned int numberOfViews, const unsigned int fov)
+{
+    if (numberOfViews > m_maxViews)
+        return false;
+
+    // Same ray distribution as Raycaster::calculateRaysDistance_OMP, screen column 0 is on the left
+    const double inverseLinearRayDistributionFactor = 2.0 / (m_viewWidth * tan(0.5 * fov * Math::DEGREE_TO_RADIAN));
+    const int halfNumberOfRays = m_viewWidth >> 1;
+    for (unsigned int column = 0; column < m_viewWidth; column++)
+        m_rayAngleOffsets[column] = atan(inverseLinearRayDistributionFactor * ((int)(m_viewWidth - 1 - column) - halfNumberOfRays));
+
+    const size_t viewSize = (size_t)m_viewWidth * m_viewHeight;
+    const double maximumHeight = mapManager.getMaximumHeight();
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int view = 0; view < (int)numberOfViews; view++)
+        renderView(mapManager, maximumHeight, poses[view], m_observations + view * viewSize);
+
+    return true;
+}
+
+void BatchRenderer::renderView(const MapManager &mapManager, const double maximumHeight, const PlayerState &pose, ObservationPixel *view) const
+{
+    WallSpan spans[Raycaster::MAX_SPANS];
+    for (unsigned int column = 0; column < m_viewWidth; column++)
+    {
+        // Same traversal & shading as Raycaster::calculateRaysSpans_OMP
+        const double rayAngle = pose.angle + m_rayAngleOffsets[column];
+        double depth, firstHitX, firstHitY, firstLightFactor;
+        const unsigned int numberOfSpans = Raycaster::castSpans(mapManager, pose.x, pose.y, cos(rayAngle), -sin(rayAngle), cos(m_rayAngleOffsets[column]), maximumHeight, spans, depth, firstHitX, firstHitY, firstLightFactor);
+
+        // Background, then the spans back to front (see-through ones blended over what is behind)
+        for (unsigned int row = 0; row < m_viewHeight; row++)
+            view[row * m_viewWidth + column] = m_background[row];
+        for (int k = numberOfSpans - 1; k >= 0; k--)
+        {
+            const WallSpan &span = spans[k];
+            const unsigned int firstRow = Math::limitToInterval<double>(ceil(span.visibleTop * m_viewHeight - 0.5), 0, m_viewHeight);
+            const unsigned int lastRow = Math::limitToInterval<double>(ceil(span.visibleBottom * m_viewHeight - 0.5), 0, m_viewHeight);
+            for (unsigned int row = firstRow; row < lastRow; row++)
+            {
+                ObservationPixel &pixel = view[row * m_viewWidth + column];
+                SDL_Color color = span.color;
+                if (span.isTextured)
+                {
+                    const int textureYIndex = Math::limitToInterval<int>(((row + 0.5) / m_viewHeight - span.wallTop) / span.wallHeight * TEXTURE_SIZE, 0, TEXTURE_SIZE - 1);
+                    const SDL_Color &texel = m_texture[span.textureXIndex + textureYIndex * TEXTURE_SIZE];
+                    color = SDL_Color { (Uint8)(texel.r * span.color.r / 255), (Uint8)(texel.g * span.color.g / 255), (Uint8)(texel.b * span.color.b / 255), span.color.a };
+                }
+
+                if (color.a == 255)
+                    pixel = ObservationPixel { color.r, color.g, color.b, 255, (float)span.distance };
+                else
+                {
+                    // The depth stays the one of the opaque surface behind
+                    pixel.r = (color.r * color.a + pixel.r * (255 - color.a)) / 255;
+                    pixel.g = (color.g * color.a + pixel.g * (255 - color.a)) / 255;
+                    pixel.b = (color.b * color.a + pixel.b * (255 - color.a)) / 255;
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,1924 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <omp.h>
+
+#include "AllocationCounter.hpp"
+#include "Benchmark.hpp"
+#include "BatchRenderer.hpp"
+#include "Capp.hpp"
+#include "CpuFeatures.hpp"
+#include "EntityManager.hpp"
+#include "FrameBuffer.hpp"
+#include "FrameCapture.hpp"
+#include "FramePacer.hpp"
+#include "GlyphAtlas.hpp"
+#include "LidarScanner.hpp"
+#include "Raycaster.hpp"
+#include "ResolutionController.hpp"
+#include "SpriteManager.hpp"
+#include "VisibilitySet.hpp"
+#include "Toolbox.hpp"
+#include "SDL_ttf.h"
+#if defined(RAYCASTING_BAKED_ASSETS)
+#include "BakedAssets.hpp"
+#endif
+
+Benchmark::Benchmark()
+{
+    m_seed = 42;
+}
+
+bool Benchmark::run(const std::string &name)
+{
+    bool isAll = (name == "all");
+    bool isFound = false;
+    bool isSuccess = true;
+
+    if (isAll || name == "batch")
+    {
+        isFound = true;
+        isSuccess &= runBatch();
+    }
+
+    if (isAll || name == "lidar")
+    {
+        isFound = true;
+        isSuccess &= runLidar();
+    }
+
+    if (isAll || name == "pvs")
+    {
+        isFound = true;
+        isSuccess &= runVisibilitySet();
+    }
+
+    if (isAll || name == "entities")
+    {
+        isFound = true;
+        isSuccess &= runEntities();
+    }
+
+    if (isAll || name == "map")
+    {
+        isFound = true;
+        isSuccess &= runMapConnectivity();
+    }
+
+    if (isAll || name == "doors")
+    {
+        isFound = true;
+        isSuccess &= runDoors();
+    }
+
+    if (isAll || name == "spans")
+    {
+        isFound = true;
+        isSuccess &= runSpans();
+    }
+
+    if (isAll || name == "resolution")
+    {
+        isFound = true;
+        isSuccess &= runResolution();
+    }
+
+    if (isAll || name == "adaptive")
+    {
+        isFound = true;
+        isSuccess &= runAdaptive();
+    }
+
+    if (isAll || name == "temporal")
+    {
+        isFound = true;
+        isSuccess &= runTemporal();
+    }
+
+    if (isAll || name == "columns")
+    {
+        isFound = true;
+        isSuccess &= runColumns();
+    }
+
+    if (isAll || name == "transpose")
+    {
+        isFound = true;
+        isSuccess &= runTranspose();
+    }
+
+    if (isAll || name == "upscale")
+    {
+        isFound = true;
+        isSuccess &= runUpscale();
+    }
+
+    if (isAll || name == "geometry")
+    {
+        isFound = true;
+        isSuccess &= runGeometry();
+    }
+
+    if (isAll || name == "simd")
+    {
+        isFound = true;
+        isSuccess &= runSimd();
+    }
+
+    if (isAll || name == "sprites")
+    {
+        isFound = true;
+        isSuccess &= runSprites();
+    }
+
+    if (isAll || name == "allocations")
+    {
+        isFound = true;
+        isSuccess &= runAllocations();
+    }
+
+    if (isAll || name == "startup")
+    {
+        isFound = true;
+        isSuccess &= runStartup();
+    }
+
+    if (isAll || name == "openmaps")
+    {
+        isFound = true;
+        isSuccess &= runOpenMaps();
+    }
+
+    if (isAll || name == "capture")
+    {
+        isFound = true;
+        isSuccess &= runCapture();
+    }
+
+    if (isAll || name == "pacing")
+    {
+        isFound = true;
+        isSuccess &= runPacing();
+    }
+
+    if (!isFound)
+    {
+        std::cerr << "Unknown benchmark: " << name << std::endl;
+        return false;
+    }
+
+    return isSuccess;
+}
+
+bool Benchmark::runBatch()
+{
+    const unsigned int VIEW_WIDTH = 64;
+    const unsigned int VIEW_HEIGHT = 48;
+    const unsigned int NUMBER_OF_VIEWS = 4096;
+    const unsigned int REPETITIONS = 10;
+
+    MapManager mapManager;
+    std::vector<PlayerState> poses = generatePoses(mapManager, NUMBER_OF_VIEWS);
+    BatchRenderer batchRenderer(VIEW_WIDTH, VIEW_HEIGHT, NUMBER_OF_VIEWS);
+
+    // Warm up
+    batchRenderer.render(mapManager, poses.data(), NUMBER_OF_VIEWS);
+
+    auto startTimePoint = std::chrono::high_resolution_clock::now();
+    for (unsigned int i = 0; i < REPETITIONS; i++)
+        batchRenderer.render(mapManager, poses.data(), NUMBER_OF_VIEWS);
+    double elapsedTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+
+    double viewsPerSecond = NUMBER_OF_VIEWS * REPETITIONS / elapsedTime;
+    int numberOfThreads = omp_get_max_threads();
+    std::cout << "batch: " << NUMBER_OF_VIEWS << " views of " << VIEW_WIDTH << "x" << VIEW_HEIGHT << " (color + depth), " << numberOfThreads << " threads" << std::endl;
+    std::cout << "batch: " << (unsigned long long)viewsPerSecond << " views/s, " << (unsigned long long)(viewsPerSecond / numberOfThreads) << " views/s/thread" << std::endl;
+
+    // With special walls the views must see what Raycaster sees: the depth just below the
+    // horizon is the nearest opaque wall of the column (closer than half a view height)
+    const unsigned int NUMBER_OF_CHECKED_VIEWS = 256;
+    MapManager specialMapManager;
+    specialMapManager.addSpecialWalls();
+    std::vector<PlayerState> specialPoses = generatePoses(specialMapManager, NUMBER_OF_CHECKED_VIEWS);
+    batchRenderer.render(specialMapManager, specialPoses.data(), NUMBER_OF_CHECKED_VIEWS);
+    Raycaster raycaster;
+    raycaster.initialiseRaycaster(VIEW_WIDTH);
+    Player player;
+    unsigned int numberOfMismatches = 0;
+    for (unsigned int view = 0; view < NUMBER_OF_CHECKED_VIEWS; view++)
+    {
+        player.setState(specialPoses[view]);
+        raycaster.calculateRaysSpans_OMP(player, specialMapManager);
+        const ObservationPixel *observation = batchRenderer.getObservation(view) + (VIEW_HEIGHT / 2) * VIEW_WIDTH;
+        for (unsigned int column = 0; column < VIEW_WIDTH; column++)
+        {
+            const double depth = raycaster.getRaysDistance()[VIEW_WIDTH - 1 - column];
+            if (depth < 0.5 * VIEW_HEIGHT && observation[column].depth != (float)depth)
+                numberOfMismatches++;
+        }
+    }
+    std::cout << "batch: " << NUMBER_OF_CHECKED_VIEWS << " views with special walls against Raycaster, " << numberOfMismatches << " depth mismatches" << std::endl;
+
+    return numberOfMismatches == 0;
+}
+
+bool Benchmark::runLidar()
+{
+    const unsigned int NUMBER_OF_BEAMS = 360;
+    const double MAX_RANGE = 30;
+    const double NOISE_STANDARD_DEVIATION = 0.01;
+    const unsigned int NUMBER_OF_SCANS = 20000;
+
+    MapManager mapManager;
+    std::vector<PlayerState> poses = generatePoses(mapManager, 256);
+    std::vector<float> distances(NUMBER_OF_BEAMS);
+    double checksum = 0;
+
+    // Single thread: scans per second per core
+    for (double noise : { 0.0, NOISE_STANDARD_DEVIATION })
+    {
+        LidarScanner lidarScanner(NUMBER_OF_BEAMS, MAX_RANGE, noise, m_seed);
+        auto startTimePoint = std::chrono::high_resolution_clock::now();
+        for (unsigned int i = 0; i < NUMBER_OF_SCANS; i++)
+        {
+            const PlayerState &pose = poses[i % poses.size()];
+            lidarScanner.scan(mapManager, pose.x, pose.y, pose.angle + i * 1e-3, distances.data());
+            checksum += distances[i % NUMBER_OF_BEAMS];
+        }
+        double elapsedTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+
+        std::cout << "lidar: " << NUMBER_OF_BEAMS << " beams, range " << MAX_RANGE << ", noise " << noise << ": " << (unsigned long long)(NUMBER_OF_SCANS / elapsedTime) << " scans/s/core" << std::endl;
+    }
+
+    return checksum > 0;
+}
+
+bool Benchmark::runVisibilitySet()
+{
+    const unsigned int NUMBER_OF_QUERIES = 10000000;
+    const unsigned int NUMBER_OF_RAYS = 1000000;
+
+    MapManager defaultMap;
+    MapManager openMap(64, 64);
+    std::default_random_engine generator(m_seed);
+    bool isSuccess = true;
+
+    for (MapManager *mapManager : { &defaultMap, &openMap })
+    {
+        for (unsigned int regionSize : { 1, 4 })
+        {
+            VisibilitySet visibilitySet;
+            auto startTimePoint = std::chrono::high_resolution_clock::now();
+            visibilitySet.compute(*mapManager, regionSize);
+            double computeTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+
+            // Random queries
+            std::uniform_int_distribution<unsigned int> distributionX(0, mapManager->getWidth() - 1);
+            std::uniform_int_distribution<unsigned int> distributionY(0, mapManager->getHeight() - 1);
+            unsigned int numberOfVisible = 0;
+            startTimePoint = std::chrono::high_resolution_clock::now();
+            for (unsigned int i = 0; i < NUMBER_OF_QUERIES; i++)
+                numberOfVisible += visibilitySet.isVisible(distributionX(generator), distributionY(generator), distributionX(generator), distributionY(generator));
+            double queryTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+
+            // A cell always sees itself (free cells)
+            Player player;
+            player.initialisePlayer(*mapManager, m_seed);
+            isSuccess &= visibilitySet.isVisible(player.getX(), player.getY(), player.getX(), player.getY());
+
+            // Conservative: from anywhere in a free cell, the cells up to the first wall are in the set
+            std::uniform_real_distribution<double> distributionUnit(0, 1);
+            unsigned int numberOfMissed = 0;
+            for (unsigned int i = 0; i < NUMBER_OF_RAYS; i++)
+            {
+                const unsigned int cellX = distributionX(generator);
+                const unsigned int cellY = distributionY(generator);
+                if (mapManager->getMapElement(cellX, cellY) != 0 && !mapManager->isDoor(cellX, cellY))
+                    continue;
+
+                const double originX = cellX + distributionUnit(generator);
+                const double originY = cellY + distributionUnit(generator);
+                const double angle = 2 * M_PI * distributionUnit(generator);
+                const double rayDirectionX = cos(angle);
+                const double rayDirectionY = sin(angle);
+                int x = cellX;
+                int y = cellY;
+                const double deltaDistanceX = std::fabs(1 / rayDirectionX);
+                const double deltaDistanceY = std::fabs(1 / rayDirectionY);
+                double sideDistanceX = (rayDirectionX < 0) ? (originX - x) * deltaDistanceX : (x + 1 - originX) * deltaDistanceX;
+                double sideDistanceY = (rayDirectionY < 0) ? (originY - y) * deltaDistanceY : (y + 1 - originY) * deltaDistanceY;
+                while (mapManager->getMapElement(x, y) != MapManager::OUTSIDE_ELEMENT)
+                {
+                    if (!visibilitySet.isVisible(cellX, cellY, x, y))
+                    {
+                        numberOfMissed++;
+                        break;
+                    }
+                    if ((x != (int)cellX || y != (int)cellY) && mapManager->getMapElement(x, y) != 0 && !mapManager->isDoor(x, y))
+                        break;
+
+                    if (sideDistanceX < sideDistanceY)
+                    {
+                        sideDistanceX += deltaDistanceX;
+                        x += (rayDirectionX < 0) ? -1 : 1;
+                    }
+                    else
+                    {
+                        sideDistanceY += deltaDistanceY;
+                        y += (rayDirectionY < 0) ? -1 : 1;
+                    }
+                }
+            }
+            isSuccess &= numberOfMissed == 0;
+
+            std::cout << "pvs: " << mapManager->getWidth() << "x" << mapManager->getHeight() << " map, region " << regionSize << ": computed in " << computeTime * 1e3 << " ms (" << omp_get_max_threads() << " threads), "
+                      << visibilitySet.getCompressedSize() << " bytes, " << (unsigned long long)(NUMBER_OF_QUERIES / queryTime) << " queries/s, " << 100.0 * numberOfVisible / NUMBER_OF_QUERIES << "% visible, "
+                      << numberOfMissed << " missed cells on " << NUMBER_OF_RAYS << " random rays" << std::endl;
+        }
+    }
+
+    return isSuccess;
+}
+
+bool Benchmark::runEntities()
+{
+    const double HALF_SIZE = 0.1;
+    const double MAX_SPEED = 4;
+    const double TUNNELING_SPEED = 200;
+    const double DT = 1.0 / 60;
+    const unsigned int NUMBER_OF_TICKS = 300;
+
+    MapManager mapManager;
+    std::default_random_engine generator(m_seed);
+    std::uniform_real_distribution<double> distributionX(0, mapManager.getWidth());
+    std::uniform_real_distribution<double> distributionY(0, mapManager.getHeight());
+    std::uniform_real_distribution<double> distributionVelocity(-MAX_SPEED, MAX_SPEED);
+    bool isSuccess = true;
+
+    for (unsigned int numberOfEntities : { 10000, 50000 })
+    {
+        EntityManager entityManager;
+        entityManager.initialiseEntities(mapManager);
+        entityManager.setRestitution(1);
+        for (unsigned int i = 0; i < numberOfEntities; i++)
+        {
+            double x, y;
+            do
+            {
+                x = distributionX(generator);
+                y = distributionY(generator);
+            } while (mapManager.getMapElement(x - HALF_SIZE, y - HALF_SIZE) != 0 || mapManager.getMapElement(x + HALF_SIZE, y - HALF_SIZE) != 0 || mapManager.getMapElement(x - HALF_SIZE, y + HALF_SIZE) != 0 || mapManager.getMapElement(x + HALF_SIZE, y + HALF_SIZE) != 0);
+            entityManager.addEntity(x, y, HALF_SIZE, distributionVelocity(generator), distributionVelocity(generator));
+        }
+
+        unsigned long long numberOfCellChanges = 0;
+        unsigned long long numberOfContacts = 0;
+        auto startTimePoint = std::chrono::high_resolution_clock::now();
+        for (unsigned int tick = 0; tick < NUMBER_OF_TICKS; tick++)
+        {
+            entityManager.update(mapManager, DT);
+            numberOfCellChanges += entityManager.getNumberOfCellChanges();
+            numberOfContacts += entityManager.getNumberOfContacts();
+        }
+        double elapsedTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+
+        // Tunneling: huge displacements in a single tick must still stop at the first wall
+        for (unsigned int i = 0; i < numberOfEntities; i++)
+            entityManager.setVelocity(i, TUNNELING_SPEED * distributionVelocity(generator), TUNNELING_SPEED * distributionVelocity(generator));
+        entityManager.update(mapManager, 1);
+        unsigned int numberOfEntitiesInWalls = 0;
+        for (unsigned int i = 0; i < numberOfEntities; i++)
+        {
+            const double x = entityManager.getX(i);
+            const double y = entityManager.getY(i);
+            if (x < HALF_SIZE || y < HALF_SIZE || x >= mapManager.getWidth() - HALF_SIZE || y >= mapManager.getHeight() - HALF_SIZE || mapManager.getMapElement(x, y) != 0)
+                numberOfEntitiesInWalls++;
+        }
+        isSuccess &= (numberOfEntitiesInWalls == 0);
+
+        std::cout << "entities: " << numberOfEntities << " entities, " << omp_get_max_threads() << " threads: " << elapsedTime * 1e3 / NUMBER_OF_TICKS << " ms/tick, " << (unsigned long long)(numberOfEntities * NUMBER_OF_TICKS / elapsedTime) << " entity updates/s, "
+                  << numberOfCellChanges / NUMBER_OF_TICKS << " cell changes/tick, " << numberOfContacts / NUMBER_OF_TICKS << " contacts/tick, " << numberOfEntitiesInWalls << " in walls after a " << TUNNELING_SPEED * MAX_SPEED << " cells/s tick" << std::endl;
+    }
+
+    return isSuccess;
+}
+
+bool Benchmark::runMapConnectivity()
+{
+    const unsigned int MAP_SIZE = 256;
+    const double WALL_DENSITY = 0.4;
+    const unsigned int NUMBER_OF_SPAWNS = 1000000;
+    const unsigned int NUMBER_OF_EDITS = 100000;
+    const unsigned int NUMBER_OF_QUERIES = 10000000;
+
+    MapManager mapManager(MAP_SIZE, MAP_SIZE);
+    std::default_random_engine generator(m_seed);
+    std::uniform_int_distribution<unsigned int> distributionCell(1, MAP_SIZE - 2);
+    std::bernoulli_distribution distributionWall(WALL_DENSITY);
+
+    // Random cave, built through the incremental updates
+    auto startTimePoint = std::chrono::high_resolution_clock::now();
+    for (unsigned int y = 1; y < MAP_SIZE - 1; y++)
+        for (unsigned int x = 1; x < MAP_SIZE - 1; x++)
+            if (distributionWall(generator))
+                mapManager.setMapElement(x, y, 1);
+    double buildTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+    std::cout << "map: " << MAP_SIZE << "x" << MAP_SIZE << ", " << mapManager.getNumberOfFreeCells() << " free cells, " << mapManager.getNumberOfComponents() << " components, largest " << mapManager.getComponentSize(mapManager.getLargestComponent())
+              << " cells, built cell by cell in " << buildTime * 1e3 << " ms" << std::endl;
+
+    // Spawns: rejection sampling (any free cell, maybe a sealed one) vs the component list
+    unsigned long long numberOfAttempts = 0;
+    unsigned long long checksum = 0;
+    startTimePoint = std::chrono::high_resolution_clock::now();
+    for (unsigned int i = 0; i < NUMBER_OF_SPAWNS; i++)
+    {
+        unsigned int x, y;
+        do
+        {
+            x = distributionCell(generator);
+            y = distributionCell(generator);
+            numberOfAttempts++;
+        } while (mapManager.getMapElement(x, y) != 0);
+        checksum += x + y;
+    }
+    double rejectionTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+
+    startTimePoint = std::chrono::high_resolution_clock::now();
+    for (unsigned int i = 0; i < NUMBER_OF_SPAWNS; i++)
+    {
+        unsigned int x, y;
+        mapManager.getRandomFreeCell(generator, x, y);
+        checksum += x + y;
+    }
+    double componentTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+    std::cout << "map: spawn, rejection " << rejectionTime * 1e9 / NUMBER_OF_SPAWNS << " ns (" << (double)numberOfAttempts / NUMBER_OF_SPAWNS << " attempts), largest component " << componentTime * 1e9 / NUMBER_OF_SPAWNS << " ns" << std::endl;
+
+    // Edits: open & close random cells
+    startTimePoint = std::chrono::high_resolution_clock::now();
+    for (unsigned int i = 0; i < NUMBER_OF_EDITS; i++)
+        mapManager.setMapElement(distributionCell(generator), distributionCell(generator), distributionWall(generator) ? 1 : 0);
+    double editTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+
+    // Reachability queries
+    unsigned int numberOfReachable = 0;
+    startTimePoint = std::chrono::high_resolution_clock::now();
+    for (unsigned int i = 0; i < NUMBER_OF_QUERIES; i++)
+        numberOfReachable += mapManager.isReachable(distributionCell(generator), distributionCell(generator), distributionCell(generator), distributionCell(generator));
+    double queryTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+    std::cout << "map: " << editTime * 1e6 / NUMBER_OF_EDITS << " us/edit, " << (unsigned long long)(NUMBER_OF_QUERIES / queryTime) << " reachability queries/s (" << 100.0 * numberOfReachable / NUMBER_OF_QUERIES << "% reachable)" << std::endl;
+
+    // Check the incremental labels against a labelling from scratch: same partition
+    std::vector<unsigned int> labels(MAP_SIZE * MAP_SIZE, MapManager::NO_COMPONENT);
+    std::vector<unsigned int> labelToComponent;
+    std::vector<unsigned int> componentToLabel(MAP_SIZE * MAP_SIZE, MapManager::NO_COMPONENT);
+    std::vector<unsigned int> stack;
+    bool isConsistent = true;
+    unsigned int numberOfFreeCells = 0;
+    for (unsigned int start = 0; start < MAP_SIZE * MAP_SIZE; start++)
+    {
+        if (mapManager.getMapElement(start % MAP_SIZE, start / MAP_SIZE) != 0 || labels[start] != MapManager::NO_COMPONENT)
+            continue;
+
+        const unsigned int label = labelToComponent.size();
+        labelToComponent.push_back(mapManager.getComponent(start % MAP_SIZE, start / MAP_SIZE));
+        stack.push_back(start);
+        labels[start] = label;
+        while (!stack.empty())
+        {
+            const unsigned int cell = stack.back();
+            const unsigned int x = cell % MAP_SIZE;
+            const unsigned int y = cell / MAP_SIZE;
+            stack.pop_back();
+            numberOfFreeCells++;
+
+            const unsigned int component = mapManager.getComponent(x, y);
+            if (component == MapManager::NO_COMPONENT || component != labelToComponent[label] || (componentToLabel[component] != MapManager::NO_COMPONENT && componentToLabel[component] != label))
+                isConsistent = false;
+            else
+                componentToLabel[component] = label;
+
+            for (unsigned int neighbour : { cell - 1, cell + 1, cell - MAP_SIZE, cell + MAP_SIZE })
+            {
+                if (mapManager.getMapElement(neighbour % MAP_SIZE, neighbour / MAP_SIZE) != 0 || labels[neighbour] != MapManager::NO_COMPONENT)
+                    continue;
+                labels[neighbour] = label;
+                stack.push_back(neighbour);
+            }
+        }
+    }
+    isConsistent &= (numberOfFreeCells == mapManager.getNumberOfFreeCells() && labelToComponent.size() == mapManager.getNumberOfComponents());
+    std::cout << "map: incremental labels " << (isConsistent ? "match" : "DO NOT match") << " a full relabelling (" << labelToComponent.size() << " components)" << std::endl;
+
+    return isConsistent && checksum > 0;
+}
+
+bool Benchmark::runDoors()
+{
+    const unsigned int MAP_SIZE = 512;
+    const unsigned int ROOM_SIZE = 8;
+    const unsigned int TOGGLES_PER_FRAME = 100;
+    const unsigned int NUMBER_OF_FRAMES = 600;
+
+    // Grid of rooms, a door in the middle of every inner wall
+    std::vector<char> cells(MAP_SIZE * MAP_SIZE, 0);
+    for (unsigned int y = 0; y < MAP_SIZE; y++)
+        for (unsigned int x = 0; x < MAP_SIZE; x++)
+            if (x % ROOM_SIZE == 0 || y % ROOM_SIZE == 0 || x == MAP_SIZE - 1 || y == MAP_SIZE - 1)
+                cells[x + y * MAP_SIZE] = 1;
+
+    auto startTimePoint = std::chrono::high_resolution_clock::now();
+    MapManager mapManager(MAP_SIZE, MAP_SIZE, cells.data());
+    double buildTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+
+    for (unsigned int wall = ROOM_SIZE; wall < MAP_SIZE - ROOM_SIZE; wall += ROOM_SIZE)
+    {
+        for (unsigned int room = 0; room + ROOM_SIZE < MAP_SIZE; room += ROOM_SIZE)
+        {
+            mapManager.addDoor(wall, room + ROOM_SIZE / 2);
+            mapManager.addDoor(room + ROOM_SIZE / 2, wall);
+        }
+    }
+    std::cout << "doors: " << MAP_SIZE << "x" << MAP_SIZE << " map, " << mapManager.getNumberOfDoors() << " doors, full build " << buildTime * 1e3 << " ms" << std::endl;
+
+    // Frames: toggle random doors, then a consumer catches up through the journal
+    std::default_random_engine generator(m_seed);
+    std::uniform_int_distribution<unsigned int> distributionDoor(0, mapManager.getNumberOfDoors() - 1);
+    std::vector<MapChange> changes;
+    unsigned long long consumerRevision = mapManager.getRevision();
+    unsigned long long numberOfChanges = 0;
+    double toggleTime = 0;
+    double consumerTime = 0;
+    for (unsigned int frame = 0; frame < NUMBER_OF_FRAMES; frame++)
+    {
+        startTimePoint = std::chrono::high_resolution_clock::now();
+        for (unsigned int i = 0; i < TOGGLES_PER_FRAME; i++)
+        {
+            unsigned int door = distributionDoor(generator);
+            mapManager.toggleDoor(mapManager.getDoorX(door), mapManager.getDoorY(door));
+        }
+        auto toggledTimePoint = std::chrono::high_resolution_clock::now();
+
+        changes.clear();
+        if (!mapManager.getChangesSince(consumerRevision, changes))
+            return false;
+        consumerRevision += changes.size();
+        numberOfChanges += changes.size();
+        toggleTime += std::chrono::duration<double>(toggledTimePoint - startTimePoint).count();
+        consumerTime += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - toggledTimePoint).count();
+    }
+
+    const unsigned int numberOfToggles = TOGGLES_PER_FRAME * NUMBER_OF_FRAMES;
+    std::cout << "doors: " << TOGGLES_PER_FRAME << " toggles/frame, " << toggleTime * 1e6 / numberOfToggles << " us/toggle (" << (unsigned long long)(numberOfToggles / toggleTime) << " toggles/s), journal read " << consumerTime * 1e6 / NUMBER_OF_FRAMES << " us/frame, "
+              << mapManager.getNumberOfComponents() << " components, largest " << mapManager.getComponentSize(mapManager.getLargestComponent()) << " cells" << std::endl;
+
+    return numberOfChanges == numberOfToggles && consumerRevision == mapManager.getRevision();
+}
+
+bool Benchmark::runSpans()
+{
+    const unsigned int MAP_SIZE = 128;
+    const double WALL_DENSITY = 0.08;
+    const unsigned int NUMBER_OF_RAYS = 1280;
+    const unsigned int NUMBER_OF_FRAMES = 2000;
+
+    // Scattered walls, a growing part of them see-through or not full height
+    bool isSuccess = true;
+    for (double specialRatio : { 0.0, 0.25, 0.5, 1.0 })
+    {
+        std::default_random_engine generator(m_seed);
+        std::uniform_real_distribution<double> distribution(0, 1);
+        std::uniform_int_distribution<int> distributionSpecial(7, 9);
+        std::vector<char> cells(MAP_SIZE * MAP_SIZE, 0);
+        for (unsigned int y = 0; y < MAP_SIZE; y++)
+        {
+            for (unsigned int x = 0; x < MAP_SIZE; x++)
+            {
+                if (x == 0 || y == 0 || x == MAP_SIZE - 1 || y == MAP_SIZE - 1)
+                    cells[x + y * MAP_SIZE] = 1;
+                else if (distribution(generator) < WALL_DENSITY)
+                    cells[x + y * MAP_SIZE] = (distribution(generator) < specialRatio) ? distributionSpecial(generator) : 1;
+            }
+        }
+        MapManager mapManager(MAP_SIZE, MAP_SIZE, cells.data());
+        std::vector<PlayerState> poses = generatePoses(mapManager, 256);
+
+        Player player;
+        Raycaster singleHitRaycaster;
+        Raycaster multiHitRaycaster;
+        singleHitRaycaster.initialiseRaycaster(NUMBER_OF_RAYS);
+        multiHitRaycaster.initialiseRaycaster(NUMBER_OF_RAYS);
+
+        double singleHitTime = 0;
+        double multiHitTime = 0;
+        unsigned long long numberOfSpans = 0;
+        unsigned long long numberOfMismatches = 0;
+        for (unsigned int frame = 0; frame < NUMBER_OF_FRAMES; frame++)
+        {
+            player.setState(poses[frame % poses.size()]);
+
+            auto startTimePoint = std::chrono::high_resolution_clock::now();
+            singleHitRaycaster.calculateRaysDistance_OMP(player, mapManager);
+            auto singleHitTimePoint = std::chrono::high_resolution_clock::now();
+            multiHitRaycaster.calculateRaysSpans_OMP(player, mapManager);
+            auto multiHitTimePoint = std::chrono::high_resolution_clock::now();
+            singleHitTime += std::chrono::duration<double>(singleHitTimePoint - startTimePoint).count();
+            multiHitTime += std::chrono::duration<double>(multiHitTimePoint - singleHitTimePoint).count();
+
+            // Without special walls both traversals must see the same walls
+            for (unsigned int i = 0; i < NUMBER_OF_RAYS; i++)
+            {
+                numberOfSpans += multiHitRaycaster.getNumberOfSpans(i);
+                if (specialRatio == 0 && std::abs(singleHitRaycaster.getRaysDistance()[i] - multiHitRaycaster.getRaysDistance()[i]) > 1e-4)
+                    numberOfMismatches++;
+            }
+        }
+
+        std::cout << "spans: " << (int)(specialRatio * 100) << "% special walls, " << NUMBER_OF_RAYS << " rays: single-hit " << singleHitTime * 1e6 / NUMBER_OF_FRAMES << " us/frame, multi-hit " << multiHitTime * 1e6 / NUMBER_OF_FRAMES << " us/frame (x"
+                  << multiHitTime / singleHitTime << "), " << (double)numberOfSpans / (NUMBER_OF_FRAMES * NUMBER_OF_RAYS) << " spans/column";
+        if (specialRatio == 0)
+            std::cout << ", " << numberOfMismatches << " depth mismatches";
+        std::cout << std::endl;
+        isSuccess &= (numberOfMismatches == 0);
+    }
+
+    return isSuccess;
+}
+
+bool Benchmark::runResolution()
+{
+    const unsigned int SCREEN_WIDTH = 3840;
+    const unsigned int NUMBER_OF_FRAMES = 1200;
+    const unsigned int CAST_REPETITIONS = 4;
+
+    MapManager mapManager;
+    std::vector<PlayerState> poses = generatePoses(mapManager, 256);
+    Player player;
+    Raycaster raycaster;
+    raycaster.initialiseRaycaster(SCREEN_WIDTH);
+
+    // A frame is made of a few casts so the timings are not only noise. The camera turns
+    // slowly from pose to pose, like a player looking around: the cost follows the view
+    auto castFrame = [&](unsigned int frame)
+    {
+        auto startTimePoint = std::chrono::high_resolution_clock::now();
+        PlayerState pose = poses[frame / 300 % poses.size()];
+        pose.angle += 0.02 * frame;
+        player.setState(pose);
+        for (unsigned int i = 0; i < CAST_REPETITIONS; i++)
+            raycaster.calculateRays_OMP(player, mapManager);
+        return 1e3 * std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+    };
+
+    // Reference: full resolution
+    double fullResolutionTime = 0;
+    std::vector<double> fullResolutionFrameTimes(NUMBER_OF_FRAMES);
+    for (unsigned int frame = 0; frame < NUMBER_OF_FRAMES; frame++)
+    {
+        fullResolutionFrameTimes[frame] = castFrame(frame);
+        fullResolutionTime += fullResolutionFrameTimes[frame] / NUMBER_OF_FRAMES;
+    }
+
+    // Budgets below the average full resolution cost: the controller has to follow the view
+    bool isSuccess = true;
+    for (double budgetRatio : { 0.75, 0.5 })
+    {
+        const double budget = budgetRatio * fullResolutionTime;
+        ResolutionController resolutionController;
+        resolutionController.setBudget(budget);
+        unsigned int numberOfChanges = 0;
+        unsigned int numberOfOverBudgetFrames = 0;
+        unsigned int numberOfFullResolutionOverBudgetFrames = 0;
+        double averageScale = 0;
+        double averageFrameTime = 0;
+        for (unsigned int frame = 0; frame < NUMBER_OF_FRAMES; frame++)
+        {
+            raycaster.setNumberOfRays(resolutionController.getNumberOfRays(SCREEN_WIDTH));
+            double frameTime = castFrame(frame);
+            averageScale += resolutionController.getScale() / NUMBER_OF_FRAMES;
+            averageFrameTime += frameTime / NUMBER_OF_FRAMES;
+            numberOfChanges += resolutionController.update(frameTime);
+            numberOfOverBudgetFrames += (frameTime > budget);
+            numberOfFullResolutionOverBudgetFrames += (fullResolutionFrameTimes[frame] > budget);
+        }
+
+        std::cout << "resolution: " << SCREEN_WIDTH << " columns, full " << fullResolutionTime << " ms/frame, budget " << budget << " ms: average scale " << averageScale << ", " << averageFrameTime << " ms/frame, " << numberOfChanges << " changes, "
+                  << numberOfOverBudgetFrames << "/" << NUMBER_OF_FRAMES << " frames over budget (" << numberOfFullResolutionOverBudgetFrames << " at full resolution)" << std::endl;
+        isSuccess &= (numberOfOverBudgetFrames < numberOfFullResolutionOverBudgetFrames);
+    }
+
+    return isSuccess;
+}
+
+bool Benchmark::runAdaptive()
+{
+    const unsigned int NUMBER_OF_RAYS = 1920;
+    const unsigned int NUMBER_OF_FRAMES = 1000;
+    const unsigned int MAP_SIZE = 128;
+
+    // Default map, rooms with openings & scattered pillars
+    std::vector<char> roomsCells;
+    std::vector<char> pillarsCells;
+    generateTestMaps(MAP_SIZE, roomsCells, pillarsCells);
+    MapManager defaultMapManager;
+    MapManager roomsMapManager(MAP_SIZE, MAP_SIZE, roomsCells.data());
+    MapManager pillarsMapManager(MAP_SIZE, MAP_SIZE, pillarsCells.data());
+    const std::pair<const char *, MapManager *> maps[] = { { "default", &defaultMapManager }, { "rooms", &roomsMapManager }, { "pillars", &pillarsMapManager } };
+
+    bool isSuccess = true;
+    for (const auto &map : maps)
+    {
+        MapManager &mapManager = *map.second;
+        std::vector<PlayerState> poses = generatePoses(mapManager, NUMBER_OF_FRAMES);
+        Player player;
+        Raycaster fullRaycaster;
+        Raycaster adaptiveRaycaster;
+        fullRaycaster.initialiseRaycaster(NUMBER_OF_RAYS);
+        adaptiveRaycaster.initialiseRaycaster(NUMBER_OF_RAYS);
+
+        // Reference: the same kernel casting every ray, hits must be the same (texture, color &
+        // light follow from the hit point)
+        double fullTime = 0;
+        for (unsigned int frame = 0; frame < NUMBER_OF_FRAMES; frame++)
+        {
+            player.setState(poses[frame]);
+            auto startTimePoint = std::chrono::high_resolution_clock::now();
+            fullRaycaster.calculateRaysAdaptive_OMP(player, mapManager, 90, 1);
+            fullTime += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+        }
+
+        for (unsigned int stride : { 4, 8, 16, 32 })
+        {
+            double adaptiveTime = 0;
+            unsigned long long numberOfCastRays = 0;
+            unsigned long long numberOfMismatches = 0;
+            for (unsigned int frame = 0; frame < NUMBER_OF_FRAMES; frame++)
+            {
+                player.setState(poses[frame]);
+                auto startTimePoint = std::chrono::high_resolution_clock::now();
+                adaptiveRaycaster.calculateRaysAdaptive_OMP(player, mapManager, 90, stride);
+                adaptiveTime += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+                numberOfCastRays += adaptiveRaycaster.getNumberOfCastRays();
+
+                fullRaycaster.calculateRaysAdaptive_OMP(player, mapManager, 90, 1);
+                for (unsigned int i = 0; i < NUMBER_OF_RAYS; i++)
+                {
+                    const double fullDistance = fullRaycaster.getRaysDistance()[i];
+                    const double adaptiveDistance = adaptiveRaycaster.getRaysDistance()[i];
+                    if (std::isinf(fullDistance) != std::isinf(adaptiveDistance) || (!std::isinf(fullDistance) && std::abs(fullDistance - adaptiveDistance) > 1e-9 * fullDistance))
+                        numberOfMismatches++;
+                    else if (!std::isinf(fullDistance) && (fullRaycaster.getRaysX()[i] != adaptiveRaycaster.getRaysX()[i] || fullRaycaster.getRaysY()[i] != adaptiveRaycaster.getRaysY()[i]))
+                        numberOfMismatches++;
+                }
+            }
+
+            const double savedRatio = 1 - (double)numberOfCastRays / ((unsigned long long)NUMBER_OF_FRAMES * NUMBER_OF_RAYS);
+            std::cout << "adaptive: " << map.first << " map, stride " << stride << ": " << 100 * savedRatio << "% rays saved, " << adaptiveTime * 1e6 / NUMBER_OF_FRAMES << " us/frame (full " << fullTime * 1e6 / NUMBER_OF_FRAMES << " us/frame), "
+                      << numberOfMismatches << " mismatches" << std::endl;
+            isSuccess &= (numberOfMismatches == 0);
+        }
+    }
+
+    return isSuccess;
+}
+
+bool Benchmark::runTemporal()
+{
+    const unsigned int NUMBER_OF_RAYS = 1920;
+    const unsigned int NUMBER_OF_FRAMES = 1200;
+    const unsigned int NUMBER_OF_PATHS = 8;
+    const unsigned int MAP_SIZE = 128;
+    const double DELTA_TIME = 1.0 / 60;
+    const char *RECORDINGS[] = { "walkthrough.rcrp" };
+
+    // Full, adaptive & temporal casting along a camera path, the temporal hits checked against the full ones
+    auto measure = [NUMBER_OF_RAYS](const std::string &label, MapManager &mapManager, const std::vector<PlayerState> &path) -> bool
+    {
+        Player player;
+        Raycaster fullRaycaster;
+        Raycaster adaptiveRaycaster;
+        Raycaster temporalRaycaster;
+        fullRaycaster.initialiseRaycaster(NUMBER_OF_RAYS);
+        adaptiveRaycaster.initialiseRaycaster(NUMBER_OF_RAYS);
+        temporalRaycaster.initialiseRaycaster(NUMBER_OF_RAYS);
+
+        double fullTime = 0;
+        double adaptiveTime = 0;
+        double temporalTime = 0;
+        unsigned long long adaptiveCastRays = 0;
+        unsigned long long temporalCastRays = 0;
+        unsigned long long numberOfMismatches = 0;
+        for (unsigned int frame = 0; frame < path.size(); frame++)
+        {
+            player.setState(path[frame]);
+
+            auto startTimePoint = std::chrono::high_resolution_clock::now();
+            fullRaycaster.calculateRaysAdaptive_OMP(player, mapManager, 90, 1);
+            auto fullTimePoint = std::chrono::high_resolution_clock::now();
+            adaptiveRaycaster.calculateRaysAdaptive_OMP(player, mapManager, 90, 8);
+            auto adaptiveTimePoint = std::chrono::high_resolution_clock::now();
+            temporalRaycaster.calculateRaysTemporal_OMP(player, mapManager, 90);
+            auto temporalTimePoint = std::chrono::high_resolution_clock::now();
+            fullTime += std::chrono::duration<double>(fullTimePoint - startTimePoint).count();
+            adaptiveTime += std::chrono::duration<double>(adaptiveTimePoint - fullTimePoint).count();
+            temporalTime += std::chrono::duration<double>(temporalTimePoint - adaptiveTimePoint).count();
+            adaptiveCastRays += adaptiveRaycaster.getNumberOfCastRays();
+            temporalCastRays += temporalRaycaster.getNumberOfCastRays();
+
+            // Same hits as casting every ray
+            for (unsigned int i = 0; i < NUMBER_OF_RAYS; i++)
+                if (fullRaycaster.getRaysX()[i] != temporalRaycaster.getRaysX()[i] || fullRaycaster.getRaysY()[i] != temporalRaycaster.getRaysY()[i])
+                    numberOfMismatches++;
+        }
+
+        const double numberOfRays = (double)path.size() * NUMBER_OF_RAYS;
+        std::cout << "temporal: " << label << ", " << path.size() << " frames: full " << fullTime * 1e6 / path.size() << " us/frame, adaptive (stride 8) " << adaptiveTime * 1e6 / path.size() << " us/frame ("
+                  << 100 * adaptiveCastRays / numberOfRays << "% rays cast), temporal " << temporalTime * 1e6 / path.size() << " us/frame (" << 100 * temporalCastRays / numberOfRays << "% rays cast), " << numberOfMismatches << " mismatches" << std::endl;
+        return numberOfMismatches == 0;
+    };
+
+    std::vector<char> roomsCells;
+    std::vector<char> pillarsCells;
+    generateTestMaps(MAP_SIZE, roomsCells, pillarsCells);
+    MapManager defaultMapManager;
+    MapManager roomsMapManager(MAP_SIZE, MAP_SIZE, roomsCells.data());
+    MapManager pillarsMapManager(MAP_SIZE, MAP_SIZE, pillarsCells.data());
+    const std::pair<const char *, MapManager *> maps[] = { { "default", &defaultMapManager }, { "rooms", &roomsMapManager }, { "pillars", &pillarsMapManager } };
+
+    bool isSuccess = true;
+    for (const auto &map : maps)
+    {
+        MapManager &mapManager = *map.second;
+
+        // Synthetic camera paths: walk & look around (sprinting at times), turn away from the walls
+        std::vector<PlayerState> path;
+        std::default_random_engine generator(m_seed);
+        std::uniform_real_distribution<double> distribution(-1, 1);
+        for (unsigned int pathIndex = 0; pathIndex < NUMBER_OF_PATHS; pathIndex++)
+        {
+            Player player;
+            player.initialisePlayer(mapManager, m_seed + pathIndex);
+            double angularSpeed = 0;
+            for (unsigned int frame = 0; frame < NUMBER_OF_FRAMES / NUMBER_OF_PATHS; frame++)
+            {
+                if (frame % 30 == 0)
+                    angularSpeed = distribution(generator);
+                const double previousX = player.getX();
+                const double previousY = player.getY();
+                player.movePlayer(mapManager, 1, 0, (frame / 120) % 2 == 1, DELTA_TIME);
+                if (frame > 10 && std::abs(player.getX() - previousX) + std::abs(player.getY() - previousY) < 1e-3)
+                    angularSpeed = 1;
+                player.rotatePlayer(angularSpeed, DELTA_TIME);
+                path.push_back(player.getState());
+            }
+        }
+
+        isSuccess &= measure(std::string(map.first) + " map, " + std::to_string(NUMBER_OF_PATHS) + " paths", mapManager, path);
+    }
+
+    // Recorded paths: the poses a headless replay casts from (the recordings are made on the default map)
+    for (const char *recording : RECORDINGS)
+    {
+        std::string recordingPath;
+        for (const std::string &path : { std::string("imports/recordings/") + recording, std::string("../imports/recordings/") + recording })
+            if (std::ifstream(path).is_open())
+                recordingPath = path;
+        if (recordingPath.empty())
+        {
+            std::cout << "temporal: " << recording << ": unavailable" << std::endl;
+            continue;
+        }
+
+        std::vector<PlayerState> path;
+        Capp app;
+        app.setReplayFile(recordingPath);
+        app.setHeadless(true);
+        app.setCastPoses(&path);
+        if (!app.run() || path.empty())
+        {
+            std::cerr << "temporal: cannot replay " << recordingPath << std::endl;
+            isSuccess = false;
+            continue;
+        }
+
+        isSuccess &= measure(std::string(recording) + " (recorded)", defaultMapManager, path);
+    }
+
+    return isSuccess;
+}
+
+void Benchmark::generateTestMaps(const unsigned int size, std::vector<char> &roomsCells, std::vector<char> &pillarsCells)
+{
+    // Rooms with openings in the middle of their walls & scattered pillars, colored blocks
+    std::default_random_engine generator(m_seed);
+    std::uniform_real_distribution<double> distribution(0, 1);
+    roomsCells.assign(size * size, 0);
+    pillarsCells.assign(size * size, 0);
+    for (unsigned int y = 0; y < size; y++)
+    {
+        for (unsigned int x = 0; x < size; x++)
+        {
+            const bool isBorder = (x == 0 || y == 0 || x == size - 1 || y == size - 1);
+            const bool isRoomWall = (x % 12 == 0 || y % 12 == 0) && (x % 12 != 6 && y % 12 != 6);
+            roomsCells[x + y * size] = (isBorder || isRoomWall) ? 1 + (x / 12 + y / 12) % 5 : 0;
+            pillarsCells[x + y * size] = (isBorder || distribution(generator) < 0.08) ? 1 + (x + y) % 5 : 0;
+        }
+    }
+}
+
+std::vector<PlayerState> Benchmark::generatePoses(MapManager &mapManager, const unsigned int count)
+{
+    std::default_random_engine generator(m_seed);
+    std::uniform_real_distribution<double> distributionAngle(0, 360 * Math::DEGREE_TO_RADIAN);
+
+    std::vector<PlayerState> poses(count);
+    Player player;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        player.initialisePlayer(mapManager, m_seed + i);
+        poses[i] = player.getState();
+        poses[i].angle = distributionAngle(generator);
+    }
+
+    return poses;
+}
+
+bool Benchmark::runColumns()
+{
+    const unsigned int TEXTURE_SIZE = 32;
+    const unsigned int NUMBER_OF_FRAMES = 20;
+    const struct { unsigned int width; unsigned int height; } RESOLUTIONS[] = { { 1920, 1080 }, { 2560, 1440 }, { 3840, 2160 } };
+
+    std::default_random_engine generator(m_seed);
+    std::uniform_int_distribution<unsigned int> distributionTexel(0, 0xFFFFFF);
+    std::vector<Uint32> texture(TEXTURE_SIZE * TEXTURE_SIZE);
+    for (Uint32 &texel : texture)
+        texel = 0xFF000000u | distributionTexel(generator);
+
+    // One textured wall span per screen column (kernels only, single thread): random heights
+    // from far walls to walls 3 times taller than the screen, random shades & bob
+    const SimdLevel selectedLevel = CpuFeatures::getLevel();
+    bool isSuccess = true;
+    for (const auto &resolution : RESOLUTIONS)
+    {
+        const int width = resolution.width;
+        const int height = resolution.height;
+        std::uniform_real_distribution<double> distributionHeight(0.05 * height, 3.0 * height);
+        std::uniform_real_distribution<double> distributionOffset(-0.02 * height, 0.02 * height);
+        std::uniform_int_distribution<unsigned int> distributionShade(32, 256);
+        std::uniform_int_distribution<unsigned int> distributionColumn(0, TEXTURE_SIZE - 1);
+        std::vector<double> wallTops(width);
+        std::vector<double> wallHeights(width);
+        std::vector<unsigned int> shades(width);
+        std::vector<unsigned int> textureColumns(width);
+        for (int x = 0; x < width; x++)
+        {
+            wallHeights[x] = distributionHeight(generator);
+            wallTops[x] = 0.5 * (height - wallHeights[x]) + distributionOffset(generator);
+            shades[x] = distributionShade(generator);
+            textureColumns[x] = distributionColumn(generator);
+        }
+
+        std::vector<Uint32> referencePixels(width * height, 0);
+        double referenceTime = 0;
+        for (unsigned int frame = 0; frame < NUMBER_OF_FRAMES; frame++)
+        {
+            // Reference: texture v in double precision and clipping test per pixel
+            auto startTimePoint = std::chrono::high_resolution_clock::now();
+            for (int x = 0; x < width; x++)
+            {
+                const Uint32 *textureColumn = texture.data() + textureColumns[x] * TEXTURE_SIZE;
+                for (int y = 0; y < height; y++)
+                {
+                    const double v = (y + 0.5 - wallTops[x]) * TEXTURE_SIZE / wallHeights[x];
+                    if (v < 0 || v >= TEXTURE_SIZE)
+                        continue;
+                    const Uint32 texel = textureColumn[(int)v];
+                    const Uint32 redBlue = (((texel & 0x00FF00FF) * shades[x]) >> 8) & 0x00FF00FF;
+                    const Uint32 green = (((texel & 0x0000FF00) * shades[x]) >> 8) & 0x0000FF00;
+                    referencePixels[x + y * width] = 0xFF000000u | redBlue | green;
+                }
+            }
+            auto referenceTimePoint = std::chrono::high_resolution_clock::now();
+            referenceTime += std::chrono::duration<double>(referenceTimePoint - startTimePoint).count();
+        }
+
+        // Kernels of every supported level: clipped once per span, then fixed point stepping.
+        // Into the row-major frame (stride = width) and into a column-major buffer (contiguous)
+        std::vector<Uint32> scalarPixels[2];
+        unsigned long long numberOfPixels = 0;
+        unsigned long long numberOfMismatches = 0;
+        unsigned long long numberOfTexelDifferences = 0;
+        std::cout << "columns: " << width << "x" << height << ", reference " << referenceTime * 1e3 / NUMBER_OF_FRAMES << " ms/frame" << std::endl;
+        for (SimdLevel level = SimdLevel::scalar; level <= CpuFeatures::getSupportedLevel(); level = (SimdLevel)((int)level + 1))
+        {
+            CpuFeatures::setLevel(level);
+            for (unsigned int layout = 0; layout < 2; layout++)
+            {
+                const bool isColumnMajor = (layout == 1);
+                std::vector<Uint32> pixels(width * height, 0);
+                numberOfPixels = 0;
+                auto startTimePoint = std::chrono::high_resolution_clock::now();
+                for (unsigned int frame = 0; frame < NUMBER_OF_FRAMES; frame++)
+                {
+                    for (int x = 0; x < width; x++)
+                    {
+                        const int firstY = Math::limitToInterval<double>(ceil(wallTops[x] - 0.5), 0, height);
+                        const int lastY = Math::limitToInterval<double>(ceil(wallTops[x] + wallHeights[x] - 0.5), 0, height);
+                        if (lastY <= firstY)
+                            continue;
+                        const double vScale = TEXTURE_SIZE * 65536.0 / wallHeights[x];
+                        const unsigned int v = (firstY + 0.5 - wallTops[x]) * vScale;
+                        const Uint32 *textureColumn = texture.data() + textureColumns[x] * TEXTURE_SIZE;
+                        Uint32 *destination = isColumnMajor ? pixels.data() + firstY + x * height : pixels.data() + x + firstY * width;
+                        FrameBuffer::fillColumnTextured(destination, isColumnMajor ? 1 : width, lastY - firstY, textureColumn, TEXTURE_SIZE - 1, v, vScale, shades[x]);
+                        numberOfPixels += lastY - firstY;
+                    }
+                }
+                auto endTimePoint = std::chrono::high_resolution_clock::now();
+                const double kernelTime = std::chrono::duration<double>(endTimePoint - startTimePoint).count();
+
+                // Every level must be bit exact with the scalar kernel, fixed point may only
+                // differ from the reference on texel boundaries
+                if (level == SimdLevel::scalar)
+                    scalarPixels[layout].swap(pixels);
+                else
+                    for (int i = 0; i < width * height; i++)
+                        if (pixels[i] != scalarPixels[layout][i])
+                            numberOfMismatches++;
+
+                std::cout << "    " << CpuFeatures::getLevelName(level) << (isColumnMajor ? " column-major: " : " row-major: ") << kernelTime * 1e3 / NUMBER_OF_FRAMES << " ms/frame, "
+                          << numberOfPixels / kernelTime * 1e-6 << " Mpixels/s" << std::endl;
+            }
+        }
+        CpuFeatures::setLevel(selectedLevel);
+        for (int i = 0; i < width * height; i++)
+            if (scalarPixels[0][i] != referencePixels[i])
+                numberOfTexelDifferences++;
+
+        std::cout << "    " << (int)(numberOfPixels / NUMBER_OF_FRAMES / 1000) << "k wall pixels/frame, " << numberOfMismatches << " mismatches with scalar, "
+                  << 100.0 * numberOfTexelDifferences / (width * height) << "% texels off by one from the reference" << std::endl;
+        isSuccess &= (numberOfMismatches == 0);
+    }
+
+    return isSuccess;
+}
+
+bool Benchmark::runTranspose()
+{
+    const unsigned int NUMBER_OF_FRAMES = 60;
+    const struct { unsigned int width; unsigned int height; } RESOLUTIONS[] = { { 2560, 1440 }, { 3840, 2160 } };
+
+    MapManager mapManager;
+    std::vector<PlayerState> poses = generatePoses(mapManager, NUMBER_OF_FRAMES);
+    Player player;
+
+    // Same frames drawn directly into the row-major frame, and into the column-major buffer
+    // then transposed: both frames must be identical
+    bool isSuccess = true;
+    for (const auto &resolution : RESOLUTIONS)
+    {
+        Raycaster raycaster;
+        raycaster.initialiseRaycaster(resolution.width);
+        FrameBuffer rowMajorFrameBuffer;
+        FrameBuffer columnMajorFrameBuffer;
+        rowMajorFrameBuffer.initialiseFrameBuffer(resolution.width, resolution.height);
+        columnMajorFrameBuffer.initialiseFrameBuffer(resolution.width, resolution.height, true);
+
+        double rowMajorTime = 0;
+        double columnMajorTime = 0;
+        double transposeTime = 0;
+        unsigned long long numberOfMismatches = 0;
+        for (unsigned int frame = 0; frame < NUMBER_OF_FRAMES; frame++)
+        {
+            player.setState(poses[frame]);
+            raycaster.calculateRays_OMP(player, mapManager);
+
+            auto startTimePoint = std::chrono::high_resolution_clock::now();
+            raycaster.renderRaycastFrameBuffer(rowMajorFrameBuffer, player.getVelocity(), 0.1 * frame);
+            auto rowMajorTimePoint = std::chrono::high_resolution_clock::now();
+            raycaster.renderRaycastFrameBuffer(columnMajorFrameBuffer, player.getVelocity(), 0.1 * frame);
+            auto columnMajorTimePoint = std::chrono::high_resolution_clock::now();
+            columnMajorFrameBuffer.transposeColumns();
+            auto transposeTimePoint = std::chrono::high_resolution_clock::now();
+            rowMajorTime += std::chrono::duration<double>(rowMajorTimePoint - startTimePoint).count();
+            columnMajorTime += std::chrono::duration<double>(columnMajorTimePoint - rowMajorTimePoint).count();
+            transposeTime += std::chrono::duration<double>(transposeTimePoint - columnMajorTimePoint).count();
+
+            for (unsigned int i = 0; i < resolution.width * resolution.height; i++)
+                if (rowMajorFrameBuffer.getPixels()[i] != columnMajorFrameBuffer.getPixels()[i])
+                    numberOfMismatches++;
+        }
+
+        std::cout << "transpose: " << resolution.width << "x" << resolution.height << ", " << omp_get_max_threads() << " threads: row-major columns " << rowMajorTime * 1e3 / NUMBER_OF_FRAMES << " ms/frame, column-major "
+                  << (columnMajorTime + transposeTime) * 1e3 / NUMBER_OF_FRAMES << " ms/frame (columns " << columnMajorTime * 1e3 / NUMBER_OF_FRAMES << ", transpose " << transposeTime * 1e3 / NUMBER_OF_FRAMES << ", x"
+                  << rowMajorTime / (columnMajorTime + transposeTime) << "), " << numberOfMismatches << " mismatches" << std::endl;
+        isSuccess &= (numberOfMismatches == 0);
+    }
+
+    return isSuccess;
+}
+
+bool Benchmark::runUpscale()
+{
+    const unsigned int NUMBER_OF_FRAMES = 30;
+    const struct { unsigned int width; unsigned int height; } RESOLUTIONS[] = { { 1920, 1080 }, { 3840, 2160 } };
+    const double SCALES[] = { 0.5, 0.75 };
+    const UpscaleFilter FILTERS[] = { UpscaleFilter::nearest, UpscaleFilter::bilinear };
+
+    // Software frames under a frame budget: the rays stretched over the screen columns, against
+    // one column per ray upscaled by each filter at every supported level (checked against scalar)
+    const SimdLevel selectedLevel = CpuFeatures::getLevel();
+    MapManager mapManager;
+    std::vector<PlayerState> poses = generatePoses(mapManager, NUMBER_OF_FRAMES);
+    Player player;
+    bool isSuccess = true;
+    for (const auto &resolution : RESOLUTIONS)
+    {
+        for (const double scale : SCALES)
+        {
+            const unsigned int numberOfRays = scale * resolution.width;
+            Raycaster raycaster;
+            raycaster.initialiseRaycaster(numberOfRays);
+            FrameBuffer stretchedFrameBuffer;
+            FrameBuffer scaledFrameBuffer;
+            stretchedFrameBuffer.initialiseFrameBuffer(resolution.width, resolution.height);
+            scaledFrameBuffer.initialiseFrameBuffer(resolution.width, resolution.height);
+            scaledFrameBuffer.setDrawWidth(numberOfRays);
+
+            double stretchedTime = 0;
+            double scaledTime = 0;
+            double upscaleTimes[2][4] = {};
+            std::vector<Uint32> scalarPixels(resolution.width * resolution.height);
+            unsigned long long numberOfMismatches = 0;
+            for (unsigned int frame = 0; frame < NUMBER_OF_FRAMES; frame++)
+            {
+                player.setState(poses[frame]);
+                raycaster.calculateRays_OMP(player, mapManager);
+
+                auto startTimePoint = std::chrono::high_resolution_clock::now();
+                raycaster.renderRaycastFrameBuffer(stretchedFrameBuffer, player.getVelocity(), 0.1 * frame);
+                auto stretchedTimePoint = std::chrono::high_resolution_clock::now();
+                raycaster.renderRaycastFrameBuffer(scaledFrameBuffer, player.getVelocity(), 0.1 * frame);
+                auto scaledTimePoint = std::chrono::high_resolution_clock::now();
+                stretchedTime += std::chrono::duration<double>(stretchedTimePoint - startTimePoint).count();
+                scaledTime += std::chrono::duration<double>(scaledTimePoint - stretchedTimePoint).count();
+
+                for (unsigned int filter = 0; filter < 2; filter++)
+                {
+                    scaledFrameBuffer.setUpscaleFilter(FILTERS[filter]);
+                    for (SimdLevel level = SimdLevel::scalar; level <= CpuFeatures::getSupportedLevel(); level = (SimdLevel)((int)level + 1))
+                    {
+                        CpuFeatures::setLevel(level);
+                        auto upscaleStartTimePoint = std::chrono::high_resolution_clock::now();
+                        scaledFrameBuffer.upscaleRows();
+                        upscaleTimes[filter][(int)level] += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - upscaleStartTimePoint).count();
+
+                        const Uint32 *pixels = scaledFrameBuffer.getPixels();
+                        if (level == SimdLevel::scalar)
+                            scalarPixels.assign(pixels, pixels + resolution.width * resolution.height);
+                        else
+                        {
+                            for (unsigned int i = 0; i < resolution.width * resolution.height; i++)
+                                if (pixels[i] != scalarPixels[i])
+                                    numberOfMismatches++;
+                        }
+                    }
+                }
+            }
+            CpuFeatures::setLevel(selectedLevel);
+
+            std::cout << "upscale: " << resolution.width << "x" << resolution.height << ", " << numberOfRays << " rays: stretched columns " << stretchedTime * 1e3 / NUMBER_OF_FRAMES << " ms/frame, drawn columns "
+                      << scaledTime * 1e3 / NUMBER_OF_FRAMES << " ms/frame + upscale (ms/frame)";
+            for (unsigned int filter = 0; filter < 2; filter++)
+            {
+                std::cout << ((filter == 0) ? " nearest" : ", bilinear");
+                for (SimdLevel level = SimdLevel::scalar; level <= CpuFeatures::getSupportedLevel(); level = (SimdLevel)((int)level + 1))
+                    std::cout << " " << CpuFeatures::getLevelName(level) << " " << upscaleTimes[filter][(int)level] * 1e3 / NUMBER_OF_FRAMES;
+            }
+            std::cout << ", " << numberOfMismatches << " mismatches with scalar" << std::endl;
+            isSuccess &= (numberOfMismatches == 0);
+        }
+    }
+
+    return isSuccess;
+}
+
+bool Benchmark::runGeometry()
+{
+    const unsigned int MAP_SIZE = 128;
+    const unsigned int NUMBER_OF_FRAMES = 100;
+    const struct { unsigned int width; unsigned int height; } RESOLUTIONS[] = { { 1280, 720 }, { 1920, 1080 } };
+
+    std::vector<char> roomsCells;
+    std::vector<char> pillarsCells;
+    generateTestMaps(MAP_SIZE, roomsCells, pillarsCells);
+    MapManager defaultMapManager;
+    MapManager roomsMapManager(MAP_SIZE, MAP_SIZE, roomsCells.data());
+    const std::pair<const char *, MapManager *> maps[] = { { "default", &defaultMapManager }, { "rooms", &roomsMapManager } };
+
+    // Offscreen software renderer: no window needed, every draw call is actually rasterised
+    bool isSuccess = true;
+    for (const auto &resolution : RESOLUTIONS)
+    {
+        SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, resolution.width, resolution.height, 32, SDL_PIXELFORMAT_ARGB8888);
+        SDL_Renderer *renderer = (surface != nullptr) ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+        if (renderer == nullptr)
+        {
+            std::cerr << "geometry: no software renderer (" << SDL_GetError() << ")" << std::endl;
+            SDL_FreeSurface(surface);
+            return false;
+        }
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+        for (const auto &map : maps)
+        {
+            MapManager &mapManager = *map.second;
+            std::vector<PlayerState> poses = generatePoses(mapManager, NUMBER_OF_FRAMES);
+            Player player;
+            Raycaster raycaster;
+            raycaster.initialiseRaycaster(resolution.width);
+            GeometryBatch batch;
+
+            double drawCallsTime = 0;
+            double geometryTime = 0;
+            unsigned long long numberOfDrawCalls = 0;
+            unsigned long long numberOfGeometryCalls = 0;
+            for (unsigned int frame = 0; frame < NUMBER_OF_FRAMES; frame++)
+            {
+                player.setState(poses[frame]);
+                raycaster.calculateRays_OMP(player, mapManager);
+
+                auto startTimePoint = std::chrono::high_resolution_clock::now();
+                SDL_SetRenderDrawColor(renderer, 70, 70, 70, 255);
+                SDL_RenderClear(renderer);
+                raycaster.SDL_renderRaycastBackground(renderer, player.getVelocity(), 0.1 * frame, resolution.width, resolution.height);
+                raycaster.SDL_renderRaycast(renderer, player.getVelocity(), 0.1 * frame, resolution.width, resolution.height);
+                SDL_RenderPresent(renderer);
+                auto drawCallsTimePoint = std::chrono::high_resolution_clock::now();
+                numberOfDrawCalls += raycaster.getNumberOfDrawCalls();
+
+                SDL_SetRenderDrawColor(renderer, 70, 70, 70, 255);
+                SDL_RenderClear(renderer);
+                isSuccess &= raycaster.SDL_renderRaycastGeometry(renderer, batch, player.getVelocity(), 0.1 * frame, resolution.width, resolution.height);
+                SDL_RenderPresent(renderer);
+                auto geometryTimePoint = std::chrono::high_resolution_clock::now();
+                numberOfGeometryCalls += raycaster.getNumberOfDrawCalls();
+
+                drawCallsTime += std::chrono::duration<double>(drawCallsTimePoint - startTimePoint).count();
+                geometryTime += std::chrono::duration<double>(geometryTimePoint - drawCallsTimePoint).count();
+            }
+
+            std::cout << "geometry: " << resolution.width << "x" << resolution.height << ", " << map.first << " map: rectangles & lines " << drawCallsTime * 1e3 / NUMBER_OF_FRAMES << " ms/frame, "
+                      << numberOfDrawCalls / NUMBER_OF_FRAMES << " draw calls/frame, geometry " << geometryTime * 1e3 / NUMBER_OF_FRAMES << " ms/frame (x" << drawCallsTime / geometryTime << "), "
+                      << (double)numberOfGeometryCalls / NUMBER_OF_FRAMES << " draw calls/frame, " << batch.getNumberOfQuads() << " quads" << std::endl;
+        }
+
+        SDL_DestroyRenderer(renderer);
+        SDL_FreeSurface(surface);
+    }
+
+    return isSuccess;
+}
+
+bool Benchmark::runSimd()
+{
+    const unsigned int NUMBER_OF_BEAMS = 361;
+    const double MAX_RANGE = 30;
+    const unsigned int NUMBER_OF_SCANS = 20000;
+    const unsigned int SCREEN_WIDTH = 3840;
+    const unsigned int SCREEN_HEIGHT = 2160;
+    const unsigned int NUMBER_OF_TRANSPOSES = 20;
+
+    // Every supported level against the scalar one (span fill: "columns" benchmark). The beam
+    // count is not a multiple of the packet sizes, so that the tails are checked too
+    const SimdLevel selectedLevel = CpuFeatures::getLevel();
+    MapManager mapManager;
+    std::vector<PlayerState> poses = generatePoses(mapManager, 256);
+    LidarScanner lidarScanner(NUMBER_OF_BEAMS, MAX_RANGE);
+    std::vector<float> scalarDistances(NUMBER_OF_SCANS * NUMBER_OF_BEAMS);
+    std::vector<float> distances(NUMBER_OF_SCANS * NUMBER_OF_BEAMS);
+
+    std::default_random_engine generator(m_seed);
+    std::uniform_int_distribution<Uint32> distributionPixel;
+    FrameBuffer frameBuffer;
+    frameBuffer.initialiseFrameBuffer(SCREEN_WIDTH, SCREEN_HEIGHT, true);
+    for (unsigned int x = 0; x < SCREEN_WIDTH; x++)
+        for (unsigned int y = 0; y < SCREEN_HEIGHT; y++)
+            frameBuffer.getColumn(x)[y] = distributionPixel(generator);
+    std::vector<Uint32> scalarPixels;
+
+    bool isSuccess = true;
+    for (SimdLevel level = SimdLevel::scalar; level <= CpuFeatures::getSupportedLevel(); level = (SimdLevel)((int)level + 1))
+    {
+        CpuFeatures::setLevel(level);
+
+        // Lidar traversal, single thread
+        auto startTimePoint = std::chrono::high_resolution_clock::now();
+        for (unsigned int i = 0; i < NUMBER_OF_SCANS; i++)
+        {
+            const PlayerState &pose = poses[i % poses.size()];
+            lidarScanner.scan(mapManager, pose.x, pose.y, pose.angle + i * 1e-3, distances.data() + i * NUMBER_OF_BEAMS);
+        }
+        auto lidarTimePoint = std::chrono::high_resolution_clock::now();
+
+        // Transpose, bands in parallel
+        for (unsigned int i = 0; i < NUMBER_OF_TRANSPOSES; i++)
+            frameBuffer.transposeColumns();
+        auto transposeTimePoint = std::chrono::high_resolution_clock::now();
+
+        unsigned long long numberOfMismatches = 0;
+        if (level == SimdLevel::scalar)
+        {
+            scalarDistances = distances;
+            scalarPixels.assign(frameBuffer.getPixels(), frameBuffer.getPixels() + SCREEN_WIDTH * SCREEN_HEIGHT);
+        }
+        else
+        {
+            for (unsigned int i = 0; i < NUMBER_OF_SCANS * NUMBER_OF_BEAMS; i++)
+                if (distances[i] != scalarDistances[i])
+                    numberOfMismatches++;
+            for (unsigned int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++)
+                if (frameBuffer.getPixels()[i] != scalarPixels[i])
+                    numberOfMismatches++;
+        }
+
+        const double lidarTime = std::chrono::duration<double>(lidarTimePoint - startTimePoint).count();
+        const double transposeTime = std::chrono::duration<double>(transposeTimePoint - lidarTimePoint).count();
+        std::cout << "simd: " << CpuFeatures::getLevelName(level) << ": lidar (" << NUMBER_OF_BEAMS << " beams) " << (unsigned long long)(NUMBER_OF_SCANS / lidarTime) << " scans/s/core, transpose "
+                  << SCREEN_WIDTH << "x" << SCREEN_HEIGHT << " " << transposeTime * 1e3 / NUMBER_OF_TRANSPOSES << " ms, " << numberOfMismatches << " mismatches with scalar" << std::endl;
+        isSuccess &= (numberOfMismatches == 0);
+    }
+    CpuFeatures::setLevel(selectedLevel);
+
+    return isSuccess;
+}
+
+bool Benchmark::runSprites()
+{
+    const unsigned int SCREEN_WIDTH = 1280;
+    const unsigned int SCREEN_HEIGHT = 720;
+    const unsigned int FOV = 90;
+    const double SPRITE_SIZE = 0.4;
+    const unsigned int NUMBER_OF_FRAMES = 500;
+
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer *renderer = (surface != nullptr) ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (renderer == nullptr)
+    {
+        std::cerr << "sprites: no software renderer (" << SDL_GetError() << ")" << std::endl;
+        SDL_FreeSurface(surface);
+        return false;
+    }
+
+    MapManager mapManager;
+    VisibilitySet visibilitySet;
+    visibilitySet.compute(mapManager);
+    std::vector<PlayerState> poses = generatePoses(mapManager, NUMBER_OF_FRAMES);
+    Player player;
+    Raycaster raycaster;
+    raycaster.initialiseRaycaster(SCREEN_WIDTH);
+    FrameArena arena;
+    arena.initialiseArena(1 << 20);
+    bool isSuccess = true;
+
+    // The per frame cost follows the candidates (sprites of the visible cells), a full scan
+    // checks that none of the visible sprites is missed
+    for (unsigned int numberOfSprites : { 1000, 100000 })
+    {
+        std::default_random_engine generator(m_seed);
+        std::vector<double> spritesX(numberOfSprites);
+        std::vector<double> spritesY(numberOfSprites);
+        SpriteManager spriteManager;
+        spriteManager.initialiseSprites(mapManager);
+        for (unsigned int i = 0; i < numberOfSprites; i++)
+        {
+            unsigned int x, y;
+            mapManager.getRandomFreeCell(generator, x, y);
+            spritesX[i] = x + 0.5;
+            spritesY[i] = y + 0.5;
+            spriteManager.addSprite(spritesX[i], spritesY[i], SPRITE_SIZE, SDL_Color { 255, 255, 255, 255 });
+        }
+
+        for (const bool isVisibilitySetUsed : { false, true })
+        {
+            spriteManager.setVisibilitySet(isVisibilitySetUsed ? &visibilitySet : nullptr);
+            unsigned long long numberOfCandidates = 0;
+            unsigned long long numberOfVisible = 0;
+            unsigned int numberOfMismatches = 0;
+            double time = 0;
+            for (const PlayerState &pose : poses)
+            {
+                player.setState(pose);
+                raycaster.calculateRays_OMP(player, mapManager);
+                visibilitySet.setViewerCell(player.getX(), player.getY());
+
+                auto startTimePoint = std::chrono::high_resolution_clock::now();
+                spriteManager.SDL_renderSprites(renderer, arena, player, raycaster, FOV, SCREEN_WIDTH, SCREEN_HEIGHT);
+                time += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+                arena.reset();
+                numberOfCandidates += spriteManager.getNumberOfCandidateSprites();
+                numberOfVisible += spriteManager.getNumberOfVisibleSprites();
+
+                // Full scan, same culling as SpriteManager::cullSprites
+                const double cosAngle = cos(player.getAngle());
+                const double sinAngle = sin(player.getAngle());
+                const double tanHalfFov = tan(0.5 * FOV * Math::DEGREE_TO_RADIAN);
+                unsigned int numberOfExpected = 0;
+                for (unsigned int i = 0; i < numberOfSprites; i++)
+                {
+                    const double dx = spritesX[i] - player.getX();
+                    const double dy = spritesY[i] - player.getY();
+                    const double depth = dx * cosAngle - dy * sinAngle;
+                    const double lateralOffset = -dx * sinAngle - dy * cosAngle;
+                    if (isVisibilitySetUsed && !visibilitySet.isVisibleFromViewer(spritesX[i], spritesY[i]))
+                        continue;
+                    if (depth >= 0.1 && depth < 128 && std::fabs(lateralOffset) - 0.5 * SPRITE_SIZE <= depth * tanHalfFov)
+                        numberOfExpected++;
+                }
+                numberOfMismatches += (numberOfExpected != spriteManager.getNumberOfVisibleSprites());
+            }
+            isSuccess &= numberOfMismatches == 0;
+
+            std::cout << "sprites: " << numberOfSprites << " sprites, " << (isVisibilitySetUsed ? "PVS" : "frustum box") << ": " << time / NUMBER_OF_FRAMES * 1e6 << " us/frame, "
+                      << numberOfCandidates / NUMBER_OF_FRAMES << " candidates, " << numberOfVisible / NUMBER_OF_FRAMES << " visible per frame, " << numberOfMismatches << " mismatches with a full scan" << std::endl;
+        }
+    }
+
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+
+    return isSuccess;
+}
+
+bool Benchmark::runAllocations()
+{
+    const unsigned int MAP_SIZE = 128;
+    const unsigned int SCREEN_WIDTH = 1280;
+    const unsigned int SCREEN_HEIGHT = 720;
+    const unsigned int NUMBER_OF_SPRITES = 64;
+    const unsigned int WARM_UP_FRAMES = 20;
+    const unsigned int NUMBER_OF_FRAMES = 200;
+    const char *RECORDINGS[] = { "walkthrough.rcrp" };
+
+    if (!AllocationCounter::isEnabled())
+    {
+        std::cout << "allocations: counter not compiled in (make benchmark)" << std::endl;
+        return true;
+    }
+
+    std::vector<char> roomsCells;
+    std::vector<char> pillarsCells;
+    generateTestMaps(MAP_SIZE, roomsCells, pillarsCells);
+    MapManager defaultMapManager;
+    MapManager roomsMapManager(MAP_SIZE, MAP_SIZE, roomsCells.data());
+    const std::pair<const char *, MapManager *> maps[] = { { "default", &defaultMapManager }, { "rooms", &roomsMapManager } };
+
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer *renderer = (surface != nullptr) ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (renderer == nullptr)
+    {
+        std::cerr << "allocations: no software renderer (" << SDL_GetError() << ")" << std::endl;
+        SDL_FreeSurface(surface);
+        return false;
+    }
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+    // Every frame path of the render loop, after the warm-up nothing may be allocated
+    bool isSuccess = true;
+    for (const auto &map : maps)
+    {
+        MapManager &mapManager = *map.second;
+        std::vector<PlayerState> poses = generatePoses(mapManager, WARM_UP_FRAMES + NUMBER_OF_FRAMES);
+        Player player;
+        Raycaster raycaster;
+        raycaster.initialiseRaycaster(SCREEN_WIDTH);
+        FrameBuffer frameBuffer;
+        frameBuffer.initialiseFrameBuffer(SCREEN_WIDTH, SCREEN_HEIGHT, true);
+        GeometryBatch batch;
+        SpriteManager spriteManager;
+        spriteManager.initialiseSprites(mapManager);
+        spriteManager.addRandomSprites(mapManager, NUMBER_OF_SPRITES, m_seed);
+        // Small on purpose: grown by the warm-up frames
+        FrameArena arena;
+        arena.initialiseArena(1024);
+
+        unsigned int numberOfOverflowsAtWarmUp = 0;
+        for (unsigned int frame = 0; frame < WARM_UP_FRAMES + NUMBER_OF_FRAMES; frame++)
+        {
+            if (frame == WARM_UP_FRAMES)
+            {
+                AllocationCounter::reset();
+                numberOfOverflowsAtWarmUp = arena.getNumberOfOverflows();
+            }
+            player.setState(poses[frame]);
+            {
+                AllocationScope scope(AllocationSubsystem::casting);
+                raycaster.calculateRays_OMP(player, mapManager);
+            }
+            {
+                AllocationScope scope(AllocationSubsystem::rendering);
+                raycaster.renderRaycastFrameBuffer(frameBuffer, player.getVelocity(), 0.1 * frame);
+                frameBuffer.SDL_renderFrameBuffer(renderer);
+                raycaster.SDL_renderRaycastGeometry(renderer, batch, player.getVelocity(), 0.1 * frame, SCREEN_WIDTH, SCREEN_HEIGHT);
+                raycaster.SDL_renderRaycastBackground(renderer, player.getVelocity(), 0.1 * frame, SCREEN_WIDTH, SCREEN_HEIGHT);
+                raycaster.SDL_renderRaycast(renderer, player.getVelocity(), 0.1 * frame, SCREEN_WIDTH, SCREEN_HEIGHT);
+            }
+            {
+                AllocationScope scope(AllocationSubsystem::sprites);
+                spriteManager.SDL_renderSprites(renderer, arena, player, raycaster, 90, SCREEN_WIDTH, SCREEN_HEIGHT);
+            }
+            SDL_RenderPresent(renderer);
+            arena.reset();
+        }
+
+        // The arena's overflows come from malloc, which the counter does not see
+        const unsigned long long numberOfAllocations = AllocationCounter::getNumberOfAllocations();
+        const unsigned int numberOfOverflows = arena.getNumberOfOverflows() - numberOfOverflowsAtWarmUp;
+        std::cout << "allocations: " << map.first << " map, " << NUMBER_OF_FRAMES << " frames after " << WARM_UP_FRAMES << " warm-up frames: " << numberOfAllocations << " allocations";
+        for (int i = 0; i < (int)AllocationSubsystem::count; i++)
+            if (AllocationCounter::getNumberOfAllocations((AllocationSubsystem)i) != 0)
+                std::cout << ", " << AllocationCounter::getSubsystemName((AllocationSubsystem)i) << " " << AllocationCounter::getNumberOfAllocations((AllocationSubsystem)i);
+        std::cout << " (frame arena " << arena.getCapacity() << " bytes, peak " << arena.getPeak() << ", " << numberOfOverflows << " overflows)" << std::endl;
+        isSuccess &= (numberOfAllocations == 0 && numberOfOverflows == 0);
+    }
+
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+
+    // The real frame loop: Capp replaying a recording, drawn offscreen (input, simulation,
+    // casting, walls, sprites, minimap & text), counted from its own warm-up
+    for (const char *recording : RECORDINGS)
+    {
+        std::string recordingPath;
+        for (const std::string &path : { std::string("imports/recordings/") + recording, std::string("../imports/recordings/") + recording })
+            if (std::ifstream(path).is_open())
+                recordingPath = path;
+        if (recordingPath.empty())
+        {
+            std::cout << "allocations: " << recording << ": unavailable" << std::endl;
+            continue;
+        }
+
+        for (const bool isFrameBufferEnabled : { false, true })
+        {
+            Capp app;
+            app.setReplayFile(recordingPath);
+            app.setHeadless(true);
+            app.setOffscreen(true);
+            app.setFrameBufferRendering(isFrameBufferEnabled);
+            if (!app.run() || app.getNumberOfFrames() <= Capp::ALLOCATION_WARM_UP_FRAMES)
+            {
+                std::cerr << "allocations: cannot replay " << recordingPath << std::endl;
+                isSuccess = false;
+                continue;
+            }
+
+            std::cout << "allocations: " << recording << " replayed by Capp (" << (isFrameBufferEnabled ? "software walls" : "renderer walls") << "), " << app.getNumberOfFrames() - Capp::ALLOCATION_WARM_UP_FRAMES << " frames after "
+                      << Capp::ALLOCATION_WARM_UP_FRAMES << " warm-up frames: " << app.getNumberOfAllocationsAfterWarmUp() << " allocations, " << app.getNumberOfArenaOverflowsAfterWarmUp() << " frame arena overflows" << std::endl;
+            isSuccess &= (app.getNumberOfAllocationsAfterWarmUp() == 0 && app.getNumberOfArenaOverflowsAfterWarmUp() == 0);
+        }
+    }
+
+    return isSuccess;
+}
+
+bool Benchmark::runStartup()
+{
+    const unsigned int NUMBER_OF_LOADS = 20;
+
+    // Startup steps after the window & renderer: from the imported files (as Capp looks for
+    // them) and from the tables baked in with RAYCASTING_BAKED_ASSETS ("make bake")
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, 64, 64, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer *renderer = (surface != nullptr) ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (renderer == nullptr)
+    {
+        std::cerr << "startup: no software renderer (" << SDL_GetError() << ")" << std::endl;
+        SDL_FreeSurface(surface);
+        return false;
+    }
+    auto findImport = [](const std::string &name) -> std::string
+    {
+        for (const std::string &path : { "imports/" + name, "../imports/" + name })
+            if (std::ifstream(path).is_open())
+                return path;
+        return "";
+    };
+    const std::string texturePath = findImport("texture/circle.bmp");
+    const std::string fontPath = findImport("fonts/retro_computer_personal_use.ttf");
+    const std::string visibilitySetPath = findImport("default.pvs");
+
+    // First load (nothing cached in the process yet), then the average of the next ones
+    auto measure = [NUMBER_OF_LOADS](const char *step, const char *source, auto load)
+    {
+        auto startTimePoint = std::chrono::high_resolution_clock::now();
+        if (!load())
+        {
+            std::cout << "startup: " << step << " (" << source << "): unavailable" << std::endl;
+            return;
+        }
+        auto firstTimePoint = std::chrono::high_resolution_clock::now();
+        for (unsigned int i = 1; i < NUMBER_OF_LOADS; i++)
+            load();
+        auto endTimePoint = std::chrono::high_resolution_clock::now();
+
+        std::cout << "startup: " << step << " (" << source << "): first " << std::chrono::duration<double, std::milli>(firstTimePoint - startTimePoint).count() << " ms, then "
+                  << std::chrono::duration<double, std::milli>(endTimePoint - firstTimePoint).count() / (NUMBER_OF_LOADS - 1) << " ms" << std::endl;
+    };
+
+    MapManager mapManager;
+    measure("default map", "literal", []() { MapManager defaultMapManager; return defaultMapManager.getNumberOfFreeCells() != 0; });
+    measure("wall texture", "generated", []()
+    {
+        std::vector<SDL_Color> texture;
+        Raycaster::generateTexture(texture, 32);
+        std::vector<Uint32> textureColumns(32 * 32);
+        for (unsigned int u = 0; u < 32; u++)
+            for (unsigned int v = 0; v < 32; v++)
+                textureColumns[v + u * 32] = FrameBuffer::packColor(texture[u + v * 32].r, texture[u + v * 32].g, texture[u + v * 32].b);
+        return textureColumns[1] != 0;
+    });
+    measure("wall texture", "constexpr", []() { Raycaster raycaster; return true; });
+
+    VisibilitySet visibilitySet;
+    measure("PVS", "file", [&]() { return visibilitySet.load(visibilitySetPath, mapManager); });
+    SpriteManager spriteManager;
+    measure("sprite texture", "BMP", [&]() { return spriteManager.loadTexture(renderer, texturePath.c_str()); });
+    GlyphAtlas glyphAtlas;
+    const bool isTtfInitialised = (TTF_Init() == 0);
+    measure("font atlas", "TTF", [&]()
+    {
+        TTF_Font *font = isTtfInitialised ? TTF_OpenFont(fontPath.c_str(), 64) : nullptr;
+        const bool isLoaded = glyphAtlas.SDL_loadFont(renderer, font, SDL_Color { 255, 255, 255, 255 });
+        if (font != nullptr)
+            TTF_CloseFont(font);
+        return isLoaded;
+    });
+    if (isTtfInitialised)
+        TTF_Quit();
+
+#if defined(RAYCASTING_BAKED_ASSETS)
+    measure("PVS", "baked", [&]() { return visibilitySet.load(BakedAssets::DEFAULT_PVS, sizeof(BakedAssets::DEFAULT_PVS), mapManager); });
+    measure("sprite texture", "baked", [&]() { return spriteManager.loadTexture(renderer, BakedAssets::SPRITE_TEXTURE, BakedAssets::SPRITE_TEXTURE_SIZE); });
+    measure("font atlas", "baked", [&]() { return glyphAtlas.SDL_loadAtlas(renderer, BakedAssets::FONT_ATLAS, BakedAssets::FONT_ATLAS_WIDTH, BakedAssets::FONT_ATLAS_HEIGHT, BakedAssets::FONT_GLYPHS, BakedAssets::FONT_GLYPH_HEIGHT); });
+#else
+    std::cout << "startup: baked assets not compiled in (make bake)" << std::endl;
+#endif
+
+    spriteManager.SDL_releaseTextures();
+    glyphAtlas.SDL_releaseTextures();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+
+    return true;
+}
+
+bool Benchmark::runOpenMaps()
+{
+    const unsigned int NUMBER_OF_MAPS = 200;
+    const unsigned int POSES_PER_MAP = 16;
+    const unsigned int NUMBER_OF_RAYS = 320;
+    const unsigned int NUMBER_OF_BEAMS = 181;
+    const double MAX_RANGE = 200;
+    const double COLLISION_HALF_SIZE = 0.45;
+
+    // Random maps without border walls (walls of every material, see-through & low ones
+    // included), cast from random poses of their free cells with every kernel: the sentinel ring
+    // must end all the traversals, hits stay on the map (or its boundary), entities in it
+    std::default_random_engine generator(m_seed);
+    std::uniform_int_distribution<unsigned int> distributionSize(1, 48);
+    std::uniform_real_distribution<double> distributionUnit(0, 1);
+    std::uniform_int_distribution<int> distributionElement(1, 10);
+    std::uniform_real_distribution<double> distributionAngle(0, 360 * Math::DEGREE_TO_RADIAN);
+    std::uniform_real_distribution<double> distributionStep(-6, 6);
+    const SimdLevel selectedLevel = CpuFeatures::getLevel();
+    Raycaster raycaster;
+    raycaster.initialiseRaycaster(NUMBER_OF_RAYS);
+    LidarScanner lidarScanner(NUMBER_OF_BEAMS, MAX_RANGE);
+    std::vector<float> scalarDistances(NUMBER_OF_BEAMS);
+    std::vector<float> distances(NUMBER_OF_BEAMS);
+    BatchRenderer batchRenderer(64, 48, POSES_PER_MAP);
+    Player player;
+
+    unsigned long long numberOfRays = 0;
+    unsigned long long numberOfFailures = 0;
+    auto startTimePoint = std::chrono::high_resolution_clock::now();
+    for (unsigned int map = 0; map < NUMBER_OF_MAPS; map++)
+    {
+        const unsigned int width = distributionSize(generator);
+        const unsigned int height = distributionSize(generator);
+        const double density = 0.4 * distributionUnit(generator);
+        std::vector<char> cells(width * height, 0);
+        for (char &cell : cells)
+            if (distributionUnit(generator) < density)
+                cell = distributionElement(generator);
+        cells[0] = 0;
+        MapManager mapManager(width, height, cells.data());
+
+        // Poses anywhere in the free cells, edges & corners of the map included
+        std::vector<PlayerState> poses(POSES_PER_MAP);
+        for (PlayerState &pose : poses)
+        {
+            unsigned int x, y;
+            mapManager.getRandomFreeCell(generator, MapManager::NO_COMPONENT, x, y);
+            pose = PlayerState { x + distributionUnit(generator), y + distributionUnit(generator), distributionAngle(generator), 0 };
+        }
+
+        auto isOnMap = [&mapManager](double x, double y) { return std::isinf(x) || (x >= -1e-6 && y >= -1e-6 && x <= mapManager.getWidth() + 1e-6 && y <= mapManager.getHeight() + 1e-6); };
+        for (const PlayerState &pose : poses)
+        {
+            player.setState(pose);
+            for (unsigned int kernel = 0; kernel < 6; kernel++)
+            {
+                if (kernel == 0)
+                    raycaster.calculateRaysDistance(player, mapManager);
+                else if (kernel == 1)
+                    raycaster.calculateRaysDistance_fishEyeAndRayDistributionCorrected(player, mapManager);
+                else if (kernel == 2)
+                    raycaster.calculateRaysDistance_OMP(player, mapManager);
+                else if (kernel == 3)
+                    raycaster.calculateRaysSpans_OMP(player, mapManager);
+                else if (kernel == 4)
+                    raycaster.calculateRaysAdaptive_OMP(player, mapManager, 90, 8);
+                else
+                    raycaster.calculateRaysTemporal_OMP(player, mapManager);
+
+                for (unsigned int i = 0; i < NUMBER_OF_RAYS; i++)
+                    if (std::isnan(raycaster.getRaysDistance()[i]) || !isOnMap(raycaster.getRaysX()[i], raycaster.getRaysY()[i]))
+                        numberOfFailures++;
+                numberOfRays += NUMBER_OF_RAYS;
+            }
+
+            // Lidar: every supported level against the scalar one, beams leaving the map have no return
+            for (SimdLevel level = SimdLevel::scalar; level <= CpuFeatures::getSupportedLevel(); level = (SimdLevel)((int)level + 1))
+            {
+                CpuFeatures::setLevel(level);
+                lidarScanner.scan(mapManager, pose.x, pose.y, pose.angle, distances.data());
+                if (level == SimdLevel::scalar)
+                    scalarDistances = distances;
+                for (unsigned int i = 0; i < NUMBER_OF_BEAMS; i++)
+                    if (std::isnan(distances[i]) || distances[i] < 0 || distances[i] > MAX_RANGE || distances[i] != scalarDistances[i])
+                        numberOfFailures++;
+                numberOfRays += NUMBER_OF_BEAMS;
+            }
+
+            // Collision: large steps towards the open edges, the box (inside its cell) must stay in the map
+            const double margin = COLLISION_HALF_SIZE + 1e-3;
+            double x = Math::limitToInterval<double>(pose.x, (int)pose.x + margin, (int)pose.x + 1 - margin);
+            double y = Math::limitToInterval<double>(pose.y, (int)pose.y + margin, (int)pose.y + 1 - margin);
+            for (unsigned int step = 0; step < 8; step++)
+            {
+                bool isXblocked, isYblocked;
+                EntityManager::moveAndCollide(mapManager, x, y, COLLISION_HALF_SIZE, distributionStep(generator), distributionStep(generator), isXblocked, isYblocked);
+                if (x - COLLISION_HALF_SIZE < 0 || y - COLLISION_HALF_SIZE < 0 || x + COLLISION_HALF_SIZE > width || y + COLLISION_HALF_SIZE > height)
+                    numberOfFailures++;
+            }
+        }
+        CpuFeatures::setLevel(selectedLevel);
+
+        batchRenderer.render(mapManager, poses.data(), POSES_PER_MAP);
+        numberOfRays += 64 * POSES_PER_MAP;
+    }
+    double elapsedTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+
+    std::cout << "openmaps: " << NUMBER_OF_MAPS << " random maps without borders, " << NUMBER_OF_MAPS * POSES_PER_MAP << " poses, " << numberOfRays << " rays & beams in " << elapsedTime * 1e3 << " ms, "
+              << numberOfFailures << " failures" << std::endl;
+
+    return numberOfFailures == 0;
+}
+
+bool Benchmark::runCapture()
+{
+    const unsigned int SCREEN_WIDTH = 1280;
+    const unsigned int SCREEN_HEIGHT = 720;
+    const unsigned int NUMBER_OF_FRAMES = 120;
+    // File & frame rate (0: unpaced)
+    const std::pair<const char *, unsigned int> RUNS[] = { { "capture_benchmark.ppm", 0 }, { "capture_benchmark.ppm", 60 }, { "capture_benchmark.y4m", 0 }, { "capture_benchmark.y4m", 60 } };
+
+    // Frames offered as fast as possible, then at 60 fps (the render loop's side: copy & queue),
+    // the writer keeps up or drops. The file must hold exactly the written frames
+    std::default_random_engine generator(m_seed);
+    std::uniform_int_distribution<Uint32> distributionPixel;
+    std::vector<Uint32> frame(SCREEN_WIDTH * SCREEN_HEIGHT);
+    for (Uint32 &pixel : frame)
+        pixel = distributionPixel(generator);
+
+    bool isSuccess = true;
+    for (const auto &run : RUNS)
+    {
+        const char *path = run.first;
+        const unsigned int frameRate = run.second;
+        FrameCapture frameCapture;
+        if (!frameCapture.start(path, FrameCapture::getFormatFromPath(path), SCREEN_WIDTH, SCREEN_HEIGHT))
+        {
+            std::cerr << "capture: can not open " << path << std::endl;
+            return false;
+        }
+
+        double submitTime = 0;
+        double submitTimeMax = 0;
+        auto startTimePoint = std::chrono::high_resolution_clock::now();
+        for (unsigned int i = 0; i < NUMBER_OF_FRAMES; i++)
+        {
+            auto submitTimePoint = std::chrono::high_resolution_clock::now();
+            Uint32 *pixels = frameCapture.acquireFrame();
+            if (pixels != nullptr)
+            {
+                std::copy(frame.begin(), frame.end(), pixels);
+                pixels[0] = i;
+                frameCapture.submitFrame();
+            }
+            const double frameSubmitTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - submitTimePoint).count();
+            submitTime += frameSubmitTime;
+            submitTimeMax = std::max(submitTimeMax, frameSubmitTime);
+            if (frameRate != 0)
+                std::this_thread::sleep_until(startTimePoint + std::chrono::microseconds((i + 1) * 1000000ull / frameRate));
+        }
+        frameCapture.stop();
+        const double elapsedTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTimePoint).count();
+
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        const unsigned long long fileSize = file.is_open() ? (unsigned long long)file.tellg() : 0;
+        file.close();
+        std::remove(path);
+
+        const bool isConsistent = (frameCapture.getNumberOfWrittenFrames() + frameCapture.getNumberOfDroppedFrames() == NUMBER_OF_FRAMES) && fileSize == frameCapture.getNumberOfWrittenBytes();
+        std::cout << "capture: " << path << ", " << SCREEN_WIDTH << "x" << SCREEN_HEIGHT << ", " << ((frameRate != 0) ? std::to_string(frameRate) + " fps" : std::string("unpaced")) << ": render side " << submitTime * 1e6 / NUMBER_OF_FRAMES << " us/frame (max " << submitTimeMax * 1e6 << " us), "
+                  << frameCapture.getNumberOfWrittenFrames() << " written (" << fileSize / (1024.0 * 1024) / elapsedTime << " MB/s), " << frameCapture.getNumberOfDroppedFrames() << " dropped"
+                  << (isConsistent ? "" : ", inconsistent file") << std::endl;
+        isSuccess &= isConsistent;
+    }
+
+    return isSuccess;
+}
+
+bool Benchmark::runPacing()
+{
+    const unsigned int NUMBER_OF_RAYS = 1920;
+    const unsigned int NUMBER_OF_FRAMES = 240;
+    const double REFRESH_RATE = 120;
+
+    // Simulated vsync: a present is shown at the next refresh. Unpaced, the input is sampled
+    // as soon as the previous present returns; paced, the frame starts as late as it can
+    // (the pacer anchored to the presents), the latency is what is left of the refresh interval.
+    // Pacing must not cost refreshes: it fails if it misses more than the unpaced run
+    MapManager mapManager;
+    Raycaster raycaster;
+    raycaster.initialiseRaycaster(NUMBER_OF_RAYS);
+    std::vector<PlayerState> poses = generatePoses(mapManager, NUMBER_OF_FRAMES);
+    Player player;
+    const std::chrono::microseconds refreshPeriod((long long)(1e6 / REFRESH_RATE));
+
+    unsigned int numberOfUnpacedMissedRefreshes = 0;
+    bool isSuccess = true;
+    for (const bool isPaced : { false, true })
+    {
+        FramePacer framePacer;
+        if (isPaced)
+        {
+            framePacer.setTargetRate(REFRESH_RATE);
+            framePacer.setAnchoredToPresent(true);
+        }
+
+        double latencyTotal = 0;
+        double latencyMax = 0;
+        unsigned long long previousRefresh = 0;
+        unsigned int numberOfMissedRefreshes = 0;
+        const auto startTimePoint = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < NUMBER_OF_FRAMES; i++)
+        {
+            framePacer.waitForFrame();
+            const auto sampleTimePoint = std::chrono::steady_clock::now();
+            player.setState(poses[i]);
+            raycaster.calculateRaysDistance_OMP(player, mapManager);
+            framePacer.markPresent();
+
+            // Present: blocks until the next refresh, one was skipped if it is not the one after the last
+            const unsigned long long refresh = (std::chrono::steady_clock::now() - startTimePoint) / refreshPeriod + 1;
+            const auto presentTimePoint = startTimePoint + refresh * refreshPeriod;
+            std::this_thread::sleep_until(presentTimePoint);
+            numberOfMissedRefreshes += (i != 0 && refresh > previousRefresh + 1) ? 1 : 0;
+            previousRefresh = refresh;
+            framePacer.endFrame();
+
+            const double latency = std::chrono::duration<double, std::milli>(presentTimePoint - sampleTimePoint).count();
+            latencyTotal += latency;
+            latencyMax = std::max(latencyMax, latency);
+        }
+
+        std::cout << "pacing: " << REFRESH_RATE << " Hz vsync, " << NUMBER_OF_RAYS << " rays, " << (isPaced ? "paced" : "unpaced") << ": input sample to refresh latency avg " << latencyTotal / NUMBER_OF_FRAMES << " ms, max " << latencyMax << " ms, "
+                  << numberOfMissedRefreshes << " missed refreshes";
+        if (isPaced)
+            std::cout << " (" << framePacer.getNumberOfMissedRefreshes() << " seen by the pacer), spin avg " << framePacer.getAverageSpinTime() << " ms/frame (margin " << framePacer.getSpinMargin() << " ms), predicted work "
+                      << framePacer.getPredictedWork() << " ms, safety margin " << framePacer.getSafetyMargin() << " ms";
+        std::cout << std::endl;
+
+        if (!isPaced)
+            numberOfUnpacedMissedRefreshes = numberOfMissedRefreshes;
+        else
+            isSuccess &= (numberOfMissedRefreshes <= numberOfUnpacedMissedRefreshes);
+    }
+
+    return isSuccess;
+}
\ No newline at end of file
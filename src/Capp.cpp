@@ -1,10 +1,18 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <string>
 
+#include "AllocationCounter.hpp"
 #include "Capp.hpp"
 #include "SDL.h"
 #include "SDL_ttf.h"
 #include "Toolbox.hpp"
+#if defined(RAYCASTING_BAKED_ASSETS)
+#include "BakedAssets.hpp"
+#endif
 
 // TODO: config.cfg
 // TODO: ImGui
@@ -19,35 +27,138 @@ Capp::Capp()
     m_windowFlags = SDL_WINDOW_SHOWN;
     m_accelForward = 0;
     m_accelSide = 0;
-    m_mouseMoved = false;
     m_isSprinting = false;
+    m_isUsing = false;
     m_fov = 90;
     
+    m_angularSpeed = 0;
+    m_font = nullptr;
+    m_FPStext[0] = '\0';
+    
     m_FPStextColor = { 255, 255, 255 };
 
     m_previousTimePoint = std::chrono::high_resolution_clock::now();
-
-    m_player.initialisePlayer(m_mapManager);
+    m_simulationTime = 0;
+    m_renderTime = 0;
+    m_simulationRate = 0;
+    m_hasPendingEvent = false;
+    m_pipelineDepth = 0;
+    m_frameRate = 0;
+    m_isVsyncEnabled = false;
+    m_isLateLatchEnabled = true;
+    m_polledMouseMotion = 0;
+    m_simulatedMouseMotion = 0;
+    m_inputSampleTimePoint = 0;
+    memset(m_latencyHistogram, 0, sizeof(m_latencyHistogram));
+    m_latencyAverage = 0;
+    m_latencyTotal = 0;
+    m_latencyMax = 0;
+    m_latencyFrameCount = 0;
+
+    m_isHeadless = false;
+    m_isOffscreen = false;
+    m_offscreenSurface = nullptr;
+    m_hasSpecialWalls = false;
+    m_fixedTimestepMicroseconds = 0;
+    m_replayTimestepMicroseconds = 0;
+    m_castTimeTotal = 0;
+    m_castTimeMin = std::numeric_limits<unsigned long long>::max();
+    m_castTimeMax = 0;
+    m_castRaysTotal = 0;
+    m_castPoses = nullptr;
+
+    m_frameTexture = nullptr;
+    m_frameVersion = 0;
+    m_isFrameDirty = true;
+    m_isPresentNeeded = false;
+    m_isIdleWaitEnabled = true;
+    m_isFrameBufferEnabled = false;
+    m_isColumnMajor = false;
+    m_isGeometryEnabled = false;
+    m_numberOfDrawCalls = 0;
+    m_numberOfFrames = 0;
+    m_numberOfAllocationsAfterWarmUp = 0;
+    m_numberOfArenaOverflowsAtWarmUp = 0;
+    m_numberOfArenaOverflowsAfterWarmUp = 0;
 }
 
 bool Capp::run()
 {
     // Initialise App
+    auto startTimePoint = std::chrono::high_resolution_clock::now();
     m_isRunning = initialise();
     if (!m_isRunning)
         return false;
+    if (!m_isHeadless)
+        std::cout << "Startup: " << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTimePoint).count() << " ms" << std::endl;
+
+    // Start simulation thread
+    if (m_simulationRate != 0)
+    {
+        PlayerState state = m_player.getState();
+        m_simulationState.publish(SimulationSnapshot { state, state, 0, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(), 0, 0 });
+        m_simulationThread = std::thread(&Capp::simulationLoop, this);
+    }
     
     // Main loop
     while (m_isRunning)
     {
+        // Paced: wait first, so the input is sampled as late as the frame allows
+        m_framePacer.waitForFrame();
         input();
+        if (!m_isRunning)
+            break;
         update();
-        render();
+        if (!m_isHeadless || m_isOffscreen)
+            render();
+        m_framePacer.endFrame();
+        m_frameArena.reset();
+
+        // Allocation accounting from the end of the warm-up
+        if (++m_numberOfFrames == ALLOCATION_WARM_UP_FRAMES)
+        {
+            AllocationCounter::reset();
+            m_numberOfArenaOverflowsAtWarmUp = m_frameArena.getNumberOfOverflows();
+        }
+
+        // Idle: sleep until the next event (or the next simulation tick, which may move the player)
+        if (!m_isFrameDirty && m_isIdleWaitEnabled)
+            SDL_WaitEventTimeout(nullptr, (m_simulationRate != 0) ? std::max(1u, 1000 / m_simulationRate) : IDLE_WAIT_MILLISECONDS);
     }
+
+    // Before the reports & the teardown, which may allocate
+    m_numberOfAllocationsAfterWarmUp = AllocationCounter::getNumberOfAllocations();
+    m_numberOfArenaOverflowsAfterWarmUp = m_frameArena.getNumberOfOverflows() - m_numberOfArenaOverflowsAtWarmUp;
+
+    if (m_simulationThread.joinable())
+        m_simulationThread.join();
+
+    m_framePipeline.stop();
+    m_frameCapture.stop();
+    printCaptureReport();
+    printLatencyReport();
+
+    if (m_inputRecorder.isReplaying())
+        printReplayReport();
+    m_inputRecorder.close();
+    printAllocationReport();
+
+    if (m_isHeadless && !m_isOffscreen)
+        return true;
     
     // Destroy components
+    m_mapManager.SDL_releaseTextures();
+    m_spriteManager.SDL_releaseTextures();
+    m_frameBuffer.SDL_releaseTextures();
+    m_geometryBatch.SDL_releaseTextures();
+    m_glyphAtlas.SDL_releaseTextures();
+    if (m_frameTexture != nullptr)
+        SDL_DestroyTexture(m_frameTexture);
     SDL_DestroyRenderer(m_renderer);
-    SDL_DestroyWindow(m_window);
+    if (m_offscreenSurface != nullptr)
+        SDL_FreeSurface(m_offscreenSurface);
+    if (m_window != nullptr)
+        SDL_DestroyWindow(m_window);
     TTF_CloseFont(m_font);
     TTF_Quit();
     SDL_Quit();
@@ -57,40 +168,146 @@ bool Capp::run()
 
 bool Capp::initialise()
 {
+    // Open replay, the recording dictates the seed & the number of rays
+    unsigned long long seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    if (!m_replayPath.empty())
+    {
+        if (!m_inputRecorder.openReplay(m_replayPath))
+            return false;
+        seed = m_inputRecorder.getSeed();
+        m_screenWidth = m_inputRecorder.getScreenWidth();
+        m_screenHeight = m_inputRecorder.getScreenHeight();
+        m_hasSpecialWalls = m_inputRecorder.hasSpecialWalls();
+    }
+    else if (m_isHeadless)
+    {
+        std::cerr << "Headless mode requires a replay" << std::endl;
+        return false;
+    }
+    if (m_isHeadless && !m_capturePath.empty())
+    {
+        std::cerr << "Capture requires a window" << std::endl;
+        return false;
+    }
+
+    // Special walls: only the multi-hit traversal draws them, it has no adaptive nor temporal mode
+    if (m_hasSpecialWalls)
+    {
+        if (m_raycaster.getAdaptiveStride() > 1 || m_raycaster.isTemporal())
+        {
+            std::cerr << "Adaptive & temporal casting require a map without special walls" << std::endl;
+            return false;
+        }
+        m_mapManager.addSpecialWalls();
+    }
+
+    // Initialise Player
+    m_player.initialisePlayer(m_mapManager, seed);
+
+    // Initialise frame arena
+    if (!m_frameArena.initialiseArena(FRAME_ARENA_CAPACITY))
+        return false;
+
+    // Headless replay: no window, simulated in the loop, rays only unless drawn offscreen
+    if (m_isHeadless)
+    {
+        m_simulationRate = 0;
+        m_pipelineDepth = 0;
+        if (!m_isOffscreen)
+        {
+            m_raycaster.initialiseRaycaster(m_screenWidth);
+            return true;
+        }
+    }
+
     // Initialise SDL
-    if (SDL_Init(SDL_INIT_VIDEO) != 0)
+    if (!m_isHeadless && SDL_Init(SDL_INIT_VIDEO) != 0)
         return false;
 
-    // Set fullscreen
+    // Set fullscreen (a replay keeps its recorded resolution)
     SDL_DisplayMode displayMode;
-    if (SDL_GetDesktopDisplayMode(0, &displayMode) == 0)
+    const bool hasDisplayMode = !m_isHeadless && (SDL_GetDesktopDisplayMode(0, &displayMode) == 0);
+    if (!m_inputRecorder.isReplaying() && hasDisplayMode)
     {
         m_windowFlags = SDL_WINDOW_FULLSCREEN;
         m_screenWidth = displayMode.w;
         m_screenHeight = displayMode.h;
     }
 
+    // Open recording
+    if (!m_recordPath.empty() && !m_inputRecorder.openRecord(m_recordPath, seed, m_screenWidth, m_screenHeight, m_hasSpecialWalls))
+        return false;
+
     // Initialise Raycasting
     m_raycaster.initialiseRaycaster(m_screenWidth);
-
-    // Initialise Window
-    m_window = SDL_CreateWindow("Raycasting", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, m_screenWidth, m_screenHeight, m_windowFlags);
-    if (m_window == nullptr)
+    if (m_pipelineDepth >= 2 && !m_framePipeline.start(m_pipelineDepth, m_screenWidth, m_mapManager))
+    {
+        std::cerr << "Pipeline depth must be between 2 and " << FramePipeline::MAX_DEPTH << std::endl;
         return false;
+    }
 
-    // Initialise Renderer
-    m_renderer = SDL_CreateRenderer(m_window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
-    if (m_renderer == nullptr)
-        return false;
+    if (m_isHeadless)
+    {
+        // Offscreen: a software renderer drawing into a surface
+        m_offscreenSurface = SDL_CreateRGBSurfaceWithFormat(0, m_screenWidth, m_screenHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (m_offscreenSurface == nullptr)
+            return false;
+        m_renderer = SDL_CreateSoftwareRenderer(m_offscreenSurface);
+        if (m_renderer == nullptr)
+            return false;
+    }
+    else
+    {
+        // Initialise Window
+        m_window = SDL_CreateWindow("Raycasting", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, m_screenWidth, m_screenHeight, m_windowFlags);
+        if (m_window == nullptr)
+            return false;
+
+        // Initialise Renderer
+        m_renderer = SDL_CreateRenderer(m_window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE | (m_isVsyncEnabled ? SDL_RENDERER_PRESENTVSYNC : 0));
+        if (m_renderer == nullptr)
+            return false;
+    }
 
     // Initialise blend mode
     if (SDL_SetRenderDrawBlendMode(m_renderer, SDL_BLENDMODE_BLEND) != 0)
         return false;
 
+    // Composed frame (without it every frame is drawn)
+    m_frameTexture = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, m_screenWidth, m_screenHeight);
+    if (m_frameTexture != nullptr)
+        SDL_SetTextureBlendMode(m_frameTexture, SDL_BLENDMODE_NONE);
+
+    // Pacing: the given rate, with vsync the display's by default
+    if (m_frameRate == 0 && m_isVsyncEnabled && hasDisplayMode)
+        m_frameRate = displayMode.refresh_rate;
+    m_framePacer.setTargetRate(m_frameRate);
+    m_framePacer.setAnchoredToPresent(m_isVsyncEnabled);
+
+    // Capture, at the fixed time step's rate when there is one, else at the paced one
+    unsigned int captureFrameRate = m_framePacer.isEnabled() ? std::max(1u, (unsigned int)(m_frameRate + 0.5)) : CAPTURE_FRAME_RATE;
+    if (m_fixedTimestepMicroseconds != 0)
+        captureFrameRate = std::max(1u, 1000000 / m_fixedTimestepMicroseconds);
+    if (!m_capturePath.empty() && !m_frameCapture.start(m_capturePath, FrameCapture::getFormatFromPath(m_capturePath), m_screenWidth, m_screenHeight, captureFrameRate))
+    {
+        std::cerr << "Can not open capture file: " << m_capturePath << std::endl;
+        return false;
+    }
+
+    // Software walls
+    if (m_isFrameBufferEnabled && !m_frameBuffer.initialiseFrameBuffer(m_screenWidth, m_screenHeight, m_isColumnMajor))
+        return false;
+
     // Initialise relative mouse mode
-    if (SDL_SetRelativeMouseMode(SDL_TRUE) != 0)
+    if (!m_isHeadless && SDL_SetRelativeMouseMode(SDL_TRUE) != 0)
         return false;
 
+#if defined(RAYCASTING_BAKED_ASSETS)
+    // Baked assets ("make bake"): nothing to open nor to convert
+    m_glyphAtlas.SDL_loadAtlas(m_renderer, BakedAssets::FONT_ATLAS, BakedAssets::FONT_ATLAS_WIDTH, BakedAssets::FONT_ATLAS_HEIGHT, BakedAssets::FONT_GLYPHS, BakedAssets::FONT_GLYPH_HEIGHT);
+    m_spriteManager.loadTexture(m_renderer, BakedAssets::SPRITE_TEXTURE, BakedAssets::SPRITE_TEXTURE_SIZE);
+    bool isVisibilitySetLoaded = m_visibilitySet.load(BakedAssets::DEFAULT_PVS, sizeof(BakedAssets::DEFAULT_PVS), m_mapManager);
+#else
     // Initialise font
     if (TTF_Init() != 0)
         return false;
@@ -99,154 +316,595 @@ bool Capp::initialise()
     m_font = TTF_OpenFont("imports/fonts/retro_computer_personal_use.ttf", 64);
     if (m_font == nullptr)
         m_font = TTF_OpenFont("../imports/fonts/retro_computer_personal_use.ttf", 64);
+
+    // FPS glyphs (no font: no FPS)
+    m_glyphAtlas.SDL_loadFont(m_renderer, m_font, m_FPStextColor);
+
+    // Sprite texture
+    if (!m_spriteManager.loadTexture(m_renderer, "imports/texture/circle.bmp"))
+        m_spriteManager.loadTexture(m_renderer, "../imports/texture/circle.bmp");
+    bool isVisibilitySetLoaded = false;
+#endif
+
+    // Sprites (placed from the player seed, so replays see the same ones)
+    m_spriteManager.initialiseSprites(m_mapManager);
+    m_spriteManager.addRandomSprites(m_mapManager, NUMBER_OF_SPRITES, seed);
+
+    // Potentially visible set, computed once and cached next to the map (unless baked for it)
+    const std::string visibilitySetFile = m_hasSpecialWalls ? "special_walls.pvs" : "default.pvs";
+    if (!isVisibilitySetLoaded && !m_visibilitySet.load("../imports/" + visibilitySetFile, m_mapManager))
+        m_visibilitySet.loadOrCompute("imports/" + visibilitySetFile, m_mapManager);
+    if (m_visibilitySet.isComputed())
+        m_spriteManager.setVisibilitySet(&m_visibilitySet);
     
     return true;
 }
 
 void Capp::input()
 {
+    AllocationScope scope(AllocationSubsystem::input);
     SDL_Event events;
-    while(SDL_PollEvent(&events))
+    m_inputSampleTimePoint = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    // Simulation thread: events are handed over, it processes (or records) them on its next tick
+    if (m_simulationRate != 0)
     {
-        switch(events.type)
+        if (m_hasPendingEvent)
         {
-            case SDL_QUIT:
-                m_isRunning = false;
-                break;
+            if (!m_eventQueue.push(m_pendingEvent))
+                return;
+            m_hasPendingEvent = false;
+            if (m_pendingEvent.type == SDL_MOUSEMOTION)
+                m_polledMouseMotion += m_pendingEvent.motion.xrel;
+        }
 
-            case SDL_KEYDOWN:
-                // Move
-                if (events.key.keysym.scancode == SDL_SCANCODE_W)
-                    m_accelForward = 1;
-                else if (events.key.keysym.scancode == SDL_SCANCODE_S)
-                    m_accelForward = -1;
-                else if (events.key.keysym.scancode == SDL_SCANCODE_D)
-                    m_accelSide = 1;
-                else if (events.key.keysym.scancode == SDL_SCANCODE_A)
-                    m_accelSide = -1;
-                else if (events.key.keysym.scancode == SDL_SCANCODE_LEFT)
-                    m_angularSpeed = 1;
-                else if (events.key.keysym.scancode == SDL_SCANCODE_RIGHT)
-                    m_angularSpeed = -1;
-                else if (events.key.keysym.scancode == SDL_SCANCODE_LSHIFT)
-                    m_isSprinting = true;
-                else if (events.key.keysym.scancode == SDL_SCANCODE_ESCAPE)
-                    m_isRunning = false;
+        while (SDL_PollEvent(&events))
+        {
+            if (!m_eventQueue.push(events))
+            {
+                m_pendingEvent = events;
+                m_hasPendingEvent = true;
                 break;
+            }
+            if (events.type == SDL_MOUSEMOTION)
+                m_polledMouseMotion += events.motion.xrel;
+        }
+        return;
+    }
 
-            case SDL_KEYUP:
-                // Stop moving
-                if (events.key.keysym.scancode == SDL_SCANCODE_W)
-                {
-                    if (m_accelForward > 0)
-                        m_accelForward = 0;
-                }
-                else if (events.key.keysym.scancode == SDL_SCANCODE_S)
-                {
-                    if (m_accelForward < 0)
-                        m_accelForward = 0;
-                }
-                else if (events.key.keysym.scancode == SDL_SCANCODE_D)
-                {
-                    if (m_accelSide > 0)
-                        m_accelSide = 0;
-                }
-                else if (events.key.keysym.scancode == SDL_SCANCODE_A)
-                {
-                    if (m_accelSide < 0)
-                        m_accelSide = 0;
-                }
-                else if (events.key.keysym.scancode == SDL_SCANCODE_LEFT)
-                {
-                    if (m_angularSpeed > 0)
-                        m_angularSpeed = 0;
-                }
-                else if (events.key.keysym.scancode == SDL_SCANCODE_RIGHT)
-                {
-                    if (m_angularSpeed < 0)
-                        m_angularSpeed = 0;   
-                }
-                else if (events.key.keysym.scancode == SDL_SCANCODE_LSHIFT)
-                    m_isSprinting = false;
-                break;
+    // Replay: events come from the recording, the live ones can only stop it
+    if (m_inputRecorder.isReplaying())
+    {
+        if (!replayFrame())
+        {
+            m_isRunning = false;
+            return;
+        }
 
-            case SDL_MOUSEMOTION:
-                m_mouseMoved = true;
-                m_angularSpeed = -events.motion.xrel;
-                break;
+        while (!m_isHeadless && SDL_PollEvent(&events))
+            if (events.type == SDL_QUIT || (events.type == SDL_KEYDOWN && events.key.keysym.scancode == SDL_SCANCODE_ESCAPE))
+                m_isRunning = false;
+        return;
+    }
 
-            case SDL_MOUSEWHEEL:
-                m_fov = Math::limitToInterval<unsigned int>(m_fov + events.wheel.y, 60, 120);
-                break;
+    while(SDL_PollEvent(&events))
+    {
+        m_inputRecorder.recordEvent(events);
+        processEvent(events);
+    }
+}
 
-            default:
-                break;
+void Capp::processEvent(const SDL_Event &events)
+{
+    switch(events.type)
+    {
+        case SDL_QUIT:
+            m_isRunning = false;
+            break;
+
+        case SDL_KEYDOWN:
+            // Move
+            if (events.key.keysym.scancode == SDL_SCANCODE_W)
+                m_accelForward = 1;
+            else if (events.key.keysym.scancode == SDL_SCANCODE_S)
+                m_accelForward = -1;
+            else if (events.key.keysym.scancode == SDL_SCANCODE_D)
+                m_accelSide = 1;
+            else if (events.key.keysym.scancode == SDL_SCANCODE_A)
+                m_accelSide = -1;
+            else if (events.key.keysym.scancode == SDL_SCANCODE_LEFT)
+                m_angularSpeed = 1;
+            else if (events.key.keysym.scancode == SDL_SCANCODE_RIGHT)
+                m_angularSpeed = -1;
+            else if (events.key.keysym.scancode == SDL_SCANCODE_LSHIFT)
+                m_isSprinting = true;
+            else if (events.key.keysym.scancode == SDL_SCANCODE_E)
+                m_isUsing = true;
+            else if (events.key.keysym.scancode == SDL_SCANCODE_ESCAPE)
+                m_isRunning = false;
+            break;
+
+        case SDL_KEYUP:
+            // Stop moving
+            if (events.key.keysym.scancode == SDL_SCANCODE_W)
+            {
+                if (m_accelForward > 0)
+                    m_accelForward = 0;
+            }
+            else if (events.key.keysym.scancode == SDL_SCANCODE_S)
+            {
+                if (m_accelForward < 0)
+                    m_accelForward = 0;
+            }
+            else if (events.key.keysym.scancode == SDL_SCANCODE_D)
+            {
+                if (m_accelSide > 0)
+                    m_accelSide = 0;
+            }
+            else if (events.key.keysym.scancode == SDL_SCANCODE_A)
+            {
+                if (m_accelSide < 0)
+                    m_accelSide = 0;
+            }
+            else if (events.key.keysym.scancode == SDL_SCANCODE_LEFT)
+            {
+                if (m_angularSpeed > 0)
+                    m_angularSpeed = 0;
+            }
+            else if (events.key.keysym.scancode == SDL_SCANCODE_RIGHT)
+            {
+                if (m_angularSpeed < 0)
+                    m_angularSpeed = 0;   
+            }
+            else if (events.key.keysym.scancode == SDL_SCANCODE_LSHIFT)
+                m_isSprinting = false;
+            break;
+
+        case SDL_MOUSEMOTION:
+            // A fixed angle per pixel, whatever the frame time: the late latch can turn the pose at once
+            m_player.turnPlayer(-MOUSE_SENSITIVITY * events.motion.xrel);
+            m_simulatedMouseMotion += events.motion.xrel;
+            break;
+
+        case SDL_WINDOWEVENT:
+            // Exposed, resized...: the last frame has to be presented again
+            m_isPresentNeeded = true;
+            break;
+
+        case SDL_MOUSEWHEEL:
+            m_fov = Math::limitToInterval<unsigned int>(m_fov + events.wheel.y, 60, 120);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void Capp::latchInput()
+{
+    // Late latch, right before casting: the mouse motion which arrived since the input was polled
+    // (not while an older event waits for room in the simulation queue, it must go first)
+    if (!m_isLateLatchEnabled || m_isHeadless || m_inputRecorder.isReplaying() || m_hasPendingEvent)
+        return;
+
+    AllocationScope scope(AllocationSubsystem::input);
+    m_inputSampleTimePoint = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    SDL_PumpEvents();
+    SDL_Event events[LATCH_EVENT_CAPACITY];
+    int numberOfEvents = LATCH_EVENT_CAPACITY;
+    while (numberOfEvents == (int)LATCH_EVENT_CAPACITY)
+    {
+        numberOfEvents = SDL_PeepEvents(events, LATCH_EVENT_CAPACITY, SDL_GETEVENT, SDL_MOUSEMOTION, SDL_MOUSEMOTION);
+        for (int i = 0; i < numberOfEvents; i++)
+        {
+            // Serial: recorded after this frame's delta, the replay turns before the next move, as here
+            if (m_simulationRate == 0)
+            {
+                m_inputRecorder.recordEvent(events[i]);
+                processEvent(events[i]);
+            }
+            else if (m_eventQueue.push(events[i]))
+                m_polledMouseMotion += events[i].motion.xrel;
+            else
+            {
+                // Simulation queue full: back to SDL's, polled next frame
+                for (; i < numberOfEvents; i++)
+                    SDL_PushEvent(&events[i]);
+                return;
+            }
         }
     }
 }
 
+bool Capp::replayFrame()
+{
+    SDL_Event events;
+    if (!m_inputRecorder.readFrame(m_replayTimestepMicroseconds))
+        return false;
+
+    while (m_inputRecorder.pollEvent(events))
+        processEvent(events);
+    return true;
+}
+
 void Capp::update()
 {
+    AllocationScope scope(AllocationSubsystem::simulation);
+
     // Calculate elapsed time
     auto currentTimePoint = std::chrono::high_resolution_clock::now();
     unsigned long long elapsedTime = std::chrono::duration_cast<std::chrono::microseconds>(currentTimePoint - m_previousTimePoint).count();
     m_previousTimePoint = currentTimePoint;
-    
+
+    // Resolution: the ray count follows the frame time (idle waits are not frames)
+    if (!m_isHeadless && m_isFrameDirty)
+        m_resolutionController.update(1e-3 * elapsedTime);
+    const unsigned int numberOfRays = m_resolutionController.isEnabled() ? m_resolutionController.getNumberOfRays(m_screenWidth) : m_screenWidth;
+
+    if (m_simulationRate == 0)
+    {
+        // Simulation time step: fixed, recorded or measured
+        unsigned long long dt = elapsedTime;
+        if (m_fixedTimestepMicroseconds != 0)
+            dt = m_fixedTimestepMicroseconds;
+        else if (m_inputRecorder.isReplaying())
+            dt = m_replayTimestepMicroseconds;
+        simulate(dt);
+        latchInput();
+
+        m_renderPlayer.setState(m_player.getState());
+        m_renderTime = m_simulationTime;
+    }
+    else
+    {
+        // Interpolate between the last two simulation ticks
+        latchInput();
+        SimulationSnapshot snapshot = m_simulationState.read();
+        long long now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        double tickDuration = 1.0 / m_simulationRate;
+        double alpha = Math::limitToInterval<double>(1e-6 * (now - snapshot.tickTimePoint) / tickDuration, 0, 1);
+
+        PlayerState state;
+        state.x = snapshot.previous.x + alpha * (snapshot.current.x - snapshot.previous.x);
+        state.y = snapshot.previous.y + alpha * (snapshot.current.y - snapshot.previous.y);
+        state.angle = snapshot.previous.angle + alpha * (snapshot.current.angle - snapshot.previous.angle);
+        if (m_isLateLatchEnabled && !m_inputRecorder.isReplaying())
+        {
+            // Mouse turns are not interpolated: all the polled motion, simulated or not, is applied
+            const double previousAngle = snapshot.previous.angle + MOUSE_SENSITIVITY * snapshot.previousMouseMotion;
+            const double currentAngle = snapshot.current.angle + MOUSE_SENSITIVITY * snapshot.currentMouseMotion;
+            state.angle = previousAngle + alpha * (currentAngle - previousAngle) - MOUSE_SENSITIVITY * m_polledMouseMotion;
+        }
+        state.velocity = snapshot.previous.velocity + alpha * (snapshot.current.velocity - snapshot.previous.velocity);
+        m_renderPlayer.setState(state);
+        m_renderTime = snapshot.time - (1 - alpha) * tickDuration;
+    }
+
+    // Same frame version as the last composed frame: nothing to cast, draw or present
+    const unsigned long long frameVersion = computeFrameVersion(numberOfRays);
+    m_isFrameDirty = (frameVersion != m_frameVersion || m_frameTexture == nullptr || m_isHeadless || m_framePipeline.isRunning() || m_inputRecorder.isReplaying());
+    m_frameVersion = frameVersion;
+    if (!m_isFrameDirty)
+        return;
+
     // FPS
-    m_FPSstring = std::string("FPS: ");
-    m_FPSstring.append(std::to_string((int)(1e6 / elapsedTime)));
-    m_FPStextSurface = TTF_RenderText_Solid(m_font, m_FPSstring.c_str(), m_FPStextColor);
-    m_FPStextTexture = SDL_CreateTextureFromSurface(m_renderer, m_FPStextSurface);
-    int textureWidth = 0;
-    int textureHeight = 0;
-    SDL_QueryTexture(m_FPStextTexture, nullptr, nullptr, &textureWidth, &textureHeight);
-    m_FPStextTextureRect = { 0, (int)m_screenHeight - textureHeight, textureWidth, textureHeight };
-    
+    if (!m_isHeadless)
+        updateFPS(elapsedTime);
+
+    // Player vision: cast now, or hand the pose to the pipeline which casts ahead
+    AllocationScope castingScope(AllocationSubsystem::casting);
+    if (m_framePipeline.isRunning())
+    {
+        m_framePipeline.submitSample(FrameSample { m_renderPlayer.getState(), m_fov, numberOfRays, m_renderTime, m_inputSampleTimePoint });
+        return;
+    }
+
+    m_raycaster.setNumberOfRays(numberOfRays);
+    if (m_castPoses != nullptr)
+        m_castPoses->push_back(m_renderPlayer.getState());
+    auto castStartTimePoint = std::chrono::high_resolution_clock::now();
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mapManager.getCellsMutex());
+        m_raycaster.calculateRays_OMP(m_renderPlayer, m_mapManager, m_fov);
+    }
+    unsigned long long castTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - castStartTimePoint).count();
+    m_castTimeTotal += castTime;
+    m_castTimeMin = std::min(m_castTimeMin, castTime);
+    m_castTimeMax = std::max(m_castTimeMax, castTime);
+    m_castRaysTotal += m_raycaster.getNumberOfCastRays();
+}
+
+unsigned long long Capp::computeFrameVersion(unsigned int numberOfRays)
+{
+    // FNV-1a over what the frame is drawn from. The head bob follows the velocity & the time:
+    // the time only counts while moving
+    struct
+    {
+        PlayerState state;
+        double time;
+        unsigned long long mapRevision;
+        unsigned int fov;
+        unsigned int numberOfRays;
+    } key;
+    memset(&key, 0, sizeof(key));
+    key.state = m_renderPlayer.getState();
+    key.time = (key.state.velocity != 0) ? m_renderTime : 0;
+    key.mapRevision = m_mapManager.getRevision();
+    key.fov = m_fov;
+    key.numberOfRays = numberOfRays;
+
+    unsigned long long hash = 14695981039346656037ull;
+    const unsigned char *bytes = (const unsigned char *)&key;
+    for (unsigned int i = 0; i < sizeof(key); i++)
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    return hash;
+}
+
+void Capp::updateFPS(unsigned long long elapsedTime)
+{
+    // Formatted in place, drawn from the glyph atlas
+    AllocationScope scope(AllocationSubsystem::text);
+    size_t length = snprintf(m_FPStext, FPS_TEXT_CAPACITY, "FPS: %d", (int)(1e6 / elapsedTime));
+    if (m_latencyFrameCount != 0 && length < FPS_TEXT_CAPACITY)
+        length += snprintf(m_FPStext + length, FPS_TEXT_CAPACITY - length, " LAT: %.1f ms", m_latencyAverage);
+    if (m_numberOfDrawCalls != 0 && length < FPS_TEXT_CAPACITY)
+        length += snprintf(m_FPStext + length, FPS_TEXT_CAPACITY - length, " DC: %u", m_numberOfDrawCalls);
+    if (m_resolutionController.isEnabled() && length < FPS_TEXT_CAPACITY)
+        snprintf(m_FPStext + length, FPS_TEXT_CAPACITY - length, " RES: %d%%", (int)(100 * m_resolutionController.getScale()));
+}
+
+void Capp::simulate(unsigned long long dt)
+{
+    m_inputRecorder.recordFrame(dt);
+    m_simulationTime += 1e-6 * dt;
+
     // Player actions
-    m_player.movePlayer(m_mapManager, m_accelForward, m_accelSide, m_isSprinting, 1e-6 * elapsedTime);
-    m_player.rotatePlayer(m_angularSpeed, 1e-6 * elapsedTime);
+    m_player.movePlayer(m_mapManager, m_accelForward, m_accelSide, m_isSprinting, 1e-6 * dt);
+    m_player.rotatePlayer(m_angularSpeed, 1e-6 * dt);
 
-    // Player vision
-    m_raycaster.calculateRaysDistance_OMP(m_player, m_mapManager, m_fov);
+    // Use: open or close the door in front of the player, unless it stands in it
+    if (m_isUsing)
+    {
+        m_isUsing = false;
+        unsigned int x = m_player.getX() + USE_DISTANCE * cos(m_player.getAngle());
+        unsigned int y = m_player.getY() - USE_DISTANCE * sin(m_player.getAngle());
+        if (m_mapManager.isDoor(x, y) && !m_player.isOverlappingCell(x, y))
+        {
+            // The render thread (with the simulation thread) or the pipeline worker may be casting
+            std::unique_lock<std::shared_mutex> lock(m_mapManager.getCellsMutex());
+            m_mapManager.toggleDoor(x, y);
+        }
+    }
+}
 
-    // Reset rotation if mouse moved
-    if (m_mouseMoved)
+void Capp::simulationLoop()
+{
+    const unsigned long long tickMicroseconds = 1000000 / m_simulationRate;
+    const std::chrono::microseconds tickDuration(tickMicroseconds);
+    const unsigned int MAX_LATE_TICKS = 8;
+    AllocationScope scope(AllocationSubsystem::simulation);
+    auto nextTickTimePoint = std::chrono::steady_clock::now();
+    SimulationSnapshot snapshot = m_simulationState.read();
+    SDL_Event events;
+
+    while (m_isRunning)
     {
-        m_mouseMoved = false;
-        m_angularSpeed = 0;
+        // Input
+        if (m_inputRecorder.isReplaying())
+        {
+            while (m_eventQueue.pop(events))
+                if (events.type == SDL_QUIT || (events.type == SDL_KEYDOWN && events.key.keysym.scancode == SDL_SCANCODE_ESCAPE))
+                    m_isRunning = false;
+            if (!replayFrame())
+                m_isRunning = false;
+        }
+        else
+        {
+            while (m_eventQueue.pop(events))
+            {
+                m_inputRecorder.recordEvent(events);
+                processEvent(events);
+            }
+        }
+
+        // Fixed step & publish
+        simulate(tickMicroseconds);
+        snapshot.previous = snapshot.current;
+        snapshot.current = m_player.getState();
+        snapshot.previousMouseMotion = snapshot.currentMouseMotion;
+        snapshot.currentMouseMotion = m_simulatedMouseMotion;
+        snapshot.time = m_simulationTime;
+        snapshot.tickTimePoint = std::chrono::duration_cast<std::chrono::microseconds>(nextTickTimePoint.time_since_epoch()).count();
+        m_simulationState.publish(snapshot);
+
+        // Wait next tick, do not try to catch up after a long stall
+        nextTickTimePoint += tickDuration;
+        auto now = std::chrono::steady_clock::now();
+        if (now - nextTickTimePoint > MAX_LATE_TICKS * tickDuration)
+            nextTickTimePoint = now;
+        std::this_thread::sleep_until(nextTickTimePoint);
     }
 }
 
 void Capp::render()
 {
+    AllocationScope scope(AllocationSubsystem::rendering);
+
+    // Unchanged frame: present the last composed one again only if the window needs it
+    if (!m_isFrameDirty)
+    {
+        if (m_isPresentNeeded.exchange(false))
+        {
+            SDL_RenderCopy(m_renderer, m_frameTexture, nullptr, nullptr);
+            m_framePacer.markPresent();
+            SDL_RenderPresent(m_renderer);
+        }
+        return;
+    }
+
+    // Frame to submit
+    Raycaster *raycaster = &m_raycaster;
+    Player *player = &m_renderPlayer;
+    double time = m_renderTime;
+    unsigned int fov = m_fov;
+    if (m_framePipeline.isRunning())
+    {
+        if (!m_framePipeline.acquireFrame())
+            return;
+        raycaster = &m_framePipeline.getRaycaster();
+        player = &m_framePipeline.getPlayer();
+        time = m_framePipeline.getSample().time;
+        fov = m_framePipeline.getSample().fov;
+    }
+
+    // Compose into the frame texture, kept for the unchanged frames
+    if (m_frameTexture != nullptr)
+        SDL_SetRenderTarget(m_renderer, m_frameTexture);
+
     // Clear renderer
     SDL_SetRenderDrawColor(m_renderer, 70, 70, 70, 255);
     SDL_RenderClear(m_renderer);
 
     // Render map (2D)
     // m_mapManager.SDL_renderMap(m_renderer, m_screenWidth, m_screenHeight);
-    // m_player.SDL_renderPlayer(m_renderer, m_mapManager, m_screenWidth, m_screenHeight);
-    // m_raycaster.SDL_renderRaycast2DMap(m_renderer, m_mapManager, m_player, m_screenWidth, m_screenHeight);
+    // player->SDL_renderPlayer(m_renderer, m_mapManager, m_screenWidth, m_screenHeight);
+    // raycaster->SDL_renderRaycast2DMap(m_renderer, m_mapManager, *player, m_screenWidth, m_screenHeight);
     
     // Render 2.5D environment
     // Render sky & ground (TODO)
 
     // Render walls
-    m_raycaster.SDL_renderRaycastBackground(m_renderer, m_player.getVelocity(), std::chrono::duration_cast<std::chrono::microseconds>(m_previousTimePoint.time_since_epoch()).count() * 1e-6, m_screenWidth, m_screenHeight);
-    m_raycaster.SDL_renderRaycast(m_renderer, m_player.getVelocity(), std::chrono::duration_cast<std::chrono::microseconds>(m_previousTimePoint.time_since_epoch()).count() * 1e-6, m_screenWidth, m_screenHeight);
+    if (m_isFrameBufferEnabled)
+    {
+        // Dynamic resolution: one column per ray, upscaled to the screen
+        m_frameBuffer.setDrawWidth(raycaster->getNumberOfRays());
+        raycaster->renderRaycastFrameBuffer(m_frameBuffer, player->getVelocity(), time);
+        m_frameBuffer.SDL_renderFrameBuffer(m_renderer);
+    }
+    else if (m_isGeometryEnabled)
+        raycaster->SDL_renderRaycastGeometry(m_renderer, m_geometryBatch, player->getVelocity(), time, m_screenWidth, m_screenHeight);
+    else
+    {
+        raycaster->SDL_renderRaycastBackground(m_renderer, player->getVelocity(), time, m_screenWidth, m_screenHeight);
+        raycaster->SDL_renderRaycast(m_renderer, player->getVelocity(), time, m_screenWidth, m_screenHeight);
+    }
+    m_numberOfDrawCalls = raycaster->getNumberOfDrawCalls();
+
+    // Render sprites
+    {
+        AllocationScope spritesScope(AllocationSubsystem::sprites);
+        if (m_visibilitySet.isComputed())
+            m_visibilitySet.setViewerCell(player->getX(), player->getY());
+        m_spriteManager.SDL_renderSprites(m_renderer, m_frameArena, *player, *raycaster, fov, m_screenWidth, m_screenHeight);
+    }
 
     // Render Minimap
-    m_mapManager.SDL_renderMiniMap(m_renderer, m_screenWidth, m_screenHeight, MINIMAP_SCALE_FACTOR);
-    m_raycaster.SDL_renderRaycast2DMiniMap(m_renderer, m_mapManager, m_player, m_screenWidth, m_screenHeight, MINIMAP_SCALE_FACTOR);
-    m_player.SDL_renderPlayerMiniMap(m_renderer, m_mapManager, m_screenWidth, m_screenHeight, MINIMAP_SCALE_FACTOR);
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mapManager.getCellsMutex());
+        m_mapManager.SDL_renderMiniMap(m_renderer, m_screenWidth, m_screenHeight, MINIMAP_SCALE_FACTOR);
+        raycaster->SDL_renderRaycast2DMiniMap(m_renderer, m_mapManager, *player, m_screenWidth, m_screenHeight, MINIMAP_SCALE_FACTOR);
+        player->SDL_renderPlayerMiniMap(m_renderer, m_mapManager, m_screenWidth, m_screenHeight, MINIMAP_SCALE_FACTOR);
+    }
+
+    if (m_frameTexture != nullptr)
+    {
+        SDL_SetRenderTarget(m_renderer, nullptr);
+        SDL_RenderCopy(m_renderer, m_frameTexture, nullptr, nullptr);
+    }
+    m_isPresentNeeded = false;
 
     // Render FPS
-    SDL_RenderCopy(m_renderer, m_FPStextTexture, nullptr, &m_FPStextTextureRect);
+    {
+        AllocationScope textScope(AllocationSubsystem::text);
+        m_glyphAtlas.SDL_renderText(m_renderer, m_FPStext, 0, (int)m_screenHeight - m_glyphAtlas.getGlyphHeight());
+    }
 
-    // Deallocate FPS's texture & surface
-    SDL_FreeSurface(m_FPStextSurface);
-    SDL_DestroyTexture(m_FPStextTexture);
+    // Capture the composed frame into a free buffer of the pool (none: the frame is dropped)
+    if (m_frameCapture.isRunning())
+    {
+        Uint32 *capturePixels = m_frameCapture.acquireFrame();
+        if (capturePixels != nullptr && SDL_RenderReadPixels(m_renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, capturePixels, m_screenWidth * sizeof(Uint32)) == 0)
+            m_frameCapture.submitFrame();
+    }
 
     // Render
+    m_framePacer.markPresent();
     SDL_RenderPresent(m_renderer);
+
+    // Latency from the input sample (pipelined: the one the frame was cast from) to present
+    long long now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    recordLatency(1e-3 * (now - (m_framePipeline.isRunning() ? m_framePipeline.getSample().sampleTimePoint : m_inputSampleTimePoint)));
+    if (m_framePipeline.isRunning())
+        m_framePipeline.releaseFrame();
+}
+
+void Capp::recordLatency(double latency)
+{
+    m_latencyAverage += 0.05 * (latency - m_latencyAverage);
+    m_latencyTotal += latency;
+    m_latencyMax = std::max(m_latencyMax, latency);
+    m_latencyFrameCount++;
+    m_latencyHistogram[std::min(LATENCY_HISTOGRAM_SIZE - 1, (unsigned int)(latency * 10))]++;
+}
+
+void Capp::printLatencyReport()
+{
+    if (m_latencyFrameCount == 0)
+        return;
+
+    // Median & 99th percentile from the histogram (upper bound of their bin)
+    const double PERCENTILES[] = { 0.5, 0.99 };
+    double latencies[] = { 0, 0 };
+    unsigned long long count = 0;
+    unsigned int p = 0;
+    for (unsigned int i = 0; i < LATENCY_HISTOGRAM_SIZE && p < 2; i++)
+    {
+        count += m_latencyHistogram[i];
+        while (p < 2 && count >= PERCENTILES[p] * m_latencyFrameCount)
+            latencies[p++] = 0.1 * (i + 1);
+    }
+
+    std::cout << "Latency (input sample to present";
+    if (m_pipelineDepth >= 2)
+        std::cout << ", pipeline depth " << m_pipelineDepth;
+    std::cout << (m_isLateLatchEnabled ? ", late latch" : "") << "): avg " << m_latencyTotal / m_latencyFrameCount << " ms, p50 " << latencies[0] << " ms, p99 " << latencies[1] << " ms, max " << m_latencyMax << " ms over " << m_latencyFrameCount << " frames" << std::endl;
+
+    if (m_framePacer.isEnabled())
+        std::cout << "Frame pacing (" << m_framePacer.getTargetRate() << " Hz" << (m_isVsyncEnabled ? ", vsync" : "") << "): " << m_framePacer.getNumberOfFrames() << " frames, " << m_framePacer.getNumberOfMissedDeadlines() << " missed deadlines, "
+                  << m_framePacer.getNumberOfMissedRefreshes() << " missed refreshes, wake error avg " << m_framePacer.getAverageWakeError() << " ms, spin avg " << m_framePacer.getAverageSpinTime() << " ms/frame (margin " << m_framePacer.getSpinMargin()
+                  << " ms), predicted work " << m_framePacer.getPredictedWork() << " ms, safety margin " << m_framePacer.getSafetyMargin() << " ms" << std::endl;
+}
+
+void Capp::printReplayReport()
+{
+    unsigned int frameCount = m_inputRecorder.getFrameCount();
+    if (frameCount == 0)
+        return;
+
+    std::cout << "Replay: " << frameCount << " frames, " << m_screenWidth << " rays, " << m_simulationTime << " s simulated" << std::endl;
+    std::cout << "Ray casting (us/frame): avg " << m_castTimeTotal / frameCount << ", min " << m_castTimeMin << ", max " << m_castTimeMax << std::endl;
+    std::cout << "Rays cast: " << 100.0 * m_castRaysTotal / ((unsigned long long)frameCount * m_screenWidth) << "%" << std::endl;
+}
+
+void Capp::printCaptureReport()
+{
+    if (m_capturePath.empty())
+        return;
+
+    const unsigned long long numberOfFrames = m_frameCapture.getNumberOfWrittenFrames() + m_frameCapture.getNumberOfDroppedFrames();
+    std::cout << "Capture: " << m_frameCapture.getNumberOfWrittenFrames() << " frames written to " << m_capturePath << " (" << m_frameCapture.getNumberOfWrittenBytes() / (1024 * 1024) << " MB), "
+              << m_frameCapture.getNumberOfDroppedFrames() << " dropped (" << ((numberOfFrames != 0) ? 100.0 * m_frameCapture.getNumberOfDroppedFrames() / numberOfFrames : 0) << "%)" << std::endl;
+}
+
+void Capp::printAllocationReport()
+{
+    if (!AllocationCounter::isEnabled() || m_numberOfFrames <= ALLOCATION_WARM_UP_FRAMES)
+        return;
+
+    const double numberOfFrames = m_numberOfFrames - ALLOCATION_WARM_UP_FRAMES;
+    std::cout << "Allocations per frame after " << ALLOCATION_WARM_UP_FRAMES << " frames: " << m_numberOfAllocationsAfterWarmUp / numberOfFrames;
+    for (int i = 0; i < (int)AllocationSubsystem::count; i++)
+        if (AllocationCounter::getNumberOfAllocations((AllocationSubsystem)i) != 0)
+            std::cout << ", " << AllocationCounter::getSubsystemName((AllocationSubsystem)i) << " " << AllocationCounter::getNumberOfAllocations((AllocationSubsystem)i) / numberOfFrames;
+    std::cout << " (frame arena peak " << m_frameArena.getPeak() << " bytes, " << m_numberOfArenaOverflowsAfterWarmUp << " overflows)" << std::endl;
 }
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "CpuFeatures.hpp"
+
+SimdLevel CpuFeatures::m_level = SimdLevel::scalar;
+bool CpuFeatures::m_isInitialised = false;
+
+SimdLevel CpuFeatures::getLevel()
+{
+    if (!m_isInitialised)
+        m_level = initialiseLevel();
+    return m_level;
+}
+
+SimdLevel CpuFeatures::getSupportedLevel()
+{
+    static const SimdLevel supportedLevel = detectLevel();
+    return supportedLevel;
+}
+
+bool CpuFeatures::setLevel(const SimdLevel level)
+{
+    if (level > getSupportedLevel())
+        return false;
+
+    m_level = level;
+    m_isInitialised = true;
+    return true;
+}
+
+bool CpuFeatures::setLevel(const char *name)
+{
+    SimdLevel level;
+    if (!parseLevel(name, level))
+    {
+        std::cerr << "Unknown SIMD level: " << name << " (scalar, sse4.2, avx2, avx512)" << std::endl;
+        return false;
+    }
+    if (!setLevel(level))
+    {
+        std::cerr << "SIMD level not supported by this CPU: " << name << " (up to " << getLevelName(getSupportedLevel()) << ")" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+const char *CpuFeatures::getLevelName(const SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::sse42:
+            return "sse4.2";
+        case SimdLevel::avx2:
+            return "avx2";
+        case SimdLevel::avx512:
+            return "avx512";
+        default:
+            return "scalar";
+    }
+}
+
+bool CpuFeatures::parseLevel(const char *name, SimdLevel &level)
+{
+    for (SimdLevel candidate : { SimdLevel::scalar, SimdLevel::sse42, SimdLevel::avx2, SimdLevel::avx512 })
+    {
+        if (strcmp(name, getLevelName(candidate)) == 0)
+        {
+            level = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+SimdLevel CpuFeatures::detectLevel()
+{
+#if defined(RAYCASTING_X86_DISPATCH)
+    // AVX-512: the kernels need the byte & word instructions (BW) besides the foundation
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl"))
+        return SimdLevel::avx512;
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::avx2;
+    if (__builtin_cpu_supports("sse4.2"))
+        return SimdLevel::sse42;
+#endif
+    return SimdLevel::scalar;
+}
+
+SimdLevel CpuFeatures::initialiseLevel()
+{
+    m_isInitialised = true;
+    const char *name = getenv("RAYCASTING_SIMD");
+    if (name != nullptr && setLevel(name))
+        return m_level;
+
+    return getSupportedLevel();
+}
\ No newline at end of file
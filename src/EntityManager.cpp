@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <cmath>
+#include <omp.h>
+
+#include "EntityManager.hpp"
+
+EntityManager::EntityManager()
+{
+    m_gridWidth = 0;
+    m_gridHeight = 0;
+    m_restitution = 0;
+    m_numberOfCellChanges = 0;
+    m_numberOfContacts = 0;
+}
+
+bool EntityManager::isBlocked(const MapManager &mapManager, int x, int y)
+{
+    // Outside of the map is solid: the sentinel ring, boxes never reach past it
+    return mapManager.getMapElement(x, y) != 0;
+}
+
+void EntityManager::moveAndCollide(const MapManager &mapManager, double &x, double &y, const double halfSize, const double dx, const double dy, bool &isXblocked, bool &isYblocked)
+{
+    const double EPSILON = 1e-6;
+    isXblocked = false;
+    isYblocked = false;
+
+    // X axis: columns entered by the leading edge, over the rows covered by the box
+    if (dx != 0)
+    {
+        const int firstRow = floor(y - halfSize);
+        const int lastRow = floor(y + halfSize);
+        const double front = (dx > 0) ? x + halfSize : x - halfSize;
+        const int step = (dx > 0) ? 1 : -1;
+        const int lastColumn = floor(front + dx);
+        for (int column = (int)floor(front) + step; column * step <= lastColumn * step && !isXblocked; column += step)
+        {
+            for (int row = firstRow; row <= lastRow; row++)
+            {
+                if (isBlocked(mapManager, column, row))
+                {
+                    x = (dx > 0) ? column - halfSize - EPSILON : column + 1 + halfSize + EPSILON;
+                    isXblocked = true;
+                    break;
+                }
+            }
+        }
+        if (!isXblocked)
+            x += dx;
+    }
+
+    // Y axis, from the new x
+    if (dy != 0)
+    {
+        const int firstColumn = floor(x - halfSize);
+        const int lastColumn = floor(x + halfSize);
+        const double front = (dy > 0) ? y + halfSize : y - halfSize;
+        const int step = (dy > 0) ? 1 : -1;
+        const int lastRow = floor(front + dy);
+        for (int row = (int)floor(front) + step; row * step <= lastRow * step && !isYblocked; row += step)
+        {
+            for (int column = firstColumn; column <= lastColumn; column++)
+            {
+                if (isBlocked(mapManager, column, row))
+                {
+                    y = (dy > 0) ? row - halfSize - EPSILON : row + 1 + halfSize + EPSILON;
+                    isYblocked = true;
+                    break;
+                }
+            }
+        }
+        if (!isYblocked)
+            y += dy;
+    }
+}
+
+void EntityManager::initialiseEntities(const MapManager &mapManager)
+{
+    clear();
+    m_gridWidth = mapManager.getWidth();
+    m_gridHeight = mapManager.getHeight();
+    m_cellEntities.assign(m_gridWidth * m_gridHeight, std::vector<unsigned int>());
+}
+
+unsigned int EntityManager::addEntity(const double x, const double y, const double halfSize, const double vx, const double vy)
+{
+    const unsigned int entity = m_x.size();
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_vx.push_back(vx);
+    m_vy.push_back(vy);
+    m_halfSize.push_back(std::min(halfSize, MAX_HALF_SIZE));
+    m_entityCell.push_back(0);
+    m_entitySlot.push_back(0);
+    insertInCell(entity, positionToCell(x, y));
+
+    return entity;
+}
+
+void EntityManager::removeEntity(const unsigned int entity)
+{
+    const unsigned int lastEntity = m_x.size() - 1;
+    removeFromCell(entity);
+    if (entity != lastEntity)
+    {
+        // Move the last entity into the hole, its bucket entry follows
+        m_x[entity] = m_x[lastEntity];
+        m_y[entity] = m_y[lastEntity];
+        m_vx[entity] = m_vx[lastEntity];
+        m_vy[entity] = m_vy[lastEntity];
+        m_halfSize[entity] = m_halfSize[lastEntity];
+        m_entityCell[entity] = m_entityCell[lastEntity];
+        m_entitySlot[entity] = m_entitySlot[lastEntity];
+        m_cellEntities[m_entityCell[entity]][m_entitySlot[entity]] = entity;
+    }
+
+    m_x.pop_back();
+    m_y.pop_back();
+    m_vx.pop_back();
+    m_vy.pop_back();
+    m_halfSize.pop_back();
+    m_entityCell.pop_back();
+    m_entitySlot.pop_back();
+}
+
+void EntityManager::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_vx.clear();
+    m_vy.clear();
+    m_halfSize.clear();
+    m_entityCell.clear();
+    m_entitySlot.clear();
+    for (std::vector<unsigned int> &cellEntities : m_cellEntities)
+        cellEntities.clear();
+}
+
+void EntityManager::insertInCell(const unsigned int entity, const unsigned int cell)
+{
+    m_entityCell[entity] = cell;
+    m_entitySlot[entity] = m_cellEntities[cell].size();
+    m_cellEntities[cell].push_back(entity);
+}
+
+void EntityManager::removeFromCell(const unsigned int entity)
+{
+    // Swap with the bucket's last entity
+    std::vector<unsigned int> &cellEntities = m_cellEntities[m_entityCell[entity]];
+    const unsigned int lastEntity = cellEntities.back();
+    cellEntities[m_entitySlot[entity]] = lastEntity;
+    m_entitySlot[lastEntity] = m_entitySlot[entity];
+    cellEntities.pop_back();
+}
+
+void EntityManager::updateGrid()
+{
+    const int numberOfEntities = m_x.size();
+    m_nextCell.resize(numberOfEntities);
+
+#pragma omp parallel for
+    for (int i = 0; i < numberOfEntities; i++)
+        m_nextCell[i] = positionToCell(m_x[i], m_y[i]);
+
+    // Only the entities which changed cell touch the buckets
+    for (int i = 0; i < numberOfEntities; i++)
+    {
+        if (m_nextCell[i] == m_entityCell[i])
+            continue;
+        removeFromCell(i);
+        insertInCell(i, m_nextCell[i]);
+        m_numberOfCellChanges++;
+    }
+}
+
+void EntityManager::update(const MapManager &mapManager, const double dt)
+{
+    const int numberOfEntities = m_x.size();
+    m_numberOfCellChanges = 0;
+
+    // Integrate & sweep against the walls
+#pragma omp parallel for
+    for (int i = 0; i < numberOfEntities; i++)
+    {
+        bool isXblocked, isYblocked;
+        moveAndCollide(mapManager, m_x[i], m_y[i], m_halfSize[i], m_vx[i] * dt, m_vy[i] * dt, isXblocked, isYblocked);
+        if (isXblocked)
+            m_vx[i] *= -m_restitution;
+        if (isYblocked)
+            m_vy[i] *= -m_restitution;
+    }
+    updateGrid();
+
+    // Entity vs entity
+    separateEntities(mapManager);
+    updateGrid();
+}
+
+void EntityManager::separateEntities(const MapManager &mapManager)
+{
+    const int numberOfEntities = m_x.size();
+    unsigned int numberOfContacts = 0;
+    m_pushX.resize(numberOfEntities);
+    m_pushY.resize(numberOfEntities);
+
+    // Each entity takes half of the overlap with each neighbour (the other half is
+    // applied from the neighbour's side), so the loop only writes its own push
+#pragma omp parallel for reduction(+:numberOfContacts)
+    for (int i = 0; i < numberOfEntities; i++)
+    {
+        double pushX = 0;
+        double pushY = 0;
+        const int cellX = m_entityCell[i] % m_gridWidth;
+        const int cellY = m_entityCell[i] / m_gridWidth;
+
+        for (int y = std::max(0, cellY - 1); y <= std::min<int>(m_gridHeight - 1, cellY + 1); y++)
+        {
+            for (int x = std::max(0, cellX - 1); x <= std::min<int>(m_gridWidth - 1, cellX + 1); x++)
+            {
+                for (unsigned int j : m_cellEntities[x + y * m_gridWidth])
+                {
+                    if ((int)j == i)
+                        continue;
+
+                    const double dx = m_x[i] - m_x[j];
+                    const double dy = m_y[i] - m_y[j];
+                    const double minimumDistance = m_halfSize[i] + m_halfSize[j];
+                    const double squaredDistance = dx * dx + dy * dy;
+                    if (squaredDistance >= minimumDistance * minimumDistance)
+                        continue;
+
+                    // Same position: split along x, by index
+                    numberOfContacts++;
+                    const double distance = sqrt(squaredDistance);
+                    if (distance < COLLISION_EPSILON)
+                        pushX += ((int)j < i ? 0.5 : -0.5) * minimumDistance;
+                    else
+                    {
+                        pushX += 0.5 * (minimumDistance - distance) * dx / distance;
+                        pushY += 0.5 * (minimumDistance - distance) * dy / distance;
+                    }
+                }
+            }
+        }
+
+        m_pushX[i] = pushX;
+        m_pushY[i] = pushY;
+    }
+    m_numberOfContacts = numberOfContacts / 2;
+
+    // Pushes are swept too, crowds cannot squeeze an entity into a wall
+#pragma omp parallel for
+    for (int i = 0; i < numberOfEntities; i++)
+    {
+        bool isXblocked, isYblocked;
+        if (m_pushX[i] != 0 || m_pushY[i] != 0)
+            moveAndCollide(mapManager, m_x[i], m_y[i], m_halfSize[i], m_pushX[i], m_pushY[i], isXblocked, isYblocked);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "FrameArena.hpp"
+
+FrameArena::FrameArena()
+{
+    m_buffer = nullptr;
+    m_capacity = 0;
+    m_used = 0;
+    m_requested = 0;
+    m_peak = 0;
+    m_numberOfOverflows = 0;
+}
+
+FrameArena::~FrameArena()
+{
+    reset();
+    releaseBuffer();
+}
+
+void FrameArena::releaseBuffer()
+{
+    if (m_buffer != nullptr)
+        free(m_buffer);
+    m_buffer = nullptr;
+    m_capacity = 0;
+}
+
+bool FrameArena::initialiseArena(const size_t capacity)
+{
+    reset();
+    releaseBuffer();
+
+    m_buffer = (unsigned char *)malloc(capacity);
+    if (m_buffer == nullptr)
+        return false;
+    m_capacity = capacity;
+
+    return true;
+}
+
+void FrameArena::reset()
+{
+    for (void *block : m_overflowBlocks)
+        free(block);
+
+    // Overflowed: grow to the peak, the next frames fit
+    if (!m_overflowBlocks.empty())
+    {
+        m_overflowBlocks.clear();
+        size_t capacity = m_capacity;
+        while (capacity < m_requested)
+            capacity = std::max<size_t>(2 * capacity, 4096);
+        releaseBuffer();
+        m_buffer = (unsigned char *)malloc(capacity);
+        if (m_buffer != nullptr)
+            m_capacity = capacity;
+    }
+
+    m_used = 0;
+    m_requested = 0;
+}
+
+void *FrameArena::allocate(const size_t size, const size_t alignment)
+{
+    const size_t offset = (m_used + alignment - 1) & ~(alignment - 1);
+    m_requested += size + alignment - 1;
+    m_peak = std::max(m_peak, m_requested);
+
+    if (m_buffer != nullptr && offset + size <= m_capacity)
+    {
+        m_used = offset + size;
+        return m_buffer + offset;
+    }
+
+    // Full, from the heap until the reset
+    m_numberOfOverflows++;
+    void *block = malloc(std::max<size_t>(size, 1) + alignment);
+    if (block == nullptr)
+        return nullptr;
+    m_overflowBlocks.push_back(block);
+    return (void *)(((size_t)block + alignment - 1) & ~(alignment - 1));
+}
\ No newline at end of file
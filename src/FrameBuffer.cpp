@@ -0,0 +1,573 @@
+#include <algorithm>
+
+#include "CpuFeatures.hpp"
+#include "FrameBuffer.hpp"
+#include "Toolbox.hpp"
+
+#if defined(RAYCASTING_X86_DISPATCH)
+#include <immintrin.h>
+#endif
+
+FrameBuffer::FrameBuffer()
+{
+    m_width = 0;
+    m_height = 0;
+    m_isColumnMajor = false;
+    m_texture = nullptr;
+    m_drawPixels = nullptr;
+    m_drawWidth = 0;
+    m_upscaleFilter = UpscaleFilter::nearest;
+}
+
+FrameBuffer::~FrameBuffer()
+{
+    SDL_releaseTextures();
+}
+
+bool FrameBuffer::initialiseFrameBuffer(const unsigned int width, const unsigned int height, const bool isColumnMajor)
+{
+    if (width == 0 || height == 0)
+        return false;
+
+    m_width = width;
+    m_height = height;
+    m_isColumnMajor = isColumnMajor;
+    m_pixels.assign(m_width * m_height, packColor(0, 0, 0));
+    if (m_isColumnMajor)
+        m_columnPixels.assign(m_width * m_height, packColor(0, 0, 0));
+    else
+        std::vector<Uint32>().swap(m_columnPixels);
+    m_drawPixels = m_pixels.data();
+    m_drawWidth = m_width;
+    m_upscaleIndices.assign(m_width, 0);
+    m_upscaleWeights.assign(4 * m_width, 0);
+    SDL_releaseTextures();
+
+    return true;
+}
+
+void FrameBuffer::SDL_releaseTextures()
+{
+    if (m_texture != nullptr)
+    {
+        SDL_DestroyTexture(m_texture);
+        m_texture = nullptr;
+    }
+}
+
+bool FrameBuffer::SDL_renderFrameBuffer(SDL_Renderer *renderer)
+{
+    if (m_texture == nullptr)
+    {
+        m_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, m_width, m_height);
+        if (m_texture == nullptr)
+            return false;
+    }
+
+    if (m_isColumnMajor)
+        transposeColumns();
+    upscaleRows();
+    if (SDL_UpdateTexture(m_texture, nullptr, m_pixels.data(), m_width * sizeof(Uint32)) != 0)
+        return false;
+    return SDL_RenderCopy(renderer, m_texture, nullptr, nullptr) == 0;
+}
+
+void FrameBuffer::transposeColumns()
+{
+    if (!m_isColumnMajor)
+        return;
+
+    // Bands of rows are independent: each thread reads a strip of every column, writes whole rows
+    const int numberOfBands = (m_height + TRANSPOSE_BLOCK_SIZE - 1) / TRANSPOSE_BLOCK_SIZE;
+#pragma omp parallel for
+    for (int band = 0; band < numberOfBands; band++)
+        transposeBand(m_columnPixels.data(), m_drawPixels, m_drawWidth, m_height, band * TRANSPOSE_BLOCK_SIZE, std::min((band + 1) * TRANSPOSE_BLOCK_SIZE, m_height));
+}
+
+void FrameBuffer::setDrawWidth(const unsigned int drawWidth)
+{
+    const unsigned int width = std::max(std::min(drawWidth, m_width), std::min(2u, m_width));
+    if (width == m_drawWidth)
+        return;
+
+    m_drawWidth = width;
+    if (!isScaled())
+    {
+        m_drawPixels = m_pixels.data();
+        return;
+    }
+
+    // The scaled rows are allocated the first time only
+    if (m_scaledPixels.size() < m_width * m_height)
+        m_scaledPixels.assign(m_width * m_height, packColor(0, 0, 0));
+    m_drawPixels = m_scaledPixels.data();
+    computeUpscaleTables();
+}
+
+void FrameBuffer::setUpscaleFilter(const UpscaleFilter filter)
+{
+    m_upscaleFilter = filter;
+    if (isScaled())
+        computeUpscaleTables();
+}
+
+void FrameBuffer::computeUpscaleTables()
+{
+    // Pixel centers: frame column x samples the drawn row at (x + 0.5) * drawWidth / width - 0.5,
+    // nearest rounds it, bilinear weights the 2 neighbours (clamped to the row)
+    const double scale = (double)m_drawWidth / m_width;
+    for (unsigned int x = 0; x < m_width; x++)
+    {
+        const double u = (x + 0.5) * scale - 0.5;
+        unsigned int index = std::min((unsigned int)(u + 0.5), m_drawWidth - 1);
+        unsigned int weight = 0;
+        if (m_upscaleFilter == UpscaleFilter::bilinear)
+        {
+            index = (u > 0) ? std::min((unsigned int)u, m_drawWidth - 2) : 0;
+            weight = Math::limitToInterval<double>((u - index) * 256 + 0.5, 0, 256);
+        }
+        m_upscaleIndices[x] = index;
+        for (unsigned int k = 0; k < 4; k++)
+            m_upscaleWeights[4 * x + k] = weight;
+    }
+}
+
+void FrameBuffer::upscaleRows()
+{
+    if (!isScaled())
+        return;
+
+#pragma omp parallel for
+    for (int y = 0; y < (int)m_height; y++)
+        upscaleRow(m_drawPixels + y * m_drawWidth, m_pixels.data() + y * m_width, m_width, m_upscaleIndices.data(), m_upscaleWeights.data(), m_upscaleFilter);
+}
+
+void FrameBuffer::upscaleRow(const Uint32 *source, Uint32 *destination, const unsigned int width, const unsigned int *sourceIndices, const Uint16 *weights, const UpscaleFilter filter)
+{
+    // AVX-512 uses the AVX2 upscale: 8 gathered pixels per iteration already saturate the stores
+    switch (CpuFeatures::getLevel())
+    {
+        case SimdLevel::avx512:
+        case SimdLevel::avx2:
+            upscaleRow_AVX2(source, destination, width, sourceIndices, weights, filter);
+            break;
+        case SimdLevel::sse42:
+            upscaleRow_SSE42(source, destination, width, sourceIndices, weights, filter);
+            break;
+        default:
+            upscaleRow_scalar(source, destination, width, sourceIndices, weights, filter);
+            break;
+    }
+}
+
+void FrameBuffer::upscaleRow_scalar(const Uint32 *source, Uint32 *destination, const unsigned int width, const unsigned int *sourceIndices, const Uint16 *weights, const UpscaleFilter filter)
+{
+    if (filter == UpscaleFilter::nearest)
+    {
+        for (unsigned int x = 0; x < width; x++)
+            destination[x] = source[sourceIndices[x]];
+        return;
+    }
+
+    // Per channel: (left * (256 - weight) + right * weight) / 256, red & blue with one multiply
+    for (unsigned int x = 0; x < width; x++)
+    {
+        const Uint32 left = source[sourceIndices[x]];
+        const Uint32 right = source[sourceIndices[x] + 1];
+        const Uint32 weight = weights[4 * x];
+        const Uint32 blendedRB = (((left & 0x00FF00FF) * (256 - weight) + (right & 0x00FF00FF) * weight) >> 8) & 0x00FF00FF;
+        const Uint32 blendedG = (((left & 0x0000FF00) * (256 - weight) + (right & 0x0000FF00) * weight) >> 8) & 0x0000FF00;
+        destination[x] = 0xFF000000u | blendedRB | blendedG;
+    }
+}
+
+#if defined(RAYCASTING_X86_DISPATCH)
+__attribute__((target("sse4.2")))
+#endif
+void FrameBuffer::upscaleRow_SSE42(const Uint32 *source, Uint32 *destination, const unsigned int width, const unsigned int *sourceIndices, const Uint16 *weights, const UpscaleFilter filter)
+{
+#if defined(RAYCASTING_X86_DISPATCH)
+    // 4 pixels per iteration, the channels weighted as 16 bit lanes (at most 255 * 256)
+    const __m128i alpha = _mm_set1_epi32(0xFF000000);
+    const __m128i one = _mm_set1_epi16(256);
+    unsigned int x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        __m128i left = _mm_cvtsi32_si128(source[sourceIndices[x]]);
+        left = _mm_insert_epi32(left, source[sourceIndices[x + 1]], 1);
+        left = _mm_insert_epi32(left, source[sourceIndices[x + 2]], 2);
+        left = _mm_insert_epi32(left, source[sourceIndices[x + 3]], 3);
+        if (filter == UpscaleFilter::nearest)
+        {
+            _mm_storeu_si128((__m128i *)(destination + x), left);
+            continue;
+        }
+
+        __m128i right = _mm_cvtsi32_si128(source[sourceIndices[x] + 1]);
+        right = _mm_insert_epi32(right, source[sourceIndices[x + 1] + 1], 1);
+        right = _mm_insert_epi32(right, source[sourceIndices[x + 2] + 1], 2);
+        right = _mm_insert_epi32(right, source[sourceIndices[x + 3] + 1], 3);
+        const __m128i weightsLow = _mm_loadu_si128((const __m128i *)(weights + 4 * x));
+        const __m128i weightsHigh = _mm_loadu_si128((const __m128i *)(weights + 4 * x + 8));
+        const __m128i blendedLow = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_cvtepu8_epi16(left), _mm_sub_epi16(one, weightsLow)), _mm_mullo_epi16(_mm_cvtepu8_epi16(right), weightsLow)), 8);
+        const __m128i blendedHigh = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(left, 8)), _mm_sub_epi16(one, weightsHigh)), _mm_mullo_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(right, 8)), weightsHigh)), 8);
+        _mm_storeu_si128((__m128i *)(destination + x), _mm_or_si128(_mm_packus_epi16(blendedLow, blendedHigh), alpha));
+    }
+
+    // Last pixels
+    upscaleRow_scalar(source, destination + x, width - x, sourceIndices + x, weights + 4 * x, filter);
+#else
+    upscaleRow_scalar(source, destination, width, sourceIndices, weights, filter);
+#endif
+}
+
+#if defined(RAYCASTING_X86_DISPATCH)
+__attribute__((target("avx2")))
+#endif
+void FrameBuffer::upscaleRow_AVX2(const Uint32 *source, Uint32 *destination, const unsigned int width, const unsigned int *sourceIndices, const Uint16 *weights, const UpscaleFilter filter)
+{
+#if defined(RAYCASTING_X86_DISPATCH)
+    // 8 pixels per iteration with hardware gathers. The channels are widened per 128 bit half,
+    // so the pack interleaves the halves: permuted back in order
+    const __m256i alpha = _mm256_set1_epi32(0xFF000000);
+    const __m256i one = _mm256_set1_epi16(256);
+    unsigned int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        const __m256i indices = _mm256_loadu_si256((const __m256i *)(sourceIndices + x));
+        const __m256i left = _mm256_i32gather_epi32((const int *)source, indices, 4);
+        if (filter == UpscaleFilter::nearest)
+        {
+            _mm256_storeu_si256((__m256i *)(destination + x), left);
+            continue;
+        }
+
+        const __m256i right = _mm256_i32gather_epi32((const int *)source + 1, indices, 4);
+        const __m256i weightsLow = _mm256_loadu_si256((const __m256i *)(weights + 4 * x));
+        const __m256i weightsHigh = _mm256_loadu_si256((const __m256i *)(weights + 4 * x + 16));
+        const __m256i blendedLow = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(left)), _mm256_sub_epi16(one, weightsLow)),
+                                                                      _mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(right)), weightsLow)), 8);
+        const __m256i blendedHigh = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(left, 1)), _mm256_sub_epi16(one, weightsHigh)),
+                                                                       _mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(right, 1)), weightsHigh)), 8);
+        const __m256i blended = _mm256_permute4x64_epi64(_mm256_packus_epi16(blendedLow, blendedHigh), 0xD8);
+        _mm256_storeu_si256((__m256i *)(destination + x), _mm256_or_si256(blended, alpha));
+    }
+
+    upscaleRow_scalar(source, destination + x, width - x, sourceIndices + x, weights + 4 * x, filter);
+#else
+    upscaleRow_scalar(source, destination, width, sourceIndices, weights, filter);
+#endif
+}
+
+void FrameBuffer::transposeBand(const Uint32 *columns, Uint32 *rows, const unsigned int width, const unsigned int height, const unsigned int firstRow, const unsigned int lastRow)
+{
+    // AVX-512 uses the AVX2 transpose: it is bound by the memory bandwidth, not the width
+    switch (CpuFeatures::getLevel())
+    {
+        case SimdLevel::avx512:
+        case SimdLevel::avx2:
+            transposeBand_AVX2(columns, rows, width, height, firstRow, lastRow);
+            break;
+        case SimdLevel::sse42:
+            transposeBand_SSE42(columns, rows, width, height, firstRow, lastRow);
+            break;
+        default:
+            transposeBand_scalar(columns, rows, width, height, firstRow, lastRow);
+            break;
+    }
+}
+
+void FrameBuffer::transposeBand_scalar(const Uint32 *columns, Uint32 *rows, const unsigned int width, const unsigned int height, const unsigned int firstRow, const unsigned int lastRow)
+{
+    // Block by block along the band, so the block's source columns & destination rows stay in cache
+    for (unsigned int blockX = 0; blockX < width; blockX += TRANSPOSE_BLOCK_SIZE)
+    {
+        const unsigned int lastX = std::min(blockX + TRANSPOSE_BLOCK_SIZE, width);
+        for (unsigned int y = firstRow; y < lastRow; y++)
+            for (unsigned int x = blockX; x < lastX; x++)
+                rows[x + y * width] = columns[y + x * height];
+    }
+}
+
+#if defined(RAYCASTING_X86_DISPATCH)
+__attribute__((target("sse4.2")))
+#endif
+void FrameBuffer::transposeBand_SSE42(const Uint32 *columns, Uint32 *rows, const unsigned int width, const unsigned int height, const unsigned int firstRow, const unsigned int lastRow)
+{
+#if defined(RAYCASTING_X86_DISPATCH)
+    for (unsigned int blockX = 0; blockX < width; blockX += TRANSPOSE_BLOCK_SIZE)
+    {
+        const unsigned int lastX = std::min(blockX + TRANSPOSE_BLOCK_SIZE, width);
+        unsigned int y = firstRow;
+        // 4x4 pixels at a time
+        for (; y + 4 <= lastRow; y += 4)
+        {
+            unsigned int x = blockX;
+            for (; x + 4 <= lastX; x += 4)
+            {
+                const __m128i column0 = _mm_loadu_si128((const __m128i *)(columns + y + x * height));
+                const __m128i column1 = _mm_loadu_si128((const __m128i *)(columns + y + (x + 1) * height));
+                const __m128i column2 = _mm_loadu_si128((const __m128i *)(columns + y + (x + 2) * height));
+                const __m128i column3 = _mm_loadu_si128((const __m128i *)(columns + y + (x + 3) * height));
+                const __m128i low01 = _mm_unpacklo_epi32(column0, column1);
+                const __m128i low23 = _mm_unpacklo_epi32(column2, column3);
+                const __m128i high01 = _mm_unpackhi_epi32(column0, column1);
+                const __m128i high23 = _mm_unpackhi_epi32(column2, column3);
+                _mm_storeu_si128((__m128i *)(rows + x + y * width), _mm_unpacklo_epi64(low01, low23));
+                _mm_storeu_si128((__m128i *)(rows + x + (y + 1) * width), _mm_unpackhi_epi64(low01, low23));
+                _mm_storeu_si128((__m128i *)(rows + x + (y + 2) * width), _mm_unpacklo_epi64(high01, high23));
+                _mm_storeu_si128((__m128i *)(rows + x + (y + 3) * width), _mm_unpackhi_epi64(high01, high23));
+            }
+            for (; x < lastX; x++)
+                for (unsigned int k = 0; k < 4; k++)
+                    rows[x + (y + k) * width] = columns[y + k + x * height];
+        }
+        for (; y < lastRow; y++)
+            for (unsigned int x = blockX; x < lastX; x++)
+                rows[x + y * width] = columns[y + x * height];
+    }
+#else
+    transposeBand_scalar(columns, rows, width, height, firstRow, lastRow);
+#endif
+}
+
+#if defined(RAYCASTING_X86_DISPATCH)
+__attribute__((target("avx2")))
+#endif
+void FrameBuffer::transposeBand_AVX2(const Uint32 *columns, Uint32 *rows, const unsigned int width, const unsigned int height, const unsigned int firstRow, const unsigned int lastRow)
+{
+#if defined(RAYCASTING_X86_DISPATCH)
+    for (unsigned int blockX = 0; blockX < width; blockX += TRANSPOSE_BLOCK_SIZE)
+    {
+        const unsigned int lastX = std::min(blockX + TRANSPOSE_BLOCK_SIZE, width);
+        unsigned int y = firstRow;
+        // 8x8 pixels at a time: 4x4 transposes within the 128 bit halves, then the halves swapped
+        for (; y + 8 <= lastRow; y += 8)
+        {
+            unsigned int x = blockX;
+            for (; x + 8 <= lastX; x += 8)
+            {
+                __m256i column[8];
+                for (unsigned int k = 0; k < 8; k++)
+                    column[k] = _mm256_loadu_si256((const __m256i *)(columns + y + (x + k) * height));
+                const __m256i low01 = _mm256_unpacklo_epi32(column[0], column[1]);
+                const __m256i high01 = _mm256_unpackhi_epi32(column[0], column[1]);
+                const __m256i low23 = _mm256_unpacklo_epi32(column[2], column[3]);
+                const __m256i high23 = _mm256_unpackhi_epi32(column[2], column[3]);
+                const __m256i low45 = _mm256_unpacklo_epi32(column[4], column[5]);
+                const __m256i high45 = _mm256_unpackhi_epi32(column[4], column[5]);
+                const __m256i low67 = _mm256_unpacklo_epi32(column[6], column[7]);
+                const __m256i high67 = _mm256_unpackhi_epi32(column[6], column[7]);
+                const __m256i row04Left = _mm256_unpacklo_epi64(low01, low23);
+                const __m256i row15Left = _mm256_unpackhi_epi64(low01, low23);
+                const __m256i row26Left = _mm256_unpacklo_epi64(high01, high23);
+                const __m256i row37Left = _mm256_unpackhi_epi64(high01, high23);
+                const __m256i row04Right = _mm256_unpacklo_epi64(low45, low67);
+                const __m256i row15Right = _mm256_unpackhi_epi64(low45, low67);
+                const __m256i row26Right = _mm256_unpacklo_epi64(high45, high67);
+                const __m256i row37Right = _mm256_unpackhi_epi64(high45, high67);
+                _mm256_storeu_si256((__m256i *)(rows + x + y * width), _mm256_permute2x128_si256(row04Left, row04Right, 0x20));
+                _mm256_storeu_si256((__m256i *)(rows + x + (y + 1) * width), _mm256_permute2x128_si256(row15Left, row15Right, 0x20));
+                _mm256_storeu_si256((__m256i *)(rows + x + (y + 2) * width), _mm256_permute2x128_si256(row26Left, row26Right, 0x20));
+                _mm256_storeu_si256((__m256i *)(rows + x + (y + 3) * width), _mm256_permute2x128_si256(row37Left, row37Right, 0x20));
+                _mm256_storeu_si256((__m256i *)(rows + x + (y + 4) * width), _mm256_permute2x128_si256(row04Left, row04Right, 0x31));
+                _mm256_storeu_si256((__m256i *)(rows + x + (y + 5) * width), _mm256_permute2x128_si256(row15Left, row15Right, 0x31));
+                _mm256_storeu_si256((__m256i *)(rows + x + (y + 6) * width), _mm256_permute2x128_si256(row26Left, row26Right, 0x31));
+                _mm256_storeu_si256((__m256i *)(rows + x + (y + 7) * width), _mm256_permute2x128_si256(row37Left, row37Right, 0x31));
+            }
+            for (; x < lastX; x++)
+                for (unsigned int k = 0; k < 8; k++)
+                    rows[x + (y + k) * width] = columns[y + k + x * height];
+        }
+        for (; y < lastRow; y++)
+            for (unsigned int x = blockX; x < lastX; x++)
+                rows[x + y * width] = columns[y + x * height];
+    }
+#else
+    transposeBand_scalar(columns, rows, width, height, firstRow, lastRow);
+#endif
+}
+
+void FrameBuffer::fillColumnSolid(Uint32 *destination, const int stride, const int count, const Uint32 color)
+{
+    for (int i = 0; i < count; i++)
+        destination[i * stride] = color;
+}
+
+void FrameBuffer::blendColumnSolid(Uint32 *destination, const int stride, const int count, const Uint32 color, const unsigned int alpha)
+{
+    // Per channel: destination + alpha * (color - destination), two channels per multiply
+    const Uint32 colorRB = color & 0x00FF00FF;
+    const Uint32 colorG = color & 0x0000FF00;
+    for (int i = 0; i < count; i++)
+    {
+        const Uint32 pixel = destination[i * stride];
+        const Uint32 pixelRB = pixel & 0x00FF00FF;
+        const Uint32 pixelG = pixel & 0x0000FF00;
+        const Uint32 blendedRB = (pixelRB + (((colorRB - pixelRB) * alpha) >> 8)) & 0x00FF00FF;
+        const Uint32 blendedG = (pixelG + (((colorG - pixelG) * alpha) >> 8)) & 0x0000FF00;
+        destination[i * stride] = 0xFF000000u | blendedRB | blendedG;
+    }
+}
+
+void FrameBuffer::fillColumnTextured(Uint32 *destination, const int stride, const int count, const Uint32 *textureColumn, const unsigned int textureMask, unsigned int v, const unsigned int vStep, const unsigned int shade)
+{
+    switch (CpuFeatures::getLevel())
+    {
+        case SimdLevel::avx512:
+            fillColumnTextured_AVX512(destination, stride, count, textureColumn, textureMask, v, vStep, shade);
+            break;
+        case SimdLevel::avx2:
+            fillColumnTextured_AVX2(destination, stride, count, textureColumn, textureMask, v, vStep, shade);
+            break;
+        case SimdLevel::sse42:
+            fillColumnTextured_SSE42(destination, stride, count, textureColumn, textureMask, v, vStep, shade);
+            break;
+        default:
+            fillColumnTextured_scalar(destination, stride, count, textureColumn, textureMask, v, vStep, shade);
+            break;
+    }
+}
+
+void FrameBuffer::fillColumnTextured_scalar(Uint32 *destination, const int stride, const int count, const Uint32 *textureColumn, const unsigned int textureMask, unsigned int v, const unsigned int vStep, const unsigned int shade)
+{
+    for (int i = 0; i < count; i++)
+    {
+        // Shade red & blue with one multiply, green with another
+        const Uint32 texel = textureColumn[(v >> 16) & textureMask];
+        const Uint32 shadedRB = (((texel & 0x00FF00FF) * shade) >> 8) & 0x00FF00FF;
+        const Uint32 shadedG = (((texel & 0x0000FF00) * shade) >> 8) & 0x0000FF00;
+        destination[i * stride] = 0xFF000000u | shadedRB | shadedG;
+        v += vStep;
+    }
+}
+
+#if defined(RAYCASTING_X86_DISPATCH)
+__attribute__((target("sse4.2")))
+#endif
+void FrameBuffer::fillColumnTextured_SSE42(Uint32 *destination, const int stride, const int count, const Uint32 *textureColumn, const unsigned int textureMask, unsigned int v, const unsigned int vStep, const unsigned int shade)
+{
+#if defined(RAYCASTING_X86_DISPATCH)
+    // 8 pixels per iteration: texture v of the 8 pixels, gather the texels, shade the
+    // channels as 16 bit lanes (alpha multiplied by 256 stays 255)
+    const __m128i laneOffsets = _mm_set_epi32(3 * vStep, 2 * vStep, vStep, 0);
+    const __m128i mask = _mm_set1_epi32(textureMask);
+    const __m128i shadeFactors = _mm_set_epi16(256, shade, shade, shade, 256, shade, shade, shade);
+    alignas(16) Uint32 indices[8];
+    alignas(16) Uint32 pixels[8];
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i v0 = _mm_add_epi32(_mm_set1_epi32(v), laneOffsets);
+        const __m128i v1 = _mm_add_epi32(v0, _mm_set1_epi32(4 * vStep));
+        _mm_store_si128((__m128i *)indices, _mm_and_si128(_mm_srli_epi32(v0, 16), mask));
+        _mm_store_si128((__m128i *)(indices + 4), _mm_and_si128(_mm_srli_epi32(v1, 16), mask));
+        v += 8 * vStep;
+
+        for (int k = 0; k < 8; k += 4)
+        {
+            __m128i texels = _mm_cvtsi32_si128(textureColumn[indices[k]]);
+            texels = _mm_insert_epi32(texels, textureColumn[indices[k + 1]], 1);
+            texels = _mm_insert_epi32(texels, textureColumn[indices[k + 2]], 2);
+            texels = _mm_insert_epi32(texels, textureColumn[indices[k + 3]], 3);
+            const __m128i shadedLow = _mm_srli_epi16(_mm_mullo_epi16(_mm_cvtepu8_epi16(texels), shadeFactors), 8);
+            const __m128i shadedHigh = _mm_srli_epi16(_mm_mullo_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(texels, 8)), shadeFactors), 8);
+            _mm_store_si128((__m128i *)(pixels + k), _mm_packus_epi16(shadedLow, shadedHigh));
+        }
+
+        if (stride == 1)
+        {
+            _mm_storeu_si128((__m128i *)(destination + i), _mm_load_si128((const __m128i *)pixels));
+            _mm_storeu_si128((__m128i *)(destination + i + 4), _mm_load_si128((const __m128i *)(pixels + 4)));
+        }
+        else
+        {
+            for (int k = 0; k < 8; k++)
+                destination[(i + k) * stride] = pixels[k];
+        }
+    }
+
+    // Last pixels
+    fillColumnTextured_scalar(destination + i * stride, stride, count - i, textureColumn, textureMask, v, vStep, shade);
+#else
+    fillColumnTextured_scalar(destination, stride, count, textureColumn, textureMask, v, vStep, shade);
+#endif
+}
+
+#if defined(RAYCASTING_X86_DISPATCH)
+__attribute__((target("avx2")))
+#endif
+void FrameBuffer::fillColumnTextured_AVX2(Uint32 *destination, const int stride, const int count, const Uint32 *textureColumn, const unsigned int textureMask, unsigned int v, const unsigned int vStep, const unsigned int shade)
+{
+#if defined(RAYCASTING_X86_DISPATCH)
+    // 8 pixels per iteration with a hardware gather, unpack & pack stay within the 128 bit halves
+    const __m256i laneOffsets = _mm256_mullo_epi32(_mm256_set1_epi32(vStep), _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    const __m256i mask = _mm256_set1_epi32(textureMask);
+    const __m256i shadeFactors = _mm256_set_epi16(256, shade, shade, shade, 256, shade, shade, shade, 256, shade, shade, shade, 256, shade, shade, shade);
+    const __m256i zero = _mm256_setzero_si256();
+    alignas(32) Uint32 pixels[8];
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i indices = _mm256_and_si256(_mm256_srli_epi32(_mm256_add_epi32(_mm256_set1_epi32(v), laneOffsets), 16), mask);
+        v += 8 * vStep;
+
+        const __m256i texels = _mm256_i32gather_epi32((const int *)textureColumn, indices, 4);
+        const __m256i shadedLow = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(texels, zero), shadeFactors), 8);
+        const __m256i shadedHigh = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(texels, zero), shadeFactors), 8);
+        const __m256i shaded = _mm256_packus_epi16(shadedLow, shadedHigh);
+
+        if (stride == 1)
+            _mm256_storeu_si256((__m256i *)(destination + i), shaded);
+        else
+        {
+            _mm256_store_si256((__m256i *)pixels, shaded);
+            for (int k = 0; k < 8; k++)
+                destination[(i + k) * stride] = pixels[k];
+        }
+    }
+
+    fillColumnTextured_scalar(destination + i * stride, stride, count - i, textureColumn, textureMask, v, vStep, shade);
+#else
+    fillColumnTextured_scalar(destination, stride, count, textureColumn, textureMask, v, vStep, shade);
+#endif
+}
+
+#if defined(RAYCASTING_X86_DISPATCH)
+__attribute__((target("avx512f,avx512bw,avx512vl")))
+#endif
+void FrameBuffer::fillColumnTextured_AVX512(Uint32 *destination, const int stride, const int count, const Uint32 *textureColumn, const unsigned int textureMask, unsigned int v, const unsigned int vStep, const unsigned int shade)
+{
+#if defined(RAYCASTING_X86_DISPATCH)
+    // 16 pixels per iteration, contiguous columns only (a scatter is no faster than the
+    // scalar stores for a full row stride)
+    if (stride != 1)
+    {
+        fillColumnTextured_AVX2(destination, stride, count, textureColumn, textureMask, v, vStep, shade);
+        return;
+    }
+
+    const __m512i laneOffsets = _mm512_mullo_epi32(_mm512_set1_epi32(vStep), _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+    const __m512i mask = _mm512_set1_epi32(textureMask);
+    const __m512i shadeFactors = _mm512_set1_epi64(((long long)256 << 48) | ((long long)shade << 32) | (shade << 16) | shade);
+    const __m512i zero = _mm512_setzero_si512();
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m512i indices = _mm512_and_si512(_mm512_maskz_srli_epi32(0xFFFF, _mm512_add_epi32(_mm512_set1_epi32(v), laneOffsets), 16), mask);
+        v += 16 * vStep;
+
+        const __m512i texels = _mm512_mask_i32gather_epi32(zero, 0xFFFF, indices, (const int *)textureColumn, 4);
+        const __m512i shadedLow = _mm512_srli_epi16(_mm512_mullo_epi16(_mm512_unpacklo_epi8(texels, zero), shadeFactors), 8);
+        const __m512i shadedHigh = _mm512_srli_epi16(_mm512_mullo_epi16(_mm512_unpackhi_epi8(texels, zero), shadeFactors), 8);
+        _mm512_storeu_si512((void *)(destination + i), _mm512_packus_epi16(shadedLow, shadedHigh));
+    }
+
+    fillColumnTextured_scalar(destination + i, 1, count - i, textureColumn, textureMask, v, vStep, shade);
+#else
+    fillColumnTextured_scalar(destination, stride, count, textureColumn, textureMask, v, vStep, shade);
+#endif
+}
\ No newline at end of file
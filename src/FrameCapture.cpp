@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "FrameCapture.hpp"
+
+FrameCapture::FrameCapture()
+{
+    m_format = CaptureFormat::ppm;
+    m_width = 0;
+    m_height = 0;
+    m_frameHeaderSize = 0;
+    m_acquiredBuffer = -1;
+    m_isRunning = false;
+    m_isStopping = false;
+    m_numberOfCapturedFrames = 0;
+    m_numberOfWrittenFrames = 0;
+    m_numberOfDroppedFrames = 0;
+    m_numberOfWrittenBytes = 0;
+}
+
+FrameCapture::~FrameCapture()
+{
+    stop();
+}
+
+CaptureFormat FrameCapture::getFormatFromPath(const std::string &path)
+{
+    const std::string extension = ".y4m";
+    if (path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0)
+        return CaptureFormat::y4m;
+    return CaptureFormat::ppm;
+}
+
+bool FrameCapture::start(const std::string &path, CaptureFormat format, const unsigned int width, const unsigned int height, const unsigned int frameRate)
+{
+    if (m_isRunning || width == 0 || height == 0)
+        return false;
+
+    m_output.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_output.is_open())
+        return false;
+
+    m_format = format;
+    m_width = width;
+    m_height = height;
+
+    // Frame header, then its pixels (PPM: RGB, Y4M: Y plane, then U & V at half resolution)
+    char header[64];
+    size_t pixelsSize;
+    if (m_format == CaptureFormat::y4m)
+    {
+        char streamHeader[96];
+        const int streamHeaderSize = snprintf(streamHeader, sizeof(streamHeader), "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg\n", m_width, m_height, frameRate);
+        m_output.write(streamHeader, streamHeaderSize);
+        m_numberOfWrittenBytes = streamHeaderSize;
+        m_frameHeaderSize = snprintf(header, sizeof(header), "FRAME\n");
+        pixelsSize = m_width * m_height + 2 * ((m_width + 1) / 2) * ((m_height + 1) / 2);
+    }
+    else
+    {
+        m_numberOfWrittenBytes = 0;
+        m_frameHeaderSize = snprintf(header, sizeof(header), "P6\n%u %u\n255\n", m_width, m_height);
+        pixelsSize = 3 * m_width * m_height;
+    }
+    m_frameBytes.resize(m_frameHeaderSize + pixelsSize);
+    std::copy(header, header + m_frameHeaderSize, m_frameBytes.begin());
+
+    // Buffer pool, all free
+    unsigned int buffer;
+    while (m_filledBuffers.pop(buffer) || m_freeBuffers.pop(buffer));
+    for (unsigned int i = 0; i < NUMBER_OF_BUFFERS; i++)
+    {
+        m_buffers[i].assign(m_width * m_height, 0);
+        m_freeBuffers.push(i);
+    }
+    m_acquiredBuffer = -1;
+
+    m_numberOfCapturedFrames = 0;
+    m_numberOfWrittenFrames = 0;
+    m_numberOfDroppedFrames = 0;
+    m_isStopping = false;
+    m_isRunning = true;
+    m_writer = std::thread(&FrameCapture::writerLoop, this);
+
+    return true;
+}
+
+void FrameCapture::stop()
+{
+    if (!m_isRunning)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+    }
+    m_condition.notify_one();
+    if (m_writer.joinable())
+        m_writer.join();
+
+    m_output.close();
+    m_isRunning = false;
+}
+
+Uint32 *FrameCapture::acquireFrame()
+{
+    if (!m_isRunning)
+        return nullptr;
+
+    if (m_acquiredBuffer < 0)
+    {
+        unsigned int buffer;
+        if (!m_freeBuffers.pop(buffer))
+        {
+            m_numberOfDroppedFrames++;
+            return nullptr;
+        }
+        m_acquiredBuffer = buffer;
+    }
+
+    return m_buffers[m_acquiredBuffer].data();
+}
+
+void FrameCapture::submitFrame()
+{
+    if (m_acquiredBuffer < 0)
+        return;
+
+    // Never full: the queue holds more slots than there are buffers
+    m_filledBuffers.push(m_acquiredBuffer);
+    m_acquiredBuffer = -1;
+    m_numberOfCapturedFrames++;
+
+    // Without the lock: a wake up missed by the writer is caught by its wait timeout
+    m_condition.notify_one();
+}
+
+void FrameCapture::writerLoop()
+{
+    const auto WAIT_TIMEOUT = std::chrono::milliseconds(10);
+
+    while (true)
+    {
+        unsigned int buffer;
+        if (!m_filledBuffers.pop(buffer))
+        {
+            // Stopped once the queue is drained
+            if (m_isStopping)
+                return;
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait_for(lock, WAIT_TIMEOUT, [this] { return !m_filledBuffers.isEmpty() || m_isStopping; });
+            continue;
+        }
+
+        // The buffer is free again once converted, the write itself holds none
+        convertFrame(m_buffers[buffer].data());
+        m_freeBuffers.push(buffer);
+
+        m_output.write((const char *)m_frameBytes.data(), m_frameBytes.size());
+        if (m_output)
+        {
+            m_numberOfWrittenFrames++;
+            m_numberOfWrittenBytes += m_frameBytes.size();
+        }
+        else
+            m_numberOfDroppedFrames++;
+    }
+}
+
+void FrameCapture::convertFrame(const Uint32 *pixels)
+{
+    unsigned char *destination = m_frameBytes.data() + m_frameHeaderSize;
+    if (m_format == CaptureFormat::ppm)
+    {
+        for (unsigned int i = 0; i < m_width * m_height; i++)
+        {
+            destination[3 * i] = (pixels[i] >> 16) & 0xFF;
+            destination[3 * i + 1] = (pixels[i] >> 8) & 0xFF;
+            destination[3 * i + 2] = pixels[i] & 0xFF;
+        }
+        return;
+    }
+
+    // Full range BT.601 (JFIF), 8 bit fixed point. Chroma of the 2x2 blocks' average color,
+    // the last column / row is repeated for odd sizes
+    unsigned char *planeY = destination;
+    const unsigned int chromaWidth = (m_width + 1) / 2;
+    const unsigned int chromaHeight = (m_height + 1) / 2;
+    unsigned char *planeU = planeY + m_width * m_height;
+    unsigned char *planeV = planeU + chromaWidth * chromaHeight;
+    for (unsigned int i = 0; i < m_width * m_height; i++)
+    {
+        const int r = (pixels[i] >> 16) & 0xFF;
+        const int g = (pixels[i] >> 8) & 0xFF;
+        const int b = pixels[i] & 0xFF;
+        planeY[i] = (77 * r + 150 * g + 29 * b + 128) >> 8;
+    }
+
+    for (unsigned int y = 0; y < chromaHeight; y++)
+    {
+        const Uint32 *row0 = pixels + (2 * y) * m_width;
+        const Uint32 *row1 = pixels + std::min(2 * y + 1, m_height - 1) * m_width;
+        for (unsigned int x = 0; x < chromaWidth; x++)
+        {
+            const unsigned int x0 = 2 * x;
+            const unsigned int x1 = std::min(2 * x + 1, m_width - 1);
+            const Uint32 block[4] = { row0[x0], row0[x1], row1[x0], row1[x1] };
+            int r = 0, g = 0, b = 0;
+            for (Uint32 pixel : block)
+            {
+                r += (pixel >> 16) & 0xFF;
+                g += (pixel >> 8) & 0xFF;
+                b += pixel & 0xFF;
+            }
+
+            // Sums of 4 pixels: 10 bit shift, offset to stay positive
+            planeU[y * chromaWidth + x] = std::min(255, (-43 * r - 85 * g + 128 * b + (128 << 10) + 512) >> 10);
+            planeV[y * chromaWidth + x] = std::min(255, (128 * r - 107 * g - 21 * b + (128 << 10) + 512) >> 10);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <thread>
+
+#include "FramePacer.hpp"
+
+FramePacer::FramePacer()
+{
+    m_period = std::chrono::microseconds(0);
+    m_isAnchoredToPresent = false;
+    m_hasDeadline = false;
+    m_isPresentMarked = false;
+    m_isDeadlineMissed = false;
+    m_hasPresentTimePoint = false;
+    m_predictedWork = std::chrono::microseconds(0);
+    m_safetyMargin = std::chrono::microseconds(0);
+    m_backOff = std::chrono::microseconds(0);
+    m_spinMargin = MAX_SPIN_MARGIN;
+    m_workHistory.clear();
+    m_latenessHistory.clear();
+    m_presentJitterHistory.clear();
+    m_overshootHistory.clear();
+    m_numberOfFrames = 0;
+    m_numberOfMissedDeadlines = 0;
+    m_numberOfMissedRefreshes = 0;
+    m_numberOfWaits = 0;
+    m_wakeErrorTotal = std::chrono::microseconds(0);
+    m_spinTimeTotal = std::chrono::microseconds(0);
+}
+
+void FramePacer::setTargetRate(double framesPerSecond)
+{
+    m_period = std::chrono::microseconds((framesPerSecond > 0) ? (long long)(1e6 / framesPerSecond) : 0);
+    m_hasDeadline = false;
+    m_hasPresentTimePoint = false;
+    m_workHistory.clear();
+    m_latenessHistory.clear();
+    m_presentJitterHistory.clear();
+    m_overshootHistory.clear();
+    // Not paced (start at once) until the first frames are measured
+    m_predictedWork = m_period;
+    m_safetyMargin = std::chrono::microseconds(0);
+    m_backOff = std::chrono::microseconds(0);
+    m_spinMargin = MAX_SPIN_MARGIN;
+}
+
+void FramePacer::waitForFrame()
+{
+    m_isPresentMarked = false;
+    if (!isEnabled())
+        return;
+
+    Clock::time_point now = Clock::now();
+    if (!m_hasDeadline)
+    {
+        m_deadline = now + m_period;
+        m_hasDeadline = true;
+    }
+
+    // Latest start that still makes the deadline (already late: start now)
+    const Clock::time_point startTimePoint = m_deadline - m_predictedWork - m_safetyMargin;
+    if (startTimePoint > now)
+    {
+        // Sleep, the spin margin is a quarter above the sleeps' overshoot percentile
+        const Clock::time_point wakeTimePoint = startTimePoint - m_spinMargin;
+        if (wakeTimePoint > now)
+        {
+            std::this_thread::sleep_until(wakeTimePoint);
+            now = Clock::now();
+            m_overshootHistory.add(std::chrono::duration_cast<std::chrono::microseconds>(now - wakeTimePoint));
+            m_spinMargin = std::min(MAX_SPIN_MARGIN, std::max(MIN_SPIN_MARGIN, m_overshootHistory.getPercentile(PERCENTILE) * 5 / 4));
+        }
+
+        // Spin the rest
+        const Clock::time_point spinStartTimePoint = now;
+        while (now < startTimePoint)
+        {
+            std::this_thread::yield();
+            now = Clock::now();
+        }
+        m_spinTimeTotal += std::chrono::duration_cast<std::chrono::microseconds>(now - spinStartTimePoint);
+        m_wakeErrorTotal += std::chrono::duration_cast<std::chrono::microseconds>(now - startTimePoint);
+        m_numberOfWaits++;
+
+        // Start lateness: the wake up & the spin's last yield (the frame had no part in it)
+        m_latenessHistory.add(std::chrono::duration_cast<std::chrono::microseconds>(now - startTimePoint));
+    }
+
+    m_frameStartTimePoint = now;
+}
+
+void FramePacer::markPresent()
+{
+    if (!isEnabled())
+        return;
+
+    const Clock::time_point now = Clock::now();
+    m_workHistory.add(std::chrono::duration_cast<std::chrono::microseconds>(now - m_frameStartTimePoint));
+    m_isDeadlineMissed = (now > m_deadline);
+    if (m_isDeadlineMissed)
+        m_numberOfMissedDeadlines++;
+    m_numberOfFrames++;
+    m_isPresentMarked = true;
+}
+
+void FramePacer::endFrame()
+{
+    if (!isEnabled())
+        return;
+
+    // Vsync: the present returned at the swap, the next one is a period later. Returns more than
+    // half a period off the next refresh are misses, the others' offsets are the present jitter
+    const Clock::time_point now = Clock::now();
+    bool isMissed = m_isPresentMarked && m_isDeadlineMissed;
+    if (m_isAnchoredToPresent && m_isPresentMarked)
+    {
+        if (m_hasPresentTimePoint)
+        {
+            const std::chrono::microseconds interval = std::chrono::duration_cast<std::chrono::microseconds>(now - m_presentTimePoint);
+            if (interval > m_period * 3 / 2)
+            {
+                m_numberOfMissedRefreshes++;
+                isMissed = true;
+            }
+            else
+                m_presentJitterHistory.add((interval > m_period) ? interval - m_period : m_period - interval);
+        }
+        m_presentTimePoint = now;
+        m_hasPresentTimePoint = true;
+    }
+
+    // Missed: start earlier for a while, else relax back to the measured margins
+    if (isMissed)
+        m_backOff = std::min(m_period, m_backOff + m_period / 4);
+    else
+        m_backOff -= m_backOff / BACK_OFF_DECAY;
+    updateMargins();
+
+    if (m_isAnchoredToPresent && m_isPresentMarked)
+    {
+        m_deadline = now + m_period;
+        return;
+    }
+
+    // Free running (or no present): next slot, do not try to catch up after a stall
+    m_deadline += m_period;
+    if (m_deadline <= now)
+        m_deadline = now + m_period;
+}
+
+void FramePacer::updateMargins()
+{
+    // Start values until the frames' work is measured, the lateness comes with the first waits
+    if (m_workHistory.count < MIN_SAMPLES)
+        return;
+    m_predictedWork = m_workHistory.getPercentile(PERCENTILE);
+    m_safetyMargin = std::max(MIN_SAFETY_MARGIN, m_latenessHistory.getPercentile(PERCENTILE) + m_presentJitterHistory.getPercentile(PERCENTILE)) + m_backOff;
+}
+
+void FramePacer::History::clear()
+{
+    count = 0;
+    next = 0;
+}
+
+void FramePacer::History::add(const std::chrono::microseconds sample)
+{
+    samples[next] = sample.count();
+    next = (next + 1) % HISTORY_SIZE;
+    count = std::min(count + 1, HISTORY_SIZE);
+}
+
+std::chrono::microseconds FramePacer::History::getPercentile(const unsigned int percent) const
+{
+    if (count == 0)
+        return std::chrono::microseconds(0);
+
+    long long sorted[HISTORY_SIZE];
+    std::copy(samples, samples + count, sorted);
+    const unsigned int index = std::min(count - 1, count * percent / 100);
+    std::nth_element(sorted, sorted + index, sorted + count);
+    return std::chrono::microseconds(sorted[index]);
+}
\ No newline at end of file
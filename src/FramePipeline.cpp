@@ -0,0 +1,122 @@
+#include "AllocationCounter.hpp"
+#include "FramePipeline.hpp"
+
+FramePipeline::FramePipeline()
+{
+    m_mapManager = nullptr;
+    m_depth = 1;
+    m_hasSample = false;
+    m_castCount = 0;
+    m_presentCount = 0;
+    m_isRunning = false;
+}
+
+FramePipeline::~FramePipeline()
+{
+    stop();
+}
+
+bool FramePipeline::start(unsigned int depth, unsigned int numberOfRays, MapManager &mapManager)
+{
+    if (depth < 2 || depth > MAX_DEPTH)
+        return false;
+
+    m_mapManager = &mapManager;
+    m_depth = depth;
+    for (unsigned int i = 0; i < m_depth; i++)
+        m_raycasters[i].initialiseRaycaster(numberOfRays);
+
+    m_castCount = 0;
+    m_presentCount = 0;
+    m_isRunning = true;
+    m_worker = std::thread(&FramePipeline::workerLoop, this);
+
+    return true;
+}
+
+void FramePipeline::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isRunning = false;
+    }
+    m_condition.notify_all();
+
+    if (m_worker.joinable())
+        m_worker.join();
+}
+
+void FramePipeline::setAdaptiveStride(unsigned int stride)
+{
+    for (unsigned int i = 0; i < MAX_DEPTH; i++)
+        m_raycasters[i].setAdaptiveStride(stride);
+}
+
+void FramePipeline::setTemporal(bool isTemporal)
+{
+    for (unsigned int i = 0; i < MAX_DEPTH; i++)
+        m_raycasters[i].setTemporal(isTemporal);
+}
+
+void FramePipeline::submitSample(const FrameSample &sample)
+{
+    m_latestSample.publish(sample);
+    if (!m_hasSample)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_hasSample = true;
+        }
+        m_condition.notify_all();
+    }
+}
+
+bool FramePipeline::acquireFrame()
+{
+    // Wait for the oldest frame in flight to be cast
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this] { return m_castCount > m_presentCount || !m_isRunning; });
+
+    return m_castCount > m_presentCount;
+}
+
+void FramePipeline::releaseFrame()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_presentCount++;
+    }
+    m_condition.notify_all();
+}
+
+void FramePipeline::workerLoop()
+{
+    AllocationScope scope(AllocationSubsystem::casting);
+    while (true)
+    {
+        // Wait for a free slot
+        unsigned int slot;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return (m_hasSample && m_castCount - m_presentCount < m_depth) || !m_isRunning; });
+            if (!m_isRunning)
+                return;
+            slot = m_castCount % m_depth;
+        }
+
+        // Cast from the latest sample
+        m_samples[slot] = m_latestSample.read();
+        m_players[slot].setState(m_samples[slot].state);
+        m_raycasters[slot].setNumberOfRays(m_samples[slot].numberOfRays);
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mapManager->getCellsMutex());
+            m_raycasters[slot].calculateRays_OMP(m_players[slot], *m_mapManager, m_samples[slot].fov);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_castCount++;
+        }
+        m_condition.notify_all();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "GeometryBatch.hpp"
+
+GeometryBatch::GeometryBatch()
+{
+    m_capacity = 0;
+    m_numberOfQuads = 0;
+    m_numberOfSubmittedQuads = 0;
+    m_numberOfDrawCalls = 0;
+    m_texture = nullptr;
+    m_textureWidth = 1;
+    m_textureHeight = 1;
+}
+
+GeometryBatch::~GeometryBatch()
+{
+    SDL_releaseTextures();
+}
+
+bool GeometryBatch::SDL_loadTexture(SDL_Renderer *renderer, const std::vector<SDL_Color> &texture, const unsigned int textureSize)
+{
+    SDL_releaseTextures();
+
+    // Texture rows, then the white row
+    std::vector<Uint32> pixels(textureSize * (textureSize + 1), 0xFFFFFFFF);
+    for (unsigned int i = 0; i < textureSize * textureSize; i++)
+        pixels[i] = (texture[i].a << 24) | (texture[i].r << 16) | (texture[i].g << 8) | texture[i].b;
+
+    m_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, textureSize, textureSize + 1);
+    if (m_texture == nullptr)
+        return false;
+    if (SDL_UpdateTexture(m_texture, nullptr, pixels.data(), textureSize * sizeof(Uint32)) != 0)
+    {
+        SDL_releaseTextures();
+        return false;
+    }
+    SDL_SetTextureBlendMode(m_texture, SDL_BLENDMODE_BLEND);
+    m_textureWidth = textureSize;
+    m_textureHeight = textureSize + 1;
+
+    return true;
+}
+
+void GeometryBatch::SDL_releaseTextures()
+{
+    if (m_texture != nullptr)
+        SDL_DestroyTexture(m_texture);
+    m_texture = nullptr;
+}
+
+void GeometryBatch::clear()
+{
+    m_numberOfQuads = 0;
+    m_numberOfSubmittedQuads = 0;
+    m_numberOfDrawCalls = 0;
+}
+
+void GeometryBatch::reserve(const unsigned int numberOfQuads)
+{
+    if (numberOfQuads <= m_capacity)
+        return;
+
+    // Indices are the same for every quad (relative to the first submitted vertex): built once
+    m_vertices.resize(4 * numberOfQuads);
+    m_indices.resize(6 * numberOfQuads);
+    for (unsigned int i = m_capacity; i < numberOfQuads; i++)
+    {
+        m_indices[6 * i] = 4 * i;
+        m_indices[6 * i + 1] = 4 * i + 1;
+        m_indices[6 * i + 2] = 4 * i + 2;
+        m_indices[6 * i + 3] = 4 * i + 2;
+        m_indices[6 * i + 4] = 4 * i + 1;
+        m_indices[6 * i + 5] = 4 * i + 3;
+    }
+    m_capacity = numberOfQuads;
+}
+
+void GeometryBatch::addQuad(const float x0, const float y0, const float x1, const float y1, const SDL_Color topColor, const SDL_Color bottomColor, const float u, const float v0, const float v1)
+{
+    if (m_numberOfQuads == m_capacity)
+        reserve(2 * m_capacity + 16);
+
+    const SDL_FPoint textureTop = { u / m_textureWidth, v0 / m_textureHeight };
+    const SDL_FPoint textureBottom = { u / m_textureWidth, v1 / m_textureHeight };
+    SDL_Vertex *vertices = m_vertices.data() + 4 * m_numberOfQuads;
+    vertices[0] = { { x0, y0 }, topColor, textureTop };
+    vertices[1] = { { x1, y0 }, topColor, textureTop };
+    vertices[2] = { { x0, y1 }, bottomColor, textureBottom };
+    vertices[3] = { { x1, y1 }, bottomColor, textureBottom };
+    m_numberOfQuads++;
+}
+
+void GeometryBatch::addSolidQuad(const float x0, const float y0, const float x1, const float y1, const SDL_Color topColor, const SDL_Color bottomColor)
+{
+    // Center of the white row
+    addQuad(x0, y0, x1, y1, topColor, bottomColor, 0.5f, m_textureHeight - 0.5f, m_textureHeight - 0.5f);
+}
+
+bool GeometryBatch::SDL_submit(SDL_Renderer *renderer, const bool isTextured)
+{
+    const unsigned int numberOfQuads = m_numberOfQuads - m_numberOfSubmittedQuads;
+    if (numberOfQuads == 0)
+        return true;
+
+    const SDL_Vertex *vertices = m_vertices.data() + 4 * m_numberOfSubmittedQuads;
+    m_numberOfSubmittedQuads = m_numberOfQuads;
+    m_numberOfDrawCalls++;
+    return SDL_RenderGeometry(renderer, isTextured ? m_texture : nullptr, vertices, 4 * numberOfQuads, m_indices.data(), 6 * numberOfQuads) == 0;
+}
\ No newline at end of file
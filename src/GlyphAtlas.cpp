@@ -0,0 +1,124 @@
+#include <algorithm>
+
+#include "GlyphAtlas.hpp"
+
+GlyphAtlas::GlyphAtlas()
+{
+    m_texture = nullptr;
+    m_glyphHeight = 0;
+    for (int i = 0; i < NUMBER_OF_GLYPHS; i++)
+        m_glyphs[i] = { 0, 0, 0, 0 };
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+    SDL_releaseTextures();
+}
+
+void GlyphAtlas::SDL_releaseTextures()
+{
+    if (m_texture != nullptr)
+        SDL_DestroyTexture(m_texture);
+    m_texture = nullptr;
+}
+
+bool GlyphAtlas::SDL_loadFont(SDL_Renderer *renderer, TTF_Font *font, const SDL_Color color)
+{
+    SDL_Rect glyphs[NUMBER_OF_GLYPHS];
+    int glyphHeight = 0;
+    SDL_Surface *atlas = rasteriseFont(font, color, glyphs, glyphHeight);
+    if (atlas == nullptr)
+    {
+        SDL_releaseTextures();
+        return false;
+    }
+
+    // 32 bits per pixel: rows are not padded
+    const bool isLoaded = SDL_loadAtlas(renderer, (const Uint32 *)atlas->pixels, atlas->w, atlas->h, glyphs, glyphHeight);
+    SDL_FreeSurface(atlas);
+
+    return isLoaded;
+}
+
+bool GlyphAtlas::SDL_loadAtlas(SDL_Renderer *renderer, const Uint32 *pixels, const int width, const int height, const SDL_Rect *glyphs, const int glyphHeight)
+{
+    SDL_releaseTextures();
+
+    m_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, width, height);
+    if (m_texture == nullptr)
+        return false;
+    if (SDL_UpdateTexture(m_texture, nullptr, pixels, width * sizeof(Uint32)) != 0)
+    {
+        SDL_releaseTextures();
+        return false;
+    }
+    SDL_SetTextureBlendMode(m_texture, SDL_BLENDMODE_BLEND);
+
+    for (int i = 0; i < NUMBER_OF_GLYPHS; i++)
+        m_glyphs[i] = glyphs[i];
+    m_glyphHeight = glyphHeight;
+
+    return true;
+}
+
+SDL_Surface *GlyphAtlas::rasteriseFont(TTF_Font *font, const SDL_Color color, SDL_Rect *glyphs, int &glyphHeight)
+{
+    if (font == nullptr)
+        return nullptr;
+
+    // Glyphs one by one (no kerning), in cells of the widest glyph
+    SDL_Surface *glyphSurfaces[NUMBER_OF_GLYPHS] = { nullptr };
+    int cellWidth = 1;
+    glyphHeight = TTF_FontHeight(font);
+    for (int i = 0; i < NUMBER_OF_GLYPHS; i++)
+    {
+        const char glyph[2] = { (char)(FIRST_GLYPH + i), '\0' };
+        glyphSurfaces[i] = TTF_RenderText_Solid(font, glyph, color);
+        glyphs[i] = { 0, 0, 0, 0 };
+        if (glyphSurfaces[i] == nullptr)
+            continue;
+        cellWidth = std::max(cellWidth, glyphSurfaces[i]->w);
+        glyphHeight = std::max(glyphHeight, glyphSurfaces[i]->h);
+    }
+
+    const int numberOfRows = (NUMBER_OF_GLYPHS + GLYPHS_PER_ROW - 1) / GLYPHS_PER_ROW;
+    SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(0, GLYPHS_PER_ROW * cellWidth, numberOfRows * std::max(1, glyphHeight), 32, SDL_PIXELFORMAT_ARGB8888);
+    if (atlas != nullptr)
+    {
+        // Transparent between the glyphs: copied as is, not blended
+        SDL_FillRect(atlas, nullptr, 0);
+        for (int i = 0; i < NUMBER_OF_GLYPHS; i++)
+        {
+            if (glyphSurfaces[i] == nullptr)
+                continue;
+            glyphs[i] = { (i % GLYPHS_PER_ROW) * cellWidth, (i / GLYPHS_PER_ROW) * glyphHeight, glyphSurfaces[i]->w, glyphSurfaces[i]->h };
+            SDL_Rect destination = glyphs[i];
+            SDL_SetSurfaceBlendMode(glyphSurfaces[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(glyphSurfaces[i], nullptr, atlas, &destination);
+        }
+    }
+
+    for (int i = 0; i < NUMBER_OF_GLYPHS; i++)
+        SDL_FreeSurface(glyphSurfaces[i]);
+
+    return atlas;
+}
+
+int GlyphAtlas::SDL_renderText(SDL_Renderer *renderer, const char *text, const int x, const int y)
+{
+    if (m_texture == nullptr)
+        return 0;
+
+    int penX = x;
+    for (const char *character = text; *character != '\0'; character++)
+    {
+        if (*character < FIRST_GLYPH || *character > LAST_GLYPH)
+            continue;
+        const SDL_Rect &source = m_glyphs[*character - FIRST_GLYPH];
+        SDL_Rect destination = { penX, y, source.w, source.h };
+        SDL_RenderCopy(renderer, m_texture, &source, &destination);
+        penX += source.w;
+    }
+
+    return penX - x;
+}
\ No newline at end of file
@@ -0,0 +1,330 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "CpuFeatures.hpp"
+#include "GoldenImages.hpp"
+#include "Toolbox.hpp"
+
+namespace
+{
+    const char *KERNEL_NAMES[] = { "basic", "corrected", "omp", "spans", "adaptive", "temporal" };
+    // Kernels whose frames are compared: single & multi-hit
+    const unsigned int FRAME_KERNELS[] = { 2, 3 };
+
+    // '.' free, '#' white, 'R' red, 'G' green, 'B' blue, 'T' texture, 'D' door, 'h' half-height,
+    // 'H' double-height, 'g' grate
+    const char *WALLED_MAP =
+        "################"
+        "#......#.......#"
+        "#..R...D...gg..#"
+        "#......#.......#"
+        "####.###..h....#"
+        "#.........h..T.#"
+        "#..G...........#"
+        "#.....BB..H....#"
+        "#.....B........#"
+        "#..........hh..#"
+        "#T.............#"
+        "################";
+
+    // No border walls: rays leave through the map's sentinel ring
+    const char *OPEN_MAP =
+        "............"
+        "..B.....R..."
+        "............"
+        "....##......"
+        "....#...g..."
+        "............"
+        ".T.......H.."
+        "......G....."
+        "............"
+        "............";
+}
+
+GoldenImages::GoldenImages()
+{
+    m_tolerances = GoldenTolerances { 1e-6, 0, 0, 0 };
+    m_isUpdate = false;
+    m_numberOfFailures = 0;
+}
+
+MapManager *GoldenImages::createMap(const unsigned int width, const unsigned int height, const char *rows)
+{
+    const char SYMBOLS[] = ".#RGBTDhHg";
+    std::vector<char> cells(width * height);
+    for (unsigned int cell = 0; cell < width * height; cell++)
+        for (char element = 0; element < (char)(sizeof(SYMBOLS) - 1); element++)
+            if (rows[cell] == SYMBOLS[(int)element])
+                cells[cell] = element;
+
+    return new MapManager(width, height, cells.data());
+}
+
+bool GoldenImages::run(const std::string &directory)
+{
+    MapManager defaultMapManager;
+    MapManager *walledMapManager = createMap(16, 12, WALLED_MAP);
+    MapManager *openMapManager = createMap(12, 10, OPEN_MAP);
+    const double DEGREE = Math::DEGREE_TO_RADIAN;
+    const Scene SCENES[] =
+    {
+        { "default_0", &defaultMapManager, { 16.5, 16.5, 30 * DEGREE, 0 } },
+        { "default_1", &defaultMapManager, { 2.5, 2.5, -45 * DEGREE, 0 } },
+        { "default_2", &defaultMapManager, { 10.2, 20.7, 100 * DEGREE, 0 } },
+        { "default_3", &defaultMapManager, { 28.5, 28.5, 135 * DEGREE, 0 } },
+        { "walled_0", walledMapManager, { 2.5, 2.5, 0, 0 } },
+        { "walled_1", walledMapManager, { 8.5, 6.5, 200 * DEGREE, 0 } },
+        { "walled_2", walledMapManager, { 13.5, 9.5, 120 * DEGREE, 0 } },
+        { "walled_3", walledMapManager, { 4.5, 8.5, 60 * DEGREE, 0 } },
+        { "open_0", openMapManager, { 6.5, 5.5, 10 * DEGREE, 0 } },
+        { "open_1", openMapManager, { 0.5, 0.5, -30 * DEGREE, 0 } },
+        { "open_2", openMapManager, { 11.3, 9.6, 160 * DEGREE, 0 } },
+        { "open_3", openMapManager, { 3.5, 8.5, 270 * DEGREE, 0 } }
+    };
+
+    m_raycaster.initialiseRaycaster(FRAME_WIDTH);
+    m_temporalRaycaster.initialiseRaycaster(FRAME_WIDTH);
+    m_frameBuffer.initialiseFrameBuffer(FRAME_WIDTH, FRAME_HEIGHT);
+    m_columnMajorFrameBuffer.initialiseFrameBuffer(FRAME_WIDTH, FRAME_HEIGHT, true);
+    m_numberOfFailures = 0;
+
+    unsigned int numberOfFailedScenes = 0;
+    for (const Scene &scene : SCENES)
+        if (!runScene(directory, scene))
+            numberOfFailedScenes++;
+
+    delete walledMapManager;
+    delete openMapManager;
+
+    const unsigned int numberOfScenes = sizeof(SCENES) / sizeof(Scene);
+    if (m_isUpdate)
+        std::cout << "golden: " << numberOfScenes << " scenes written to " << directory << std::endl;
+    std::cout << "golden: " << numberOfScenes - numberOfFailedScenes << "/" << numberOfScenes << " scenes passed, " << m_numberOfFailures << " failures (ray tolerance " << m_tolerances.ray << " cells, "
+              << m_tolerances.rayMismatches << " rays; pixel tolerance " << m_tolerances.pixel << " levels, " << 100 * m_tolerances.pixelMismatchRatio << "% pixels)" << std::endl;
+
+    return numberOfFailedScenes == 0;
+}
+
+void GoldenImages::castRays(const unsigned int kernel, const Scene &scene)
+{
+    MapManager &mapManager = *scene.mapManager;
+    m_player.setState(scene.pose);
+    if (kernel == 0)
+        m_raycaster.calculateRaysDistance(m_player, mapManager);
+    else if (kernel == 1)
+        m_raycaster.calculateRaysDistance_fishEyeAndRayDistributionCorrected(m_player, mapManager);
+    else if (kernel == 2)
+        m_raycaster.calculateRaysDistance_OMP(m_player, mapManager);
+    else if (kernel == 3)
+        m_raycaster.calculateRaysSpans_OMP(m_player, mapManager);
+    else if (kernel == 4)
+        m_raycaster.calculateRaysAdaptive_OMP(m_player, mapManager, 90, 8);
+    else
+    {
+        // From a previous frame 2 degrees away (the spans kernel drops the history)
+        PlayerState previousPose = scene.pose;
+        previousPose.angle -= 2 * Math::DEGREE_TO_RADIAN;
+        m_player.setState(previousPose);
+        m_temporalRaycaster.calculateRaysSpans_OMP(m_player, mapManager);
+        m_temporalRaycaster.calculateRaysTemporal_OMP(m_player, mapManager);
+        m_player.setState(scene.pose);
+        m_temporalRaycaster.calculateRaysTemporal_OMP(m_player, mapManager);
+    }
+}
+
+bool GoldenImages::runScene(const std::string &directory, const Scene &scene)
+{
+    const unsigned int numberOfFailures = m_numberOfFailures;
+    const std::string prefix = directory + "/" + scene.name;
+
+    // Rays of every kernel, one line per ray
+    std::ostringstream rays;
+    rays << "# " << scene.name << ": kernel ray distance x y" << std::endl;
+    for (unsigned int kernel = 0; kernel < NUMBER_OF_KERNELS; kernel++)
+    {
+        castRays(kernel, scene);
+        const Raycaster &raycaster = (kernel == 5) ? m_temporalRaycaster : m_raycaster;
+        for (unsigned int i = 0; i < raycaster.getNumberOfRays(); i++)
+        {
+            char line[128];
+            snprintf(line, sizeof(line), "%s %u %.9g %.9g %.9g\n", KERNEL_NAMES[kernel], i, raycaster.getRaysDistance()[i], raycaster.getRaysX()[i], raycaster.getRaysY()[i]);
+            rays << line;
+        }
+    }
+    if (m_isUpdate)
+    {
+        std::ofstream output(prefix + ".rays");
+        output << rays.str();
+    }
+    if (!compareRays(prefix + ".rays", rays.str()))
+        m_numberOfFailures++;
+
+    // Frames, at every SIMD level, row & column-major
+    const SimdLevel selectedLevel = CpuFeatures::getLevel();
+    for (unsigned int kernel : FRAME_KERNELS)
+    {
+        castRays(kernel, scene);
+        const std::string path = prefix + "_" + KERNEL_NAMES[kernel] + ".ppm";
+        for (SimdLevel level = SimdLevel::scalar; level <= CpuFeatures::getSupportedLevel(); level = (SimdLevel)((int)level + 1))
+        {
+            CpuFeatures::setLevel(level);
+            for (FrameBuffer *frameBuffer : { &m_frameBuffer, &m_columnMajorFrameBuffer })
+            {
+                m_raycaster.renderRaycastFrameBuffer(*frameBuffer, 0, 0);
+                if (frameBuffer->isColumnMajor())
+                    frameBuffer->transposeColumns();
+                std::vector<Uint32> pixels(frameBuffer->getPixels(), frameBuffer->getPixels() + FRAME_WIDTH * FRAME_HEIGHT);
+
+                if (m_isUpdate && level == SimdLevel::scalar && !frameBuffer->isColumnMajor())
+                    writePPM(path, pixels.data(), FRAME_WIDTH, FRAME_HEIGHT);
+                if (!compareFrame(path, pixels))
+                {
+                    std::cout << "golden: " << path << " differs at level " << CpuFeatures::getLevelName(level) << (frameBuffer->isColumnMajor() ? ", column-major" : "") << std::endl;
+                    m_numberOfFailures++;
+                }
+            }
+        }
+    }
+    CpuFeatures::setLevel(selectedLevel);
+
+    return m_numberOfFailures == numberOfFailures;
+}
+
+bool GoldenImages::compareRays(const std::string &path, const std::string &rays)
+{
+    std::ifstream input(path);
+    if (!input.is_open())
+    {
+        std::cout << "golden: " << path << " missing (--update-golden writes it)" << std::endl;
+        return false;
+    }
+
+    // Same lines, values within tolerance (infinite: both)
+    std::istringstream actual(rays);
+    std::string goldenLine;
+    std::string actualLine;
+    unsigned int numberOfMismatches[NUMBER_OF_KERNELS] = { 0 };
+    bool isSuccess = true;
+    while (std::getline(actual, actualLine))
+    {
+        if (!std::getline(input, goldenLine))
+        {
+            std::cout << "golden: " << path << " has fewer rays" << std::endl;
+            return false;
+        }
+        if (actualLine[0] == '#')
+            continue;
+
+        char goldenKernel[16], actualKernel[16];
+        unsigned int goldenRay, actualRay;
+        double golden[3], values[3];
+        if (sscanf(goldenLine.c_str(), "%15s %u %lf %lf %lf", goldenKernel, &goldenRay, &golden[0], &golden[1], &golden[2]) != 5
+         || sscanf(actualLine.c_str(), "%15s %u %lf %lf %lf", actualKernel, &actualRay, &values[0], &values[1], &values[2]) != 5
+         || std::string(goldenKernel) != actualKernel || goldenRay != actualRay)
+        {
+            std::cout << "golden: " << path << " does not match the scene (" << goldenLine << ")" << std::endl;
+            return false;
+        }
+
+        unsigned int kernel = 0;
+        while (kernel < NUMBER_OF_KERNELS && std::string(KERNEL_NAMES[kernel]) != actualKernel)
+            kernel++;
+        for (unsigned int j = 0; j < 3; j++)
+        {
+            const bool isMismatch = (std::isinf(golden[j]) || std::isinf(values[j])) ? golden[j] != values[j] : !(std::fabs(golden[j] - values[j]) <= m_tolerances.ray);
+            if (!isMismatch)
+                continue;
+            if (numberOfMismatches[kernel]++ == m_tolerances.rayMismatches)
+            {
+                std::cout << "golden: " << path << ": " << actualKernel << " ray " << actualRay << " is " << values[0] << " (" << values[1] << ", " << values[2] << "), golden "
+                          << golden[0] << " (" << golden[1] << ", " << golden[2] << ")" << std::endl;
+                isSuccess = false;
+            }
+            break;
+        }
+    }
+
+    if (!isSuccess)
+    {
+        std::ofstream output(path.substr(0, path.size() - 5) + ".actual.rays");
+        output << rays;
+    }
+    return isSuccess;
+}
+
+bool GoldenImages::compareFrame(const std::string &path, const std::vector<Uint32> &pixels)
+{
+    std::vector<Uint32> golden;
+    unsigned int width, height;
+    if (!readPPM(path, golden, width, height))
+    {
+        std::cout << "golden: " << path << " missing (--update-golden writes it)" << std::endl;
+        return false;
+    }
+    if (width != FRAME_WIDTH || height != FRAME_HEIGHT)
+    {
+        std::cout << "golden: " << path << " is " << width << "x" << height << std::endl;
+        return false;
+    }
+
+    // Differing pixels in red over the darkened golden frame
+    std::vector<Uint32> diff(pixels.size());
+    unsigned int numberOfMismatches = 0;
+    for (unsigned int i = 0; i < pixels.size(); i++)
+    {
+        bool isMismatch = false;
+        for (int shift = 0; shift < 24; shift += 8)
+            isMismatch |= (unsigned int)std::abs((int)((pixels[i] >> shift) & 0xFF) - (int)((golden[i] >> shift) & 0xFF)) > m_tolerances.pixel;
+
+        const Uint8 gray = (((golden[i] >> 16) & 0xFF) + ((golden[i] >> 8) & 0xFF) + (golden[i] & 0xFF)) / 9;
+        diff[i] = isMismatch ? FrameBuffer::packColor(255, 0, 0) : FrameBuffer::packColor(gray, gray, gray);
+        numberOfMismatches += isMismatch;
+    }
+    if (numberOfMismatches <= m_tolerances.pixelMismatchRatio * pixels.size())
+        return true;
+
+    const std::string prefix = path.substr(0, path.size() - 4);
+    writePPM(prefix + ".actual.ppm", pixels.data(), FRAME_WIDTH, FRAME_HEIGHT);
+    writePPM(prefix + ".diff.ppm", diff.data(), FRAME_WIDTH, FRAME_HEIGHT);
+    std::cout << "golden: " << path << ": " << numberOfMismatches << " pixels differ, see " << prefix << ".diff.ppm" << std::endl;
+    return false;
+}
+
+bool GoldenImages::writePPM(const std::string &path, const Uint32 *pixels, const unsigned int width, const unsigned int height)
+{
+    std::ofstream output(path, std::ios::binary);
+    if (!output.is_open())
+        return false;
+
+    output << "P6\n" << width << " " << height << "\n255\n";
+    std::vector<unsigned char> bytes(3 * width * height);
+    for (unsigned int i = 0; i < width * height; i++)
+    {
+        bytes[3 * i] = (pixels[i] >> 16) & 0xFF;
+        bytes[3 * i + 1] = (pixels[i] >> 8) & 0xFF;
+        bytes[3 * i + 2] = pixels[i] & 0xFF;
+    }
+    output.write((const char *)bytes.data(), bytes.size());
+    return (bool)output;
+}
+
+bool GoldenImages::readPPM(const std::string &path, std::vector<Uint32> &pixels, unsigned int &width, unsigned int &height)
+{
+    std::ifstream input(path, std::ios::binary);
+    std::string magic;
+    unsigned int maximum;
+    if (!(input >> magic >> width >> height >> maximum) || magic != "P6" || maximum != 255)
+        return false;
+    input.get();
+
+    std::vector<unsigned char> bytes(3 * width * height);
+    if (!input.read((char *)bytes.data(), bytes.size()))
+        return false;
+    pixels.resize(width * height);
+    for (unsigned int i = 0; i < width * height; i++)
+        pixels[i] = FrameBuffer::packColor(bytes[3 * i], bytes[3 * i + 1], bytes[3 * i + 2]);
+    return true;
+}
\ No newline at end of file
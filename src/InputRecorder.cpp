@@ -0,0 +1,271 @@
+#include <iostream>
+
+#include "InputRecorder.hpp"
+#include "SDL.h"
+
+InputRecorder::InputRecorder()
+{
+    m_frameEventIndex = 0;
+    m_frameCount = 0;
+    m_isRecording = false;
+    m_isReplaying = false;
+    m_seed = 0;
+    m_screenWidth = 0;
+    m_screenHeight = 0;
+    m_hasSpecialWalls = false;
+}
+
+InputRecorder::~InputRecorder()
+{
+    close();
+}
+
+bool InputRecorder::openRecord(const std::string &path, unsigned long long seed, unsigned int screenWidth, unsigned int screenHeight, bool hasSpecialWalls)
+{
+    m_output.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_output.is_open())
+        return false;
+
+    m_seed = seed;
+    m_screenWidth = screenWidth;
+    m_screenHeight = screenHeight;
+    m_hasSpecialWalls = hasSpecialWalls;
+    m_frameCount = 0;
+    m_frameEvents.clear();
+    m_frameEvents.reserve(MAX_FRAME_EVENTS);
+
+    // Header
+    m_output.write("RCRP", 4);
+    writeU16(FILE_VERSION);
+    writeU64(m_seed);
+    writeU16(m_screenWidth);
+    writeU16(m_screenHeight);
+    writeU8(m_hasSpecialWalls ? 1 : 0);
+
+    m_isRecording = true;
+    return true;
+}
+
+bool InputRecorder::openReplay(const std::string &path)
+{
+    m_input.open(path, std::ios::binary);
+    if (!m_input.is_open())
+        return false;
+
+    // Header
+    char magic[4];
+    unsigned short version;
+    unsigned short screenWidth;
+    unsigned short screenHeight;
+    unsigned char hasSpecialWalls;
+    m_input.read(magic, 4);
+    if (!m_input || magic[0] != 'R' || magic[1] != 'C' || magic[2] != 'R' || magic[3] != 'P')
+    {
+        std::cerr << "Replay: " << path << " is not a recording" << std::endl;
+        m_input.close();
+        return false;
+    }
+    if (!readU16(version) || version != FILE_VERSION || !readU64(m_seed) || !readU16(screenWidth) || !readU16(screenHeight) || !readU8(hasSpecialWalls))
+    {
+        std::cerr << "Replay: unsupported or truncated header in " << path << std::endl;
+        m_input.close();
+        return false;
+    }
+
+    m_screenWidth = screenWidth;
+    m_screenHeight = screenHeight;
+    m_hasSpecialWalls = (hasSpecialWalls != 0);
+    m_frameCount = 0;
+    m_frameEvents.clear();
+    m_frameEvents.reserve(MAX_FRAME_EVENTS);
+    m_frameEventIndex = 0;
+
+    m_isReplaying = true;
+    return true;
+}
+
+void InputRecorder::close()
+{
+    if (m_output.is_open())
+        m_output.close();
+    if (m_input.is_open())
+        m_input.close();
+
+    m_isRecording = false;
+    m_isReplaying = false;
+}
+
+void InputRecorder::recordEvent(const SDL_Event &event)
+{
+    if (!m_isRecording)
+        return;
+
+    // Only the events Capp reacts to are kept
+    switch (event.type)
+    {
+        case SDL_QUIT:
+            m_frameEvents.push_back({ EventKind::quit, 0 });
+            break;
+
+        case SDL_KEYDOWN:
+            m_frameEvents.push_back({ EventKind::keyDown, (short)event.key.keysym.scancode });
+            break;
+
+        case SDL_KEYUP:
+            m_frameEvents.push_back({ EventKind::keyUp, (short)event.key.keysym.scancode });
+            break;
+
+        case SDL_MOUSEMOTION:
+            m_frameEvents.push_back({ EventKind::mouseMotion, (short)event.motion.xrel });
+            break;
+
+        case SDL_MOUSEWHEEL:
+            m_frameEvents.push_back({ EventKind::mouseWheel, (short)event.wheel.y });
+            break;
+
+        default:
+            break;
+    }
+}
+
+void InputRecorder::recordFrame(unsigned int dtMicroseconds)
+{
+    if (!m_isRecording)
+        return;
+
+    writeU32(dtMicroseconds);
+    writeU16((unsigned short)m_frameEvents.size());
+    for (const RecordedEvent &recordedEvent : m_frameEvents)
+    {
+        writeU8(recordedEvent.kind);
+        if (recordedEvent.kind != EventKind::quit)
+            writeU16((unsigned short)recordedEvent.value);
+    }
+
+    m_frameEvents.clear();
+    m_frameCount++;
+}
+
+bool InputRecorder::readFrame(unsigned int &dtMicroseconds)
+{
+    if (!m_isReplaying)
+        return false;
+
+    unsigned short eventCount;
+    if (!readU32(dtMicroseconds) || !readU16(eventCount))
+        return false;
+
+    m_frameEvents.resize(eventCount);
+    for (RecordedEvent &recordedEvent : m_frameEvents)
+    {
+        unsigned short value = 0;
+        if (!readU8(recordedEvent.kind))
+            return false;
+        if (recordedEvent.kind != EventKind::quit && !readU16(value))
+            return false;
+        recordedEvent.value = (short)value;
+    }
+
+    m_frameEventIndex = 0;
+    m_frameCount++;
+    return true;
+}
+
+bool InputRecorder::pollEvent(SDL_Event &event)
+{
+    if (m_frameEventIndex >= m_frameEvents.size())
+        return false;
+
+    const RecordedEvent &recordedEvent = m_frameEvents[m_frameEventIndex++];
+    event = SDL_Event {};
+    switch (recordedEvent.kind)
+    {
+        case EventKind::quit:
+            event.type = SDL_QUIT;
+            break;
+
+        case EventKind::keyDown:
+            event.type = SDL_KEYDOWN;
+            event.key.keysym.scancode = (SDL_Scancode)recordedEvent.value;
+            break;
+
+        case EventKind::keyUp:
+            event.type = SDL_KEYUP;
+            event.key.keysym.scancode = (SDL_Scancode)recordedEvent.value;
+            break;
+
+        case EventKind::mouseMotion:
+            event.type = SDL_MOUSEMOTION;
+            event.motion.xrel = recordedEvent.value;
+            break;
+
+        case EventKind::mouseWheel:
+            event.type = SDL_MOUSEWHEEL;
+            event.wheel.y = recordedEvent.value;
+            break;
+
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+void InputRecorder::writeU8(unsigned char value)
+{
+    m_output.put((char)value);
+}
+
+void InputRecorder::writeU16(unsigned short value)
+{
+    writeU8(value & 0xFF);
+    writeU8(value >> 8);
+}
+
+void InputRecorder::writeU32(unsigned int value)
+{
+    writeU16(value & 0xFFFF);
+    writeU16(value >> 16);
+}
+
+void InputRecorder::writeU64(unsigned long long value)
+{
+    writeU32(value & 0xFFFFFFFF);
+    writeU32(value >> 32);
+}
+
+bool InputRecorder::readU8(unsigned char &value)
+{
+    char byte;
+    if (!m_input.get(byte))
+        return false;
+    value = (unsigned char)byte;
+    return true;
+}
+
+bool InputRecorder::readU16(unsigned short &value)
+{
+    unsigned char low, high;
+    if (!readU8(low) || !readU8(high))
+        return false;
+    value = low | (high << 8);
+    return true;
+}
+
+bool InputRecorder::readU32(unsigned int &value)
+{
+    unsigned short low, high;
+    if (!readU16(low) || !readU16(high))
+        return false;
+    value = low | ((unsigned int)high << 16);
+    return true;
+}
+
+bool InputRecorder::readU64(unsigned long long &value)
+{
+    unsigned int low, high;
+    if (!readU32(low) || !readU32(high))
+        return false;
+    value = low | ((unsigned long long)high << 32);
+    return true;
+}
\ No newline at end of file
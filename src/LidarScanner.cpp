@@ -0,0 +1,187 @@
+#include <cmath>
+#include <limits>
+
+#include "CpuFeatures.hpp"
+#include "LidarScanner.hpp"
+#include "Toolbox.hpp"
+
+#if defined(RAYCASTING_X86_DISPATCH)
+#include <immintrin.h>
+#endif
+
+LidarScanner::LidarScanner(const unsigned int numberOfBeams, const double maxRange, const double noiseStandardDeviation, const unsigned long long seed)
+    : m_generator(seed), m_noise(0, 1)
+{
+    m_numberOfBeams = numberOfBeams;
+    m_maxRange = maxRange;
+    m_noiseStandardDeviation = noiseStandardDeviation;
+
+    // Beam directions relative to the scanner heading, rotated per scan (no trigonometry per beam)
+    m_beamCos.resize(m_numberOfBeams);
+    m_beamSin.resize(m_numberOfBeams);
+    m_rayDirectionX.resize(m_numberOfBeams);
+    m_rayDirectionY.resize(m_numberOfBeams);
+    m_distances.resize(m_numberOfBeams);
+    for (unsigned int i = 0; i < m_numberOfBeams; i++)
+    {
+        double beamAngle = 2 * M_PI * i / m_numberOfBeams;
+        m_beamCos[i] = cos(beamAngle);
+        m_beamSin[i] = sin(beamAngle);
+    }
+}
+
+void LidarScanner::scan(const MapManager &mapManager, const double x, const double y, const double angle, float *distances)
+{
+    const double headingCos = cos(angle);
+    const double headingSin = sin(angle);
+
+    // Same convention as the renderer: y axis points down
+    for (unsigned int i = 0; i < m_numberOfBeams; i++)
+    {
+        m_rayDirectionX[i] = headingCos * m_beamCos[i] - headingSin * m_beamSin[i];
+        m_rayDirectionY[i] = -(headingSin * m_beamCos[i] + headingCos * m_beamSin[i]);
+    }
+
+    // Only the AVX-512 packets (masked gathers & compares) beat the scalar traversal: the SSE4.2
+    // & AVX2 ones lost to it (per lane map reads, emulated masks), the lower levels run scalar
+    switch (CpuFeatures::getLevel())
+    {
+        case SimdLevel::avx512:
+            traverse_AVX512(mapManager, x, y, 0, m_numberOfBeams);
+            break;
+        default:
+            traverse_scalar(mapManager, x, y, 0, m_numberOfBeams);
+            break;
+    }
+
+    for (unsigned int i = 0; i < m_numberOfBeams; i++)
+    {
+        double distance = m_distances[i];
+        if (m_noiseStandardDeviation > 0 && distance < m_maxRange)
+            distance = Math::limitToInterval<double>(distance + m_noiseStandardDeviation * m_noise(m_generator), 0, m_maxRange);
+
+        distances[i] = (float)distance;
+    }
+}
+
+void LidarScanner::traverse_scalar(const MapManager &mapManager, const double x, const double y, const unsigned int first, const unsigned int last)
+{
+    const int startCellX = (int)x;
+    const int startCellY = (int)y;
+
+    for (unsigned int i = first; i < last; i++)
+    {
+        const double rayDirectionX = m_rayDirectionX[i];
+        const double rayDirectionY = m_rayDirectionY[i];
+
+        // Grid traversal (DDA), stops at the first wall, at max range or on the map's sentinel ring
+        int cellX = startCellX;
+        int cellY = startCellY;
+        const int stepX = (rayDirectionX < 0) ? -1 : 1;
+        const int stepY = (rayDirectionY < 0) ? -1 : 1;
+        const double deltaDistanceX = (rayDirectionX == 0) ? std::numeric_limits<double>::infinity() : std::fabs(1 / rayDirectionX);
+        const double deltaDistanceY = (rayDirectionY == 0) ? std::numeric_limits<double>::infinity() : std::fabs(1 / rayDirectionY);
+        double sideDistanceX = (rayDirectionX < 0) ? (x - cellX) * deltaDistanceX : (cellX + 1 - x) * deltaDistanceX;
+        double sideDistanceY = (rayDirectionY < 0) ? (y - cellY) * deltaDistanceY : (cellY + 1 - y) * deltaDistanceY;
+
+        double distance = m_maxRange;
+        while (true)
+        {
+            double edgeDistance;
+            if (sideDistanceX < sideDistanceY)
+            {
+                edgeDistance = sideDistanceX;
+                sideDistanceX += deltaDistanceX;
+                cellX += stepX;
+            }
+            else
+            {
+                edgeDistance = sideDistanceY;
+                sideDistanceY += deltaDistanceY;
+                cellY += stepY;
+            }
+
+            if (edgeDistance >= m_maxRange)
+                break;
+            const char element = mapManager.getMapElement(cellX, cellY);
+            if (element != 0)
+            {
+                if (element != MapManager::OUTSIDE_ELEMENT)
+                    distance = edgeDistance;
+                break;
+            }
+        }
+
+        m_distances[i] = distance;
+    }
+}
+
+// Packets of 8 beams: same steps as the scalar traversal, one beam per lane. Cells are kept as
+// (exact) doubles so that they share the lanes of the distances. A packet goes on until all its
+// beams hit a wall, the sentinel ring around the map (no return) or max range.
+#if defined(RAYCASTING_X86_DISPATCH)
+__attribute__((target("avx512f,avx512bw,avx512vl")))
+#endif
+void LidarScanner::traverse_AVX512(const MapManager &mapManager, const double x, const double y, const unsigned int first, const unsigned int last)
+{
+#if defined(RAYCASTING_X86_DISPATCH)
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d one = _mm512_set1_pd(1);
+    const __m512d positionX = _mm512_set1_pd(x + MapManager::BORDER_SIZE);
+    const __m512d positionY = _mm512_set1_pd(y + MapManager::BORDER_SIZE);
+    const __m512d startCellX = _mm512_set1_pd((int)x + MapManager::BORDER_SIZE);
+    const __m512d startCellY = _mm512_set1_pd((int)y + MapManager::BORDER_SIZE);
+    const __m512d stride = _mm512_set1_pd(mapManager.getStride());
+    const __m512d maxRange = _mm512_set1_pd(m_maxRange);
+    const char *mapArray = mapManager.getMapArray();
+
+    unsigned int i = first;
+    for (; i + 8 <= last; i += 8)
+    {
+        const __m512d rayDirectionX = _mm512_loadu_pd(&m_rayDirectionX[i]);
+        const __m512d rayDirectionY = _mm512_loadu_pd(&m_rayDirectionY[i]);
+        const __mmask8 isNegativeX = _mm512_cmp_pd_mask(rayDirectionX, zero, _CMP_LT_OQ);
+        const __mmask8 isNegativeY = _mm512_cmp_pd_mask(rayDirectionY, zero, _CMP_LT_OQ);
+        const __m512d stepX = _mm512_mask_blend_pd(isNegativeX, one, _mm512_sub_pd(zero, one));
+        const __m512d stepY = _mm512_mask_blend_pd(isNegativeY, one, _mm512_sub_pd(zero, one));
+        const __m512d deltaDistanceX = _mm512_abs_pd(_mm512_div_pd(one, rayDirectionX));
+        const __m512d deltaDistanceY = _mm512_abs_pd(_mm512_div_pd(one, rayDirectionY));
+        __m512d cellX = startCellX;
+        __m512d cellY = startCellY;
+        __m512d sideDistanceX = _mm512_mask_blend_pd(isNegativeX, _mm512_mul_pd(_mm512_sub_pd(_mm512_add_pd(cellX, one), positionX), deltaDistanceX), _mm512_mul_pd(_mm512_sub_pd(positionX, cellX), deltaDistanceX));
+        __m512d sideDistanceY = _mm512_mask_blend_pd(isNegativeY, _mm512_mul_pd(_mm512_sub_pd(_mm512_add_pd(cellY, one), positionY), deltaDistanceY), _mm512_mul_pd(_mm512_sub_pd(positionY, cellY), deltaDistanceY));
+
+        __m512d distances = maxRange;
+        __mmask8 isActive = 0xFF;
+        while (isActive != 0)
+        {
+            const __mmask8 isStepX = _mm512_cmp_pd_mask(sideDistanceX, sideDistanceY, _CMP_LT_OQ);
+            const __mmask8 isStepY = ~isStepX;
+            const __m512d edgeDistance = _mm512_mask_blend_pd(isStepX, sideDistanceY, sideDistanceX);
+            sideDistanceX = _mm512_mask_add_pd(sideDistanceX, isStepX, sideDistanceX, deltaDistanceX);
+            sideDistanceY = _mm512_mask_add_pd(sideDistanceY, isStepY, sideDistanceY, deltaDistanceY);
+            cellX = _mm512_mask_add_pd(cellX, isStepX, cellX, stepX);
+            cellY = _mm512_mask_add_pd(cellY, isStepY, cellY, stepY);
+
+            isActive &= ~_mm512_cmp_pd_mask(edgeDistance, maxRange, _CMP_GE_OQ);
+
+            // Cells of the active lanes: gather their aligned 32 bit words (never past the
+            // allocation's last aligned word), then shift their byte down. Any non free cell
+            // stops the lane, only walls (not the sentinel ring) return a distance
+            const __m256i cellIndex = _mm512_maskz_cvttpd_epi32(0xFF, _mm512_add_pd(_mm512_mul_pd(cellY, stride), cellX));
+            const __m256i words = _mm256_mmask_i32gather_epi32(_mm256_setzero_si256(), isActive, _mm256_srli_epi32(cellIndex, 2), (const int *)mapArray, 4);
+            const __m256i shifts = _mm256_slli_epi32(_mm256_and_si256(cellIndex, _mm256_set1_epi32(3)), 3);
+            const __m256i cells = _mm256_and_si256(_mm256_srlv_epi32(words, shifts), _mm256_set1_epi32(0xFF));
+            const __mmask8 isHit = _mm256_test_epi32_mask(cells, cells) & isActive;
+            const __mmask8 isWall = _mm256_mask_cmpneq_epi32_mask(isHit, cells, _mm256_set1_epi32((unsigned char)MapManager::OUTSIDE_ELEMENT));
+            distances = _mm512_mask_blend_pd(isWall, distances, edgeDistance);
+            isActive &= ~isHit;
+        }
+        _mm512_storeu_pd(&m_distances[i], distances);
+    }
+
+    traverse_scalar(mapManager, x, y, i, last);
+#else
+    traverse_scalar(mapManager, x, y, first, last);
+#endif
+}
\ No newline at end of file
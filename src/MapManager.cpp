@@ -1,8 +1,13 @@
+#include <algorithm>
 #include <iostream>
 
 #include "MapManager.hpp"
 #include "SDL.h"
 
+const unsigned int MapManager::NO_COMPONENT;
+const char MapManager::OUTSIDE_ELEMENT;
+const int MapManager::BORDER_SIZE;
+
 MapManager::MapManager()
 {
     // Default constructor, used for debuging only
@@ -12,12 +17,16 @@ MapManager::MapManager()
     // 3 : Green block
     // 4 : Blue block
     // 5 : Texture block
+    // 6 : Door
+    // 7 : Half-height block
+    // 8 : Double-height block
+    // 9 : Grate (see-through)
     // Other : Black block
     
     // Setup map array
     m_width = DEFAULT_SIZE;
     m_height = DEFAULT_SIZE;
-    m_mapArray = new char[m_width * m_height] 
+    const char cells[] =
     { 
         1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
         2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3,
@@ -52,6 +61,7 @@ MapManager::MapManager()
         2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3,
         2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3
     };
+    allocateMapArray(cells);
 
     // Fill array
     // for(unsigned int i = 0; i < DEFAULT_SIZE; i++)
@@ -74,6 +84,11 @@ MapManager::MapManager()
     // m_mapArray[coordinateToIndex(22, 11)] = 2;
     // m_mapArray[coordinateToIndex(22, 10)] = 2;
 
+    initialiseDerivedData();
+
+    // Doors of the blue room
+    addDoor(7, 8);
+    addDoor(5, 12);
 }
 
 MapManager::MapManager(const unsigned int width, const unsigned int height)
@@ -82,27 +97,449 @@ MapManager::MapManager(const unsigned int width, const unsigned int height)
     // Setup map array
     m_width = width;
     m_height = height;
-    m_mapArray = new char[m_width * m_height] { 0 };
+    allocateMapArray(nullptr);
 
     // Fill array
     for(unsigned int i = 0; i < m_width; i++)
     {
-        m_mapArray[coordinateToIndex(i, 0)] = 1;
-        m_mapArray[coordinateToIndex(i, m_height-1)] = 1;
+        m_mapArray[coordinateToPaddedIndex(i, 0)] = 1;
+        m_mapArray[coordinateToPaddedIndex(i, m_height-1)] = 1;
     }
 
     for (unsigned int i = 0; i < m_height; i++)
     {
-        m_mapArray[coordinateToIndex(0, i)] = 1;
-        m_mapArray[coordinateToIndex(m_width-1, i)] = 1;
+        m_mapArray[coordinateToPaddedIndex(0, i)] = 1;
+        m_mapArray[coordinateToPaddedIndex(m_width-1, i)] = 1;
     }
+
+    initialiseDerivedData();
+}
+
+MapManager::MapManager(const unsigned int width, const unsigned int height, const char *cells)
+{
+    // Setup map array, row by row
+    m_width = width;
+    m_height = height;
+    allocateMapArray(cells);
+
+    initialiseDerivedData();
 }
 
 MapManager::~MapManager()
 {
+    SDL_releaseTextures();
     delete[] m_mapArray;
 }
 
+void MapManager::allocateMapArray(const char *cells)
+{
+    // Sentinel ring, then the cells row by row (free when none are given)
+    m_stride = m_width + 2 * BORDER_SIZE;
+    const unsigned int paddedSize = m_stride * (m_height + 2 * BORDER_SIZE);
+    m_mapArray = new char[paddedSize];
+    std::fill(m_mapArray, m_mapArray + paddedSize, OUTSIDE_ELEMENT);
+    for (unsigned int y = 0; y < m_height; y++)
+    {
+        char *row = m_mapArray + coordinateToPaddedIndex(0, y);
+        if (cells != nullptr)
+            std::copy(cells + y * m_width, cells + (y + 1) * m_width, row);
+        else
+            std::fill(row, row + m_width, 0);
+    }
+}
+
+const Material &MapManager::getMaterial(char element)
+{
+    static const Material MATERIALS[] =
+    {
+        { 0, true, { 0, 0, 0, 0 } },
+        { 1, false, { 255, 255, 255, 255 } },
+        { 1, false, { 255, 0, 0, 255 } },
+        { 1, false, { 0, 255, 0, 255 } },
+        { 1, false, { 0, 0, 255, 255 } },
+        { 1, false, { 255, 255, 255, 255 } },
+        { 1, false, { 160, 100, 40, 255 } },
+        { 0.5, false, { 200, 120, 60, 255 } },
+        { 2, false, { 180, 180, 200, 255 } },
+        { 1, true, { 140, 140, 140, 110 } }
+    };
+    static const Material DEFAULT_MATERIAL = { 1, false, { 0, 0, 0, 255 } };
+
+    if (element < 0 || element >= (char)(sizeof(MATERIALS) / sizeof(Material)))
+        return DEFAULT_MATERIAL;
+    return MATERIALS[(int)element];
+}
+
+unsigned int MapManager::getNumberOfSpecialCells() const
+{
+    unsigned int numberOfSpecialCells = 0;
+    for (unsigned int element = 0; element < 256; element++)
+        if (isSpecialElement((char)element))
+            numberOfSpecialCells += m_numberOfCellsPerElement[element];
+    return numberOfSpecialCells;
+}
+
+double MapManager::getMaximumHeight() const
+{
+    double maximumHeight = 0;
+    for (unsigned int element = 1; element < 256; element++)
+        if (m_numberOfCellsPerElement[element] != 0)
+            maximumHeight = std::max(maximumHeight, getMaterial((char)element).height);
+    return maximumHeight;
+}
+
+void MapManager::initialiseDerivedData()
+{
+    m_isDoorCell.assign(m_width * m_height, false);
+    m_journalFirstRevision = 0;
+    m_revision = 0;
+    m_miniMapTexture = nullptr;
+    m_miniMapRevision = 0;
+
+    for (auto &numberOfCells : m_numberOfCellsPerElement)
+        numberOfCells = 0;
+    for (unsigned int y = 0; y < m_height; y++)
+        for (unsigned int x = 0; x < m_width; x++)
+            m_numberOfCellsPerElement[(unsigned char)getMapElement(x, y)]++;
+
+    buildWalkableSpace();
+}
+
+void MapManager::buildWalkableSpace()
+{
+    const unsigned int numberOfCells = m_width * m_height;
+    m_freeCells.clear();
+    m_freeCellSlot.assign(numberOfCells, 0);
+    m_cellComponent.assign(numberOfCells, NO_COMPONENT);
+    m_componentCells.clear();
+    m_componentSlot.assign(numberOfCells, 0);
+    m_releasedComponents.clear();
+    m_numberOfComponents = 0;
+    m_visitStamp.assign(numberOfCells, 0);
+    m_currentStamp = 0;
+
+    for (unsigned int cell = 0; cell < numberOfCells; cell++)
+        if (getMapElement(cell % m_width, cell / m_width) == 0)
+            addFreeCell(cell);
+
+    // Label the components by flood fill
+    for (unsigned int cell : m_freeCells)
+    {
+        if (m_cellComponent[cell] != NO_COMPONENT)
+            continue;
+
+        const unsigned int component = createComponent();
+        m_floodCells.clear();
+        m_floodCells.push_back(cell);
+        setCellComponent(cell, component);
+        for (size_t head = 0; head < m_floodCells.size(); head++)
+        {
+            unsigned int neighbours[4];
+            const unsigned int numberOfNeighbours = getFreeNeighbours(m_floodCells[head], neighbours);
+            for (unsigned int i = 0; i < numberOfNeighbours; i++)
+            {
+                if (m_cellComponent[neighbours[i]] != NO_COMPONENT)
+                    continue;
+                setCellComponent(neighbours[i], component);
+                m_floodCells.push_back(neighbours[i]);
+            }
+        }
+    }
+
+    findLargestComponent();
+}
+
+void MapManager::setMapElement(unsigned int x, unsigned int y, char element)
+{
+    const unsigned int cell = coordinateToIndex(x, y);
+    const char previousElement = getMapElement(x, y);
+    if (previousElement == element)
+        return;
+    m_mapArray[coordinateToPaddedIndex(x, y)] = element;
+
+    // Journal, the oldest half is dropped when full
+    {
+        std::lock_guard<std::mutex> lock(m_journalMutex);
+        if (m_journal.size() >= MAX_JOURNAL_SIZE)
+        {
+            m_journal.erase(m_journal.begin(), m_journal.begin() + MAX_JOURNAL_SIZE / 2);
+            m_journalFirstRevision += MAX_JOURNAL_SIZE / 2;
+        }
+        m_journal.push_back(MapChange { x, y, previousElement, element });
+        m_revision++;
+    }
+
+    m_numberOfCellsPerElement[(unsigned char)previousElement]--;
+    m_numberOfCellsPerElement[(unsigned char)element]++;
+
+    // Walkable space, only when the cell switches between free & solid
+    const bool wasFree = (previousElement == 0);
+    if (wasFree == (element == 0))
+        return;
+
+    unsigned int neighbours[4];
+    const unsigned int numberOfNeighbours = getFreeNeighbours(cell, neighbours);
+
+    // Opened: join the largest neighbouring component, merge the smaller ones into it
+    if (element == 0)
+    {
+        addFreeCell(cell);
+        unsigned int component = NO_COMPONENT;
+        for (unsigned int i = 0; i < numberOfNeighbours; i++)
+            if (component == NO_COMPONENT || getComponentSize(m_cellComponent[neighbours[i]]) > getComponentSize(component))
+                component = m_cellComponent[neighbours[i]];
+        if (component == NO_COMPONENT)
+            component = createComponent();
+        setCellComponent(cell, component);
+
+        for (unsigned int i = 0; i < numberOfNeighbours; i++)
+        {
+            const unsigned int neighbourComponent = m_cellComponent[neighbours[i]];
+            if (neighbourComponent == component)
+                continue;
+            while (!m_componentCells[neighbourComponent].empty())
+                setCellComponent(m_componentCells[neighbourComponent].back(), component);
+            releaseComponent(neighbourComponent);
+        }
+
+        if (m_largestComponent == NO_COMPONENT || getComponentSize(component) > getComponentSize(m_largestComponent))
+            m_largestComponent = component;
+        return;
+    }
+
+    // Closed: leave the component, which may be split
+    const unsigned int component = m_cellComponent[cell];
+    removeFreeCell(cell);
+    setCellComponent(cell, NO_COMPONENT);
+    if (m_componentCells[component].empty())
+        releaseComponent(component);
+
+    if (numberOfNeighbours >= 2)
+        splitComponent(neighbours, numberOfNeighbours);
+
+    if (component == m_largestComponent)
+        findLargestComponent();
+}
+
+void MapManager::splitComponent(const unsigned int neighbours[4], const unsigned int numberOfNeighbours)
+{
+    // One flood per free neighbour of the closed cell, advanced in lockstep. Floods that meet
+    // are connected; a group of floods running out of cells is a piece cut off, relabelled.
+    // The search stops when one group is left, which keeps the label: the cost is the size
+    // of the smaller pieces, not of the component.
+    m_currentStamp += 4;
+    unsigned int group[4];
+    size_t head[4];
+    bool isRelabelled[4];
+    for (unsigned int i = 0; i < numberOfNeighbours; i++)
+    {
+        group[i] = i;
+        head[i] = 0;
+        isRelabelled[i] = false;
+        m_splitFloods[i].clear();
+        m_splitFloods[i].push_back(neighbours[i]);
+        m_visitStamp[neighbours[i]] = m_currentStamp + i;
+    }
+
+    auto findGroup = [&group](unsigned int flood) { while (group[flood] != flood) flood = group[flood]; return flood; };
+    unsigned int numberOfGroups = numberOfNeighbours;
+    while (numberOfGroups > 1)
+    {
+        // One cell per flood
+        for (unsigned int i = 0; i < numberOfNeighbours; i++)
+        {
+            if (head[i] == m_splitFloods[i].size())
+                continue;
+
+            unsigned int adjacentCells[4];
+            const unsigned int numberOfAdjacentCells = getFreeNeighbours(m_splitFloods[i][head[i]++], adjacentCells);
+            for (unsigned int j = 0; j < numberOfAdjacentCells; j++)
+            {
+                const unsigned int stamp = m_visitStamp[adjacentCells[j]];
+                if (stamp >= m_currentStamp && stamp < m_currentStamp + numberOfNeighbours)
+                {
+                    const unsigned int otherGroup = findGroup(stamp - m_currentStamp);
+                    const unsigned int ownGroup = findGroup(i);
+                    if (otherGroup != ownGroup)
+                    {
+                        group[otherGroup] = ownGroup;
+                        numberOfGroups--;
+                    }
+                    continue;
+                }
+                m_visitStamp[adjacentCells[j]] = m_currentStamp + i;
+                m_splitFloods[i].push_back(adjacentCells[j]);
+            }
+        }
+
+        // Groups whose floods are all exhausted
+        for (unsigned int i = 0; i < numberOfNeighbours && numberOfGroups > 1; i++)
+        {
+            if (findGroup(i) != i || isRelabelled[i])
+                continue;
+
+            bool isExhausted = true;
+            for (unsigned int j = 0; j < numberOfNeighbours; j++)
+                if (findGroup(j) == i && head[j] != m_splitFloods[j].size())
+                    isExhausted = false;
+            if (!isExhausted)
+                continue;
+
+            const unsigned int pieceComponent = createComponent();
+            for (unsigned int j = 0; j < numberOfNeighbours; j++)
+                if (findGroup(j) == i)
+                    for (unsigned int pieceCell : m_splitFloods[j])
+                        setCellComponent(pieceCell, pieceComponent);
+            isRelabelled[i] = true;
+            numberOfGroups--;
+        }
+    }
+}
+
+void MapManager::addSpecialWalls()
+{
+    // Grates in the open top right area, half walls next to the red pillar, tall pillars bottom right
+    for (unsigned int x = 24; x < 28; x++)
+        setMapElement(x, 4, 9);
+    for (unsigned int x = 20; x < 24; x++)
+        setMapElement(x, 20, 7);
+    for (unsigned int y = 24; y < 28; y += 2)
+    {
+        setMapElement(26, y, 8);
+        setMapElement(28, y, 8);
+    }
+}
+
+void MapManager::addDoor(unsigned int x, unsigned int y)
+{
+    const unsigned int cell = coordinateToIndex(x, y);
+    if (!m_isDoorCell[cell])
+    {
+        m_isDoorCell[cell] = true;
+        m_doorCells.push_back(cell);
+    }
+    setMapElement(x, y, DOOR_ELEMENT);
+}
+
+bool MapManager::toggleDoor(unsigned int x, unsigned int y)
+{
+    if (!isDoor(x, y))
+        return false;
+
+    setMapElement(x, y, (getMapElement(x, y) == 0) ? DOOR_ELEMENT : 0);
+    return true;
+}
+
+bool MapManager::getChangesSince(unsigned long long revision, std::vector<MapChange> &changes) const
+{
+    std::lock_guard<std::mutex> lock(m_journalMutex);
+    if (revision < m_journalFirstRevision)
+        return false;
+
+    changes.insert(changes.end(), m_journal.begin() + (revision - m_journalFirstRevision), m_journal.end());
+    return true;
+}
+
+bool MapManager::getRandomFreeCell(std::default_random_engine &generator, unsigned int &x, unsigned int &y) const
+{
+    return getRandomFreeCell(generator, m_largestComponent, x, y);
+}
+
+bool MapManager::getRandomFreeCell(std::default_random_engine &generator, unsigned int component, unsigned int &x, unsigned int &y) const
+{
+    // NO_COMPONENT: any free cell
+    const std::vector<unsigned int> &cells = (component == NO_COMPONENT) ? m_freeCells : m_componentCells[component];
+    if (cells.empty())
+        return false;
+
+    std::uniform_int_distribution<unsigned int> distribution(0, cells.size() - 1);
+    const unsigned int cell = cells[distribution(generator)];
+    x = cell % m_width;
+    y = cell / m_width;
+    return true;
+}
+
+void MapManager::addFreeCell(unsigned int cell)
+{
+    m_freeCellSlot[cell] = m_freeCells.size();
+    m_freeCells.push_back(cell);
+}
+
+void MapManager::removeFreeCell(unsigned int cell)
+{
+    // Swap with the last free cell
+    const unsigned int lastCell = m_freeCells.back();
+    m_freeCells[m_freeCellSlot[cell]] = lastCell;
+    m_freeCellSlot[lastCell] = m_freeCellSlot[cell];
+    m_freeCells.pop_back();
+}
+
+unsigned int MapManager::createComponent()
+{
+    m_numberOfComponents++;
+    if (!m_releasedComponents.empty())
+    {
+        const unsigned int component = m_releasedComponents.back();
+        m_releasedComponents.pop_back();
+        return component;
+    }
+
+    m_componentCells.push_back(std::vector<unsigned int>());
+    return m_componentCells.size() - 1;
+}
+
+void MapManager::releaseComponent(unsigned int component)
+{
+    m_numberOfComponents--;
+    m_releasedComponents.push_back(component);
+}
+
+void MapManager::setCellComponent(unsigned int cell, unsigned int component)
+{
+    // Leave the previous component (swap with its last cell)
+    const unsigned int previousComponent = m_cellComponent[cell];
+    if (previousComponent != NO_COMPONENT)
+    {
+        std::vector<unsigned int> &cells = m_componentCells[previousComponent];
+        const unsigned int lastCell = cells.back();
+        cells[m_componentSlot[cell]] = lastCell;
+        m_componentSlot[lastCell] = m_componentSlot[cell];
+        cells.pop_back();
+    }
+
+    m_cellComponent[cell] = component;
+    if (component != NO_COMPONENT)
+    {
+        m_componentSlot[cell] = m_componentCells[component].size();
+        m_componentCells[component].push_back(cell);
+    }
+}
+
+void MapManager::findLargestComponent()
+{
+    m_largestComponent = NO_COMPONENT;
+    for (unsigned int component = 0; component < m_componentCells.size(); component++)
+        if (!m_componentCells[component].empty() && (m_largestComponent == NO_COMPONENT || m_componentCells[component].size() > m_componentCells[m_largestComponent].size()))
+            m_largestComponent = component;
+}
+
+unsigned int MapManager::getFreeNeighbours(unsigned int cell, unsigned int neighbours[4]) const
+{
+    // The sentinel ring is never free, no bounds checks
+    const char *paddedCell = m_mapArray + coordinateToPaddedIndex(cell % m_width, cell / m_width);
+    unsigned int numberOfNeighbours = 0;
+    if (paddedCell[-1] == 0)
+        neighbours[numberOfNeighbours++] = cell - 1;
+    if (paddedCell[1] == 0)
+        neighbours[numberOfNeighbours++] = cell + 1;
+    if (paddedCell[-(int)m_stride] == 0)
+        neighbours[numberOfNeighbours++] = cell - m_width;
+    if (paddedCell[m_stride] == 0)
+        neighbours[numberOfNeighbours++] = cell + m_width;
+
+    return numberOfNeighbours;
+}
+
 
 int MapManager::SDL_renderMap(SDL_Renderer *renderer, const unsigned int screenWidth, const unsigned int screenHeight)
 {
@@ -111,15 +548,15 @@ int MapManager::SDL_renderMap(SDL_Renderer *renderer, const unsigned int screenW
     {
         for (unsigned int j = 0; j < m_height; j++)
         {
-            if (m_mapArray[coordinateToIndex(i, j)] == 0)
+            if (getMapElement(i, j) == 0)
                 SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-            else if (m_mapArray[coordinateToIndex(i, j)] == 1)
+            else if (getMapElement(i, j) == 1)
                 SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-            else if (m_mapArray[coordinateToIndex(i, j)] == 2)
+            else if (getMapElement(i, j) == 2)
                 SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-            else if (m_mapArray[coordinateToIndex(i, j)] == 3)
+            else if (getMapElement(i, j) == 3)
                 SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
-            else if (m_mapArray[coordinateToIndex(i, j)] == 4)
+            else if (getMapElement(i, j) == 4)
                 SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255);
             else
                 SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
@@ -138,31 +575,70 @@ int MapManager::SDL_renderMap(SDL_Renderer *renderer, const unsigned int screenW
 int MapManager::SDL_renderMiniMap(SDL_Renderer *renderer, const unsigned int screenWidth, const unsigned int screenHeight, unsigned char scaleFactor)
 {
     int miniMapSize = std::min<unsigned int>(screenWidth, screenHeight) / std::max<unsigned int>(m_width, m_height) / scaleFactor; 
-    SDL_Rect tile = { 0, 0, miniMapSize , miniMapSize };
-    for (unsigned int i = 0; i < m_width; i++)
+
+    // Build the texture once, then upload the cells changed since the last frame
+    m_miniMapChanges.clear();
+    if (m_miniMapTexture == nullptr || !getChangesSince(m_miniMapRevision, m_miniMapChanges))
     {
-        for (unsigned int j = 0; j < m_height; j++)
+        if (m_miniMapTexture == nullptr)
         {
-            if (m_mapArray[coordinateToIndex(i, j)] == 0)
-                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 128);
-            else if (m_mapArray[coordinateToIndex(i, j)] == 1)
-                SDL_SetRenderDrawColor(renderer, 255, 255, 255, 128);
-            else if (m_mapArray[coordinateToIndex(i, j)] == 2)
-                SDL_SetRenderDrawColor(renderer, 255, 0, 0, 128);
-            else if (m_mapArray[coordinateToIndex(i, j)] == 3)
-                SDL_SetRenderDrawColor(renderer, 0, 255, 0, 128);
-            else if (m_mapArray[coordinateToIndex(i, j)] == 4)
-                SDL_SetRenderDrawColor(renderer, 0, 0, 255, 128);
-            else if (m_mapArray[coordinateToIndex(i, j)] == 5)
-                SDL_SetRenderDrawColor(renderer, 0, 128, 0, 128);
-                
+            m_miniMapTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, m_width, m_height);
+            if (m_miniMapTexture == nullptr)
+                return -1;
+            SDL_SetTextureBlendMode(m_miniMapTexture, SDL_BLENDMODE_BLEND);
+        }
 
-            SDL_RenderFillRect(renderer, &tile);
-            tile.y += miniMapSize;
+        m_miniMapRevision = m_revision;
+        m_miniMapPixels.resize(m_width * m_height);
+        for (unsigned int cell = 0; cell < m_width * m_height; cell++)
+            m_miniMapPixels[cell] = getMiniMapColor(getMapElement(cell % m_width, cell / m_width));
+        SDL_UpdateTexture(m_miniMapTexture, nullptr, m_miniMapPixels.data(), m_width * sizeof(SDL_Color));
+    }
+    else
+    {
+        for (const MapChange &change : m_miniMapChanges)
+        {
+            SDL_Color &pixel = m_miniMapPixels[coordinateToIndex(change.x, change.y)];
+            pixel = getMiniMapColor(change.element);
+            SDL_Rect cellRect = { (int)change.x, (int)change.y, 1, 1 };
+            SDL_UpdateTexture(m_miniMapTexture, &cellRect, &pixel, sizeof(SDL_Color));
         }
-        tile.x += miniMapSize;
-        tile.y = 0;
+        m_miniMapRevision += m_miniMapChanges.size();
     }
 
+    SDL_Rect miniMapRect = { 0, 0, (int)m_width * miniMapSize, (int)m_height * miniMapSize };
+    SDL_RenderCopy(renderer, m_miniMapTexture, nullptr, &miniMapRect);
+
     return 0;
+}
+
+void MapManager::SDL_releaseTextures()
+{
+    if (m_miniMapTexture != nullptr)
+        SDL_DestroyTexture(m_miniMapTexture);
+    m_miniMapTexture = nullptr;
+}
+
+SDL_Color MapManager::getMiniMapColor(char element) const
+{
+    if (element == 1)
+        return SDL_Color { 255, 255, 255, 128 };
+    else if (element == 2)
+        return SDL_Color { 255, 0, 0, 128 };
+    else if (element == 3)
+        return SDL_Color { 0, 255, 0, 128 };
+    else if (element == 4)
+        return SDL_Color { 0, 0, 255, 128 };
+    else if (element == 5)
+        return SDL_Color { 0, 128, 0, 128 };
+    else if (element == DOOR_ELEMENT)
+        return SDL_Color { 160, 100, 40, 128 };
+    else if (element == 7)
+        return SDL_Color { 200, 120, 60, 128 };
+    else if (element == 8)
+        return SDL_Color { 180, 180, 200, 128 };
+    else if (element == 9)
+        return SDL_Color { 140, 140, 140, 96 };
+    
+    return SDL_Color { 0, 0, 0, 128 };
 }
\ No newline at end of file
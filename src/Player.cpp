@@ -1,34 +1,26 @@
 #include <cmath>
 #include <random>
 #include <iostream>
-#include <chrono>
 
 #include "Player.hpp"
+#include "EntityManager.hpp"
 #include "SDL.h"
 #include "MapManager.hpp"
 #include "Toolbox.hpp"
 
-void Player::initialisePlayer(MapManager &mapManager)
+void Player::initialisePlayer(MapManager &mapManager, unsigned long long seed)
 {
     m_angle = 0;
     m_rotationSpeed = 180.0 * Math::DEGREE_TO_RADIAN;
     m_vx = 0;
     m_vy = 0;
+    m_vMagnitude = 0;
 
-    auto timePoint = std::chrono::high_resolution_clock::now();
-    unsigned long long seed = timePoint.time_since_epoch().count();
-
+    // Uniform over the largest walkable area, never in a sealed pocket
     std::default_random_engine generator(seed);
-    std::uniform_int_distribution<int> distributionX(0, mapManager.getWidth() - 1);
-    std::uniform_int_distribution<int> distributionY(0, mapManager.getHeight() - 1);
-
-    int xStart;
-    int yStart;
-    do
-    {
-        xStart = distributionX(generator);
-        yStart = distributionY(generator);
-    } while (mapManager.getMapElement(xStart, yStart) != 0);
+    unsigned int xStart = mapManager.getWidth() / 2;
+    unsigned int yStart = mapManager.getHeight() / 2;
+    mapManager.getRandomFreeCell(generator, xStart, yStart);
 
     m_xPosition = xStart + 0.5;
     m_yPosition = yStart + 0.5;
@@ -50,21 +42,13 @@ void Player::movePlayer(MapManager &mapManager, double accelForward, double acce
         m_vy *= mouvementSpeed / m_vMagnitude;        
     }
 
-    double nextX = m_xPosition + m_vx * dt;
-    double nextY = m_yPosition + m_vy * dt;
-
-    // Wall collision management
-    double halfPlayerSize = PLAYER_SIZE * 0.5;
-    if ((int)(nextX - halfPlayerSize) != (int)m_xPosition || (int)(nextX + halfPlayerSize) != (int)m_xPosition)
-        if (mapManager.getMapElement((unsigned int)(nextX), (unsigned int)m_yPosition) != 0)
-            nextX = (nextX -  m_xPosition > 0) ? (int)nextX - 0.001 : (int)m_xPosition;
-        
-    if ((int)(nextY - halfPlayerSize) != (int)m_yPosition || (int)(nextY + halfPlayerSize) != (int)m_yPosition)
-        if (mapManager.getMapElement((unsigned int)m_xPosition, (unsigned int)nextY) != 0)
-            nextY = (nextY -  m_yPosition > 0) ? (int)nextY - 0.001 : (int)m_yPosition;
-
-    m_xPosition = nextX;
-    m_yPosition = nextY;
+    // Wall collision management, swept so high speeds or long frames cannot tunnel
+    bool isXblocked, isYblocked;
+    EntityManager::moveAndCollide(mapManager, m_xPosition, m_yPosition, COLLISION_HALF_SIZE, m_vx * dt, m_vy * dt, isXblocked, isYblocked);
+    if (isXblocked)
+        m_vx = 0;
+    if (isYblocked)
+        m_vy = 0;
 
     // Linear drag
     m_vx -= LINEAR_DRAG * m_vx * dt;
@@ -75,6 +59,12 @@ void Player::movePlayer(MapManager &mapManager, double accelForward, double acce
         m_vy = 0;
 }
 
+bool Player::isOverlappingCell(const unsigned int x, const unsigned int y)
+{
+    // Collision box against the cell
+    return m_xPosition + COLLISION_HALF_SIZE > x && m_xPosition - COLLISION_HALF_SIZE < x + 1 && m_yPosition + COLLISION_HALF_SIZE > y && m_yPosition - COLLISION_HALF_SIZE < y + 1;
+}
+
 int Player::SDL_renderPlayer(SDL_Renderer *renderer, MapManager &mapManager, const unsigned int screenWidth, const unsigned int screenHeight)
 {
     // Render Player
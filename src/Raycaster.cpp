@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <iostream>
@@ -9,6 +10,35 @@
 #include "Player.hpp"
 #include "MapManager.hpp"
 
+namespace
+{
+    constexpr unsigned char xorTexel(const int i, const int j, const int textureSize) { return (255 * i / textureSize) ^ (255 * j / textureSize); }
+
+    // XOR texture in both layouts the renderers sample, computed at compile time
+    template <unsigned int SIZE>
+    struct XorTexture
+    {
+        SDL_Color texels[SIZE * SIZE];
+        Uint32 columns[SIZE * SIZE];
+    };
+
+    template <unsigned int SIZE>
+    constexpr XorTexture<SIZE> makeXorTexture()
+    {
+        XorTexture<SIZE> texture = {};
+        for (unsigned int i = 0; i < SIZE; i++)
+        {
+            for (unsigned int j = 0; j < SIZE; j++)
+            {
+                const unsigned char xorColor = xorTexel(i, j, SIZE);
+                texture.texels[i + j * SIZE] = SDL_Color { xorColor, xorColor, xorColor, 255 };
+                texture.columns[j + i * SIZE] = FrameBuffer::packColor(xorColor, xorColor, xorColor);
+            }
+        }
+        return texture;
+    }
+}
+
 Raycaster::Raycaster()
 {
     m_raysDistance = nullptr;
@@ -23,67 +53,228 @@ Raycaster::Raycaster()
     m_raysTextureXIndex = nullptr;
     m_raysTextureYStep = nullptr;
     m_raysIsTextured = nullptr;
+    m_spans = nullptr;
+    m_numberOfSpans = nullptr;
+    m_isMultiHit = false;
+    m_numberOfRays = 0;
+    m_raysCapacity = 0;
+    m_adaptiveStride = 0;
+    m_numberOfCastRays = 0;
+    m_raysCell = nullptr;
+    m_raysSide = nullptr;
+    m_isTemporal = false;
+    m_hasPreviousRays = false;
+    m_previousNumberOfRays = 0;
+    m_previousRaysX = nullptr;
+    m_previousRaysY = nullptr;
+    m_previousRaysAngle = nullptr;
+    m_previousRaysCell = nullptr;
+    m_previousRaysSide = nullptr;
+    m_raysIsAnchor = nullptr;
+    m_rayOffsets = nullptr;
+    m_rayOffsetsCos = nullptr;
+    m_rayOffsetsSin = nullptr;
+    m_raysDirectionX = nullptr;
+    m_raysDirectionY = nullptr;
+    m_offsetsNumberOfRays = 0;
+    m_offsetsFov = 0;
+
+    static constexpr XorTexture<TEXTURE_SIZE> XOR_TEXTURE = makeXorTexture<TEXTURE_SIZE>();
+    m_texture.assign(XOR_TEXTURE.texels, XOR_TEXTURE.texels + TEXTURE_SIZE * TEXTURE_SIZE);
+    m_textureColumns.assign(XOR_TEXTURE.columns, XOR_TEXTURE.columns + TEXTURE_SIZE * TEXTURE_SIZE);
+
+    m_movingOffset = 0;
+    m_numberOfDrawCalls = 0;
+}
 
-    m_texture.resize(TEXTURE_SIZE * TEXTURE_SIZE);
-    unsigned char xorColor;
-    unsigned char ycolor;
-    unsigned char xycolor;
-    for (int i = 0; i < TEXTURE_SIZE; i++)
+void Raycaster::generateTexture(std::vector<SDL_Color> &texture, const unsigned char textureSize)
+{
+    texture.resize(textureSize * textureSize);
+    for (int i = 0; i < textureSize; i++)
     {
-        for (int j = 0; j < TEXTURE_SIZE; j++)
+        for (int j = 0; j < textureSize; j++)
         {
-            xycolor = j * 128 / TEXTURE_SIZE + i * 128 / TEXTURE_SIZE;
-            xorColor = (255 * i / TEXTURE_SIZE) ^ (255 * j / TEXTURE_SIZE);
-            ycolor = j * 255 / TEXTURE_SIZE;
-            m_texture.at(i + j * TEXTURE_SIZE) = SDL_Color { xorColor, xorColor, xorColor, 255 };
+            const unsigned char xorColor = xorTexel(i, j, textureSize);
+            texture[i + j * textureSize] = SDL_Color { xorColor, xorColor, xorColor, 255 };
         }
     }
-
-    m_movingOffset = 0;
 }
 
 Raycaster::~Raycaster()
+{
+    releaseRays();
+}
+
+void Raycaster::releaseRays()
 {
     if (m_raysDistance != nullptr)
+    {
         delete[] m_raysDistance;
+        m_raysDistance = nullptr;
+    }
 
     if (m_raysX != nullptr)
+    {
         delete[] m_raysX;
+        m_raysX = nullptr;
+    }
         
     if (m_raysY != nullptr)
+    {
         delete[] m_raysY;
+        m_raysY = nullptr;
+    }
 
     if (m_raysColorR != nullptr)
+    {
         delete[] m_raysColorR;
+        m_raysColorR = nullptr;
+    }
 
     if (m_raysColorG != nullptr)
+    {
         delete[] m_raysColorG;
+        m_raysColorG = nullptr;
+    }
 
     if (m_raysColorB != nullptr)
+    {
         delete[] m_raysColorB;
+        m_raysColorB = nullptr;
+    }
 
     if (m_raysLightFactor != nullptr)
+    {
         delete[] m_raysLightFactor;
+        m_raysLightFactor = nullptr;
+    }
 
     if (m_raysAngle != nullptr)
+    {
         delete[] m_raysAngle;
+        m_raysAngle = nullptr;
+    }
 
     if (m_wallHeight != nullptr)
+    {
         delete[] m_wallHeight;
+        m_wallHeight = nullptr;
+    }
 
     if (m_raysTextureXIndex != nullptr)
+    {
         delete[] m_raysTextureXIndex;
+        m_raysTextureXIndex = nullptr;
+    }
 
     if (m_raysTextureYStep != nullptr)
+    {
         delete[] m_raysTextureYStep;
+        m_raysTextureYStep = nullptr;
+    }
 
     if (m_raysIsTextured != nullptr)
+    {
         delete[] m_raysIsTextured;
+        m_raysIsTextured = nullptr;
+    }
+
+    if (m_spans != nullptr)
+    {
+        delete[] m_spans;
+        m_spans = nullptr;
+    }
+
+    if (m_numberOfSpans != nullptr)
+    {
+        delete[] m_numberOfSpans;
+        m_numberOfSpans = nullptr;
+    }
+
+    if (m_raysCell != nullptr)
+    {
+        delete[] m_raysCell;
+        m_raysCell = nullptr;
+    }
+
+    if (m_raysSide != nullptr)
+    {
+        delete[] m_raysSide;
+        m_raysSide = nullptr;
+    }
+
+    if (m_previousRaysX != nullptr)
+    {
+        delete[] m_previousRaysX;
+        m_previousRaysX = nullptr;
+    }
+
+    if (m_previousRaysY != nullptr)
+    {
+        delete[] m_previousRaysY;
+        m_previousRaysY = nullptr;
+    }
+
+    if (m_previousRaysAngle != nullptr)
+    {
+        delete[] m_previousRaysAngle;
+        m_previousRaysAngle = nullptr;
+    }
+
+    if (m_previousRaysCell != nullptr)
+    {
+        delete[] m_previousRaysCell;
+        m_previousRaysCell = nullptr;
+    }
+
+    if (m_previousRaysSide != nullptr)
+    {
+        delete[] m_previousRaysSide;
+        m_previousRaysSide = nullptr;
+    }
+
+    if (m_raysIsAnchor != nullptr)
+    {
+        delete[] m_raysIsAnchor;
+        m_raysIsAnchor = nullptr;
+    }
+
+    if (m_rayOffsets != nullptr)
+    {
+        delete[] m_rayOffsets;
+        m_rayOffsets = nullptr;
+    }
+
+    if (m_rayOffsetsCos != nullptr)
+    {
+        delete[] m_rayOffsetsCos;
+        m_rayOffsetsCos = nullptr;
+    }
+
+    if (m_rayOffsetsSin != nullptr)
+    {
+        delete[] m_rayOffsetsSin;
+        m_rayOffsetsSin = nullptr;
+    }
+
+    if (m_raysDirectionX != nullptr)
+    {
+        delete[] m_raysDirectionX;
+        m_raysDirectionX = nullptr;
+    }
+
+    if (m_raysDirectionY != nullptr)
+    {
+        delete[] m_raysDirectionY;
+        m_raysDirectionY = nullptr;
+    }
 }
 
 void Raycaster::initialiseRaycaster(const unsigned int numberOfRays)
 {
+    releaseRays();
     m_numberOfRays = numberOfRays;
+    m_raysCapacity = numberOfRays;
     m_raysDistance = new double[m_numberOfRays];
     m_raysX = new double[m_numberOfRays];
     m_raysY = new double[m_numberOfRays];
@@ -96,10 +287,37 @@ void Raycaster::initialiseRaycaster(const unsigned int numberOfRays)
     m_raysTextureXIndex = new int[m_numberOfRays];
     m_raysTextureYStep = new double[m_numberOfRays];
     m_raysIsTextured = new bool[m_numberOfRays];
+    m_spans = new WallSpan[m_numberOfRays * MAX_SPANS];
+    m_numberOfSpans = new unsigned char[m_numberOfRays];
+    m_raysCell = new int[m_numberOfRays];
+    m_raysSide = new WallSide[m_numberOfRays];
+    m_previousRaysX = new double[m_numberOfRays];
+    m_previousRaysY = new double[m_numberOfRays];
+    m_previousRaysAngle = new double[m_numberOfRays];
+    m_previousRaysCell = new int[m_numberOfRays];
+    m_previousRaysSide = new WallSide[m_numberOfRays];
+    m_raysIsAnchor = new bool[m_numberOfRays];
+    m_anchors.resize(m_numberOfRays);
+    m_rayOffsets = new double[m_numberOfRays];
+    m_rayOffsetsCos = new double[m_numberOfRays];
+    m_rayOffsetsSin = new double[m_numberOfRays];
+    m_raysDirectionX = new double[m_numberOfRays];
+    m_raysDirectionY = new double[m_numberOfRays];
+    m_offsetsNumberOfRays = 0;
+    m_hasPreviousRays = false;
+}
+
+void Raycaster::setNumberOfRays(const unsigned int numberOfRays)
+{
+    // Ray buffers only grow: scaling the resolution down & up again does not reallocate
+    if (numberOfRays > m_raysCapacity)
+        initialiseRaycaster(numberOfRays);
+    m_numberOfRays = numberOfRays;
 }
 
 void Raycaster::calculateRaysDistance(Player &player, MapManager &mapManager, unsigned int fov)
 {
+    m_hasPreviousRays = false;
     const double angleStep = (double)fov * Math::DEGREE_TO_RADIAN / m_numberOfRays;
     const double renderDistance = 128;
     const double heigth = 1 * 0.5;
@@ -198,7 +416,7 @@ void Raycaster::calculateRaysDistance(Player &player, MapManager &mapManager, un
             rayPositionY += 1e-6 * rayDirectionY;
 
             // Check if the next block is a wall
-            blockHitIndex = mapManager.getMapElement((unsigned int)rayPositionX, (unsigned int)rayPositionY); 
+            blockHitIndex = mapManager.getMapElement(MapManager::positionToCell(rayPositionX), MapManager::positionToCell(rayPositionY));
             if (blockHitIndex != 0)
             {
                 isNextRayDistanceFound = true;
@@ -259,6 +477,13 @@ void Raycaster::calculateRaysDistance(Player &player, MapManager &mapManager, un
                     // Calculation of Y Step 
                     m_raysTextureYStep[i] = m_wallHeight[i] / TEXTURE_SIZE;
                 }
+                else if (blockHitIndex == MapManager::DOOR_ELEMENT)
+                {
+                    // Door
+                    m_raysColorR[i] = 160;
+                    m_raysColorG[i] = 100;
+                    m_raysColorB[i] = 40;
+                }
                 else 
                 {
                     // DEFAULT BLACK BLOCK
@@ -292,6 +517,7 @@ void Raycaster::calculateRaysDistance(Player &player, MapManager &mapManager, un
 
 void Raycaster::calculateRaysDistance_fishEyeAndRayDistributionCorrected(Player &player, MapManager &mapManager, unsigned int fov)
 {
+    m_hasPreviousRays = false;
     const double renderDistance = 128;
     const double fovRadian = (double)fov * Math::DEGREE_TO_RADIAN;
     const double angleStep = fovRadian / m_numberOfRays;
@@ -392,7 +618,7 @@ void Raycaster::calculateRaysDistance_fishEyeAndRayDistributionCorrected(Player
             rayPositionY += 1e-6 * rayDirectionY;
 
             // Check if the next block is a wall
-            blockHitIndex = mapManager.getMapElement((unsigned int)rayPositionX, (unsigned int)rayPositionY); 
+            blockHitIndex = mapManager.getMapElement(MapManager::positionToCell(rayPositionX), MapManager::positionToCell(rayPositionY));
             if (blockHitIndex != 0)
             {
                 isNextRayDistanceFound = true;
@@ -452,6 +678,13 @@ void Raycaster::calculateRaysDistance_fishEyeAndRayDistributionCorrected(Player
                     // Calculation of Y Step 
                     m_raysTextureYStep[i] = m_wallHeight[i] / TEXTURE_SIZE;
                 }
+                else if (blockHitIndex == MapManager::DOOR_ELEMENT)
+                {
+                    // Door
+                    m_raysColorR[i] = 160;
+                    m_raysColorG[i] = 100;
+                    m_raysColorB[i] = 40;
+                }
                 else 
                 {
                     // DEFAULT BLACK BLOCK
@@ -485,6 +718,9 @@ void Raycaster::calculateRaysDistance_fishEyeAndRayDistributionCorrected(Player
 
 void Raycaster::calculateRaysDistance_OMP(Player &player, MapManager &mapManager, unsigned int fov)
 {
+    m_isMultiHit = false;
+    m_hasPreviousRays = false;
+    m_numberOfCastRays = m_numberOfRays;
     const double renderDistance = 128;
     const double fovRadian = (double)fov * Math::DEGREE_TO_RADIAN;
     const double inverseLinearRayDistributionFactor = 2.0 / (m_numberOfRays * tan(0.5 * fovRadian));
@@ -586,7 +822,7 @@ void Raycaster::calculateRaysDistance_OMP(Player &player, MapManager &mapManager
             rayPositionY += 1e-6 * rayDirectionY;
 
             // Check if the next block is a wall
-            blockHitIndex = mapManager.getMapElement((unsigned int)rayPositionX, (unsigned int)rayPositionY); 
+            blockHitIndex = mapManager.getMapElement(MapManager::positionToCell(rayPositionX), MapManager::positionToCell(rayPositionY));
             if (blockHitIndex != 0)
             {
                 isNextRayDistanceFound = true;
@@ -652,6 +888,13 @@ void Raycaster::calculateRaysDistance_OMP(Player &player, MapManager &mapManager
                     m_raysColorG[i] = 255;
                     m_raysColorB[i] = 255;
                 }
+                else if (blockHitIndex == MapManager::DOOR_ELEMENT)
+                {
+                    // Door
+                    m_raysColorR[i] = 160;
+                    m_raysColorG[i] = 100;
+                    m_raysColorB[i] = 40;
+                }
                 else 
                 {
                     // DEFAULT BLACK BLOCK
@@ -682,6 +925,429 @@ void Raycaster::calculateRaysDistance_OMP(Player &player, MapManager &mapManager
     }
 }
 
+void Raycaster::calculateRaysAdaptive_OMP(Player &player, MapManager &mapManager, unsigned int fov, unsigned int stride)
+{
+    const int lastRay = (int)m_numberOfRays - 1;
+    const double playerX = player.getX();
+    const double playerY = player.getY();
+    const double playerAngle = player.getAngle();
+    m_isMultiHit = false;
+    stride = std::max(1u, stride);
+
+    updateRaysDirection(playerAngle, fov);
+
+    // Anchors: every stride-th ray & the last one
+    const int numberOfIntervals = (lastRay + stride - 1) / stride;
+#pragma omp parallel for
+    for (int i = 0; i <= lastRay; i += stride)
+        castRay(i, playerX, playerY, mapManager);
+    castRay(lastRay, playerX, playerY, mapManager);
+
+    // Rays between the anchors
+    unsigned int numberOfCastRays = numberOfIntervals + 1;
+#pragma omp parallel for schedule(dynamic) reduction(+ : numberOfCastRays)
+    for (int interval = 0; interval < numberOfIntervals; interval++)
+        numberOfCastRays += resolveRays(interval * stride, std::min<int>((interval + 1) * stride, lastRay), playerX, playerY, mapManager);
+    m_numberOfCastRays = numberOfCastRays;
+
+    // Every hit is known: the next temporal frame can start from this one
+    m_hasPreviousRays = true;
+    m_previousNumberOfRays = m_numberOfRays;
+}
+
+void Raycaster::calculateRaysTemporal_OMP(Player &player, MapManager &mapManager, unsigned int fov)
+{
+    const bool hasPreviousRays = m_hasPreviousRays;
+    swapPreviousRays();
+
+    const double inverseLinearRayDistributionFactor = 2.0 / (m_numberOfRays * tan(0.5 * fov * Math::DEGREE_TO_RADIAN));
+    const int halfNumberOfRays = m_numberOfRays >> 1;
+    const int lastRay = (int)m_numberOfRays - 1;
+    const double playerX = player.getX();
+    const double playerY = player.getY();
+    const double playerAngle = player.getAngle();
+    m_isMultiHit = false;
+    m_hasPreviousRays = true;
+
+    updateRaysDirection(playerAngle, fov);
+#pragma omp parallel for
+    for (int i = 0; i <= lastRay; i++)
+        m_raysIsAnchor[i] = false;
+
+    // Reproject the previous hits (in parallel): each previous ray lands on a (fractional) new
+    // column, where the hit face changes, the columns around the landing points are anchors
+    auto reprojectRay = [&](int ray)
+    {
+        double angle = m_previousRaysAngle[ray];
+        if (m_previousRaysCell[ray] >= 0)
+            angle = atan2(playerY - m_previousRaysY[ray], m_previousRaysX[ray] - playerX);
+        const double angleOffset = remainder(angle - playerAngle, 2 * M_PI);
+        if (std::fabs(angleOffset) >= 0.5 * M_PI)
+            return std::numeric_limits<double>::quiet_NaN();
+        return halfNumberOfRays + tan(angleOffset) / inverseLinearRayDistributionFactor;
+    };
+    double firstReprojectedColumn = std::numeric_limits<double>::infinity();
+    double lastReprojectedColumn = -std::numeric_limits<double>::infinity();
+    const int numberOfPreviousRays = hasPreviousRays ? m_previousNumberOfRays : 0;
+#pragma omp parallel for reduction(min : firstReprojectedColumn) reduction(max : lastReprojectedColumn)
+    for (int ray = 0; ray < numberOfPreviousRays; ray++)
+    {
+        const bool isFaceEnd = (ray == 0 || ray == (int)m_previousNumberOfRays - 1 || m_previousRaysCell[ray] < 0);
+        const bool isFaceChange = !isFaceEnd && (m_previousRaysCell[ray] != m_previousRaysCell[ray + 1] || m_previousRaysSide[ray] != m_previousRaysSide[ray + 1]);
+        if (!isFaceEnd && !isFaceChange && m_previousRaysCell[ray] == m_previousRaysCell[ray - 1] && m_previousRaysSide[ray] == m_previousRaysSide[ray - 1])
+            continue;
+
+        const double column = reprojectRay(ray);
+        if (std::isnan(column))
+            continue;
+        firstReprojectedColumn = std::min(firstReprojectedColumn, column);
+        lastReprojectedColumn = std::max(lastReprojectedColumn, column);
+        if (column > -1 && column < m_numberOfRays)
+        {
+            const int floorColumn = Math::limitToInterval<int>(floor(column), 0, lastRay);
+            const int ceilColumn = Math::limitToInterval<int>(ceil(column), 0, lastRay);
+#pragma omp atomic write
+            m_raysIsAnchor[floorColumn] = true;
+#pragma omp atomic write
+            m_raysIsAnchor[ceilColumn] = true;
+        }
+    }
+
+    // Anchor list, each thread compacts its block of columns: counted, offset, then written.
+    // Columns entering the view (or no previous frame) are anchors every TEMPORAL_STRIDE columns
+    m_anchors.resize(m_numberOfRays);
+    m_anchorsBlockOffset.resize(omp_get_max_threads() + 1);
+    int numberOfAnchors = 0;
+#pragma omp parallel
+    {
+        const int numberOfThreads = omp_get_num_threads();
+        const int thread = omp_get_thread_num();
+        const int firstColumn = (int)m_numberOfRays * thread / numberOfThreads;
+        const int lastColumn = (int)m_numberOfRays * (thread + 1) / numberOfThreads - 1;
+        int numberOfBlockAnchors = 0;
+        for (int i = firstColumn; i <= lastColumn; i++)
+        {
+            if (i == 0 || i == lastRay || (i % TEMPORAL_STRIDE == 0 && (i < firstReprojectedColumn || i > lastReprojectedColumn)))
+                m_raysIsAnchor[i] = true;
+            numberOfBlockAnchors += m_raysIsAnchor[i];
+        }
+        m_anchorsBlockOffset[thread + 1] = numberOfBlockAnchors;
+
+#pragma omp barrier
+#pragma omp single
+        {
+            m_anchorsBlockOffset[0] = 0;
+            for (int i = 1; i <= numberOfThreads; i++)
+                m_anchorsBlockOffset[i] += m_anchorsBlockOffset[i - 1];
+            numberOfAnchors = m_anchorsBlockOffset[numberOfThreads];
+        }
+
+        int anchor = m_anchorsBlockOffset[thread];
+        for (int i = firstColumn; i <= lastColumn; i++)
+            if (m_raysIsAnchor[i])
+                m_anchors[anchor++] = i;
+    }
+
+    // Cast the anchors, the rays between two anchors are checked like the adaptive ones
+    // (same face at both ends: exact intersection, otherwise bisection)
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int anchor = 0; anchor < numberOfAnchors; anchor++)
+        castRay(m_anchors[anchor], playerX, playerY, mapManager);
+
+    unsigned int numberOfCastRays = numberOfAnchors;
+#pragma omp parallel for schedule(dynamic, 16) reduction(+ : numberOfCastRays)
+    for (int anchor = 0; anchor < numberOfAnchors - 1; anchor++)
+        numberOfCastRays += resolveRays(m_anchors[anchor], m_anchors[anchor + 1], playerX, playerY, mapManager);
+    m_numberOfCastRays = numberOfCastRays;
+    m_previousNumberOfRays = m_numberOfRays;
+}
+
+void Raycaster::swapPreviousRays()
+{
+    std::swap(m_raysX, m_previousRaysX);
+    std::swap(m_raysY, m_previousRaysY);
+    std::swap(m_raysAngle, m_previousRaysAngle);
+    std::swap(m_raysCell, m_previousRaysCell);
+    std::swap(m_raysSide, m_previousRaysSide);
+}
+
+void Raycaster::updateRaysDirection(const double playerAngle, const unsigned int fov)
+{
+    // Angle offsets only change with the number of rays & the fov
+    if (m_offsetsNumberOfRays != m_numberOfRays || m_offsetsFov != fov)
+    {
+        const double inverseLinearRayDistributionFactor = 2.0 / (m_numberOfRays * tan(0.5 * fov * Math::DEGREE_TO_RADIAN));
+        const int halfNumberOfRays = m_numberOfRays >> 1;
+        for (int i = 0; i < (int)m_numberOfRays; i++)
+        {
+            m_rayOffsets[i] = atan(inverseLinearRayDistributionFactor * (i - halfNumberOfRays));
+            m_rayOffsetsCos[i] = cos(m_rayOffsets[i]);
+            m_rayOffsetsSin[i] = sin(m_rayOffsets[i]);
+        }
+        m_offsetsNumberOfRays = m_numberOfRays;
+        m_offsetsFov = fov;
+    }
+
+    // Directions: offsets rotated by the player angle
+    const double cosPlayerAngle = cos(playerAngle);
+    const double sinPlayerAngle = sin(playerAngle);
+    for (unsigned int i = 0; i < m_numberOfRays; i++)
+    {
+        m_raysAngle[i] = playerAngle + m_rayOffsets[i];
+        m_raysDirectionX[i] = cosPlayerAngle * m_rayOffsetsCos[i] - sinPlayerAngle * m_rayOffsetsSin[i];
+        m_raysDirectionY[i] = -(sinPlayerAngle * m_rayOffsetsCos[i] + cosPlayerAngle * m_rayOffsetsSin[i]);
+    }
+}
+
+unsigned int Raycaster::resolveRays(const int first, const int last, const double playerX, const double playerY, const MapManager &mapManager)
+{
+    if (last - first < 2)
+        return 0;
+
+    // Same cell face: the wedge between the two rays is narrower than a cell (both hits are on
+    // the same unit face) and the cells crossed by its sides are free, so no wall can be inside
+    if (m_raysCell[first] >= 0 && m_raysCell[first] == m_raysCell[last] && m_raysSide[first] == m_raysSide[last])
+    {
+        for (int i = first + 1; i < last; i++)
+        {
+            m_raysCell[i] = m_raysCell[first];
+            m_raysSide[i] = m_raysSide[first];
+            intersectFace(i, playerX, playerY, mapManager, m_raysCell[first], m_raysSide[first]);
+        }
+        return 0;
+    }
+
+    const int middle = (first + last) / 2;
+    castRay(middle, playerX, playerY, mapManager);
+    return 1 + resolveRays(first, middle, playerX, playerY, mapManager) + resolveRays(middle, last, playerX, playerY, mapManager);
+}
+
+void Raycaster::castRay(const int i, const double playerX, const double playerY, const MapManager &mapManager)
+{
+    const double renderDistance = 128;
+    const double rayDirectionX = m_raysDirectionX[i];
+    const double rayDirectionY = m_raysDirectionY[i];
+
+    // Grid traversal (DDA), only finds the face: the hit itself is computed by intersectFace
+    int cellX = (int)playerX;
+    int cellY = (int)playerY;
+    const int stepX = (rayDirectionX < 0) ? -1 : 1;
+    const int stepY = (rayDirectionY < 0) ? -1 : 1;
+    const double deltaDistanceX = (rayDirectionX == 0) ? std::numeric_limits<double>::infinity() : std::fabs(1 / rayDirectionX);
+    const double deltaDistanceY = (rayDirectionY == 0) ? std::numeric_limits<double>::infinity() : std::fabs(1 / rayDirectionY);
+    double sideDistanceX = (rayDirectionX < 0) ? (playerX - cellX) * deltaDistanceX : (cellX + 1 - playerX) * deltaDistanceX;
+    double sideDistanceY = (rayDirectionY < 0) ? (playerY - cellY) * deltaDistanceY : (cellY + 1 - playerY) * deltaDistanceY;
+
+    for (int j = 0; j < renderDistance; j++)
+    {
+        WallSide sideHit;
+        if (sideDistanceX < sideDistanceY)
+        {
+            sideDistanceX += deltaDistanceX;
+            cellX += stepX;
+            sideHit = (rayDirectionX > 0) ? WallSide::west : WallSide::east;
+        }
+        else
+        {
+            sideDistanceY += deltaDistanceY;
+            cellY += stepY;
+            sideHit = (rayDirectionY > 0) ? WallSide::south : WallSide::north;
+        }
+
+        // The map's sentinel ring ends the traversal, no bounds checks
+        const char blockHitIndex = mapManager.getMapElement(cellX, cellY);
+        if (blockHitIndex != 0)
+        {
+            if (blockHitIndex == MapManager::OUTSIDE_ELEMENT)
+                break;
+            m_raysCell[i] = mapManager.coordinateToIndex(cellX, cellY);
+            m_raysSide[i] = sideHit;
+            intersectFace(i, playerX, playerY, mapManager, m_raysCell[i], sideHit);
+            return;
+        }
+    }
+
+    m_raysCell[i] = -1;
+    m_raysDistance[i] = std::numeric_limits<double>::infinity();
+    m_raysX[i] = std::numeric_limits<double>::infinity();
+    m_raysY[i] = std::numeric_limits<double>::infinity();
+    m_wallHeight[i] = 0;
+    m_raysIsTextured[i] = false;
+}
+
+void Raycaster::intersectFace(const int i, const double playerX, const double playerY, const MapManager &mapManager, const int cell, const WallSide side)
+{
+    const int cellX = cell % mapManager.getWidth();
+    const int cellY = cell / mapManager.getWidth();
+    const double rayDirectionX = m_raysDirectionX[i];
+    const double rayDirectionY = m_raysDirectionY[i];
+
+    // Ray & face plane intersection
+    double distance;
+    if (side == WallSide::west || side == WallSide::east)
+        distance = ((side == WallSide::west ? cellX : cellX + 1) - playerX) / rayDirectionX;
+    else
+        distance = ((side == WallSide::south ? cellY : cellY + 1) - playerY) / rayDirectionY;
+    m_raysX[i] = playerX + rayDirectionX * distance;
+    m_raysY[i] = playerY + rayDirectionY * distance;
+    m_raysDistance[i] = distance * m_rayOffsetsCos[i];
+    m_wallHeight[i] = 1 / m_raysDistance[i];
+
+    const char blockHitIndex = mapManager.getMapElement(cellX, cellY);
+    const SDL_Color &color = MapManager::getMaterial(blockHitIndex).color;
+    m_raysLightFactor[i] = Math::limitToInterval<double>(1 - (distance * 0.05), 0, 1);
+    m_raysColorR[i] = color.r * m_raysLightFactor[i];
+    m_raysColorG[i] = color.g * m_raysLightFactor[i];
+    m_raysColorB[i] = color.b * m_raysLightFactor[i];
+
+    m_raysIsTextured[i] = (blockHitIndex == 5);
+    if (m_raysIsTextured[i])
+    {
+        // Position along the face, in the cell
+        double u;
+        if (side == WallSide::south)
+            u = m_raysX[i] - cellX;
+        else if (side == WallSide::north)
+            u = 1 - (m_raysX[i] - cellX);
+        else if (side == WallSide::east)
+            u = m_raysY[i] - cellY;
+        else
+            u = 1 - (m_raysY[i] - cellY);
+        m_raysTextureXIndex[i] = Math::limitToInterval<int>(u * TEXTURE_SIZE, 0, TEXTURE_SIZE - 1);
+        m_raysTextureYStep[i] = m_wallHeight[i] / TEXTURE_SIZE;
+    }
+}
+
+void Raycaster::calculateRaysSpans_OMP(Player &player, MapManager &mapManager, unsigned int fov)
+{
+    const double inverseLinearRayDistributionFactor = 2.0 / (m_numberOfRays * tan(0.5 * fov * Math::DEGREE_TO_RADIAN));
+    const int halfNumberOfRays = m_numberOfRays >> 1;
+    const double playerX = player.getX();
+    const double playerY = player.getY();
+    const double playerAngle = player.getAngle();
+    const double maximumHeight = mapManager.getMaximumHeight();
+    m_isMultiHit = true;
+    m_hasPreviousRays = false;
+    m_numberOfCastRays = m_numberOfRays;
+
+#pragma omp parallel for
+    for (int i = 0; i < (int)m_numberOfRays; i++)
+    {
+        const double rayAngleOffset = atan(inverseLinearRayDistributionFactor * (i - halfNumberOfRays));
+        m_raysAngle[i] = playerAngle + rayAngleOffset;
+        m_numberOfSpans[i] = castSpans(mapManager, playerX, playerY, cos(m_raysAngle[i]), -sin(m_raysAngle[i]), cos(rayAngleOffset), maximumHeight, m_spans + i * MAX_SPANS,
+                                       m_raysDistance[i], m_raysX[i], m_raysY[i], m_raysLightFactor[i]);
+    }
+}
+
+unsigned int Raycaster::castSpans(const MapManager &mapManager, const double x, const double y, const double rayDirectionX, const double rayDirectionY, const double cosRayAngleOffset, const double maximumHeight,
+                                  WallSpan *spans, double &depth, double &firstHitX, double &firstHitY, double &firstLightFactor)
+{
+    const double renderDistance = 128;
+
+    // Grid traversal (DDA)
+    int cellX = (int)x;
+    int cellY = (int)y;
+    const int stepX = (rayDirectionX < 0) ? -1 : 1;
+    const int stepY = (rayDirectionY < 0) ? -1 : 1;
+    const double deltaDistanceX = (rayDirectionX == 0) ? std::numeric_limits<double>::infinity() : std::fabs(1 / rayDirectionX);
+    const double deltaDistanceY = (rayDirectionY == 0) ? std::numeric_limits<double>::infinity() : std::fabs(1 / rayDirectionY);
+    double sideDistanceX = (rayDirectionX < 0) ? (x - cellX) * deltaDistanceX : (cellX + 1 - x) * deltaDistanceX;
+    double sideDistanceY = (rayDirectionY < 0) ? (y - cellY) * deltaDistanceY : (cellY + 1 - y) * deltaDistanceY;
+
+    // Nearest opaque wall is the depth (sprites), the first hit feeds the minimap
+    depth = std::numeric_limits<double>::infinity();
+    firstHitX = std::numeric_limits<double>::infinity();
+    firstHitY = std::numeric_limits<double>::infinity();
+    firstLightFactor = 0;
+
+    // Front to back: rows below coveredTop are hidden by nearer opaque walls (they all stand
+    // on the floor, so the coverage of a column is a single interval), stop once it is full
+    unsigned int numberOfSpans = 0;
+    double coveredTop = std::numeric_limits<double>::infinity();
+    bool isFirstHit = true;
+    for (int j = 0; j < renderDistance && numberOfSpans < MAX_SPANS && coveredTop > 0; j++)
+    {
+        double distance;
+        WallSide sideHit;
+        if (sideDistanceX < sideDistanceY)
+        {
+            distance = sideDistanceX;
+            sideDistanceX += deltaDistanceX;
+            cellX += stepX;
+            sideHit = (rayDirectionX > 0) ? WallSide::west : WallSide::east;
+        }
+        else
+        {
+            distance = sideDistanceY;
+            sideDistanceY += deltaDistanceY;
+            cellY += stepY;
+            sideHit = (rayDirectionY > 0) ? WallSide::south : WallSide::north;
+        }
+
+        const char blockHitIndex = mapManager.getMapElement(cellX, cellY);
+        if (blockHitIndex == 0)
+            continue;
+        if (blockHitIndex == MapManager::OUTSIDE_ELEMENT)
+            break;
+
+        const Material &material = MapManager::getMaterial(blockHitIndex);
+        const double hitX = x + rayDirectionX * distance;
+        const double hitY = y + rayDirectionY * distance;
+        const double correctedDistance = distance * cosRayAngleOffset;
+        const double lightFactor = Math::limitToInterval<double>(1 - (distance * 0.05), 0, 1);
+        if (isFirstHit)
+        {
+            isFirstHit = false;
+            firstHitX = hitX;
+            firstHitY = hitY;
+            firstLightFactor = lightFactor;
+        }
+
+        // Camera at half a cell: the floor line & the top of the wall
+        const double floorLine = 0.5 + 0.5 / correctedDistance;
+        const double wallTop = floorLine - material.height / correctedDistance;
+        const double visibleBottom = std::min(floorLine, coveredTop);
+        if (visibleBottom > std::max(0.0, wallTop))
+        {
+            WallSpan &span = spans[numberOfSpans++];
+            span.distance = correctedDistance;
+            span.wallTop = wallTop;
+            span.wallHeight = material.height / correctedDistance;
+            span.visibleTop = std::max(0.0, wallTop);
+            span.visibleBottom = visibleBottom;
+            span.color = SDL_Color { (Uint8)(material.color.r * lightFactor), (Uint8)(material.color.g * lightFactor), (Uint8)(material.color.b * lightFactor), material.color.a };
+            span.isTextured = (blockHitIndex == 5);
+            span.isSeeThrough = material.isSeeThrough;
+            span.textureXIndex = 0;
+            if (span.isTextured)
+            {
+                if (sideHit == WallSide::south)
+                    span.textureXIndex = (hitX - (int)hitX) * TEXTURE_SIZE;
+                else if (sideHit == WallSide::north)
+                    span.textureXIndex = (1 - (hitX - (int)hitX)) * TEXTURE_SIZE;
+                else if (sideHit == WallSide::east)
+                    span.textureXIndex = (hitY - (int)hitY) * TEXTURE_SIZE;
+                else
+                    span.textureXIndex = (1 - (hitY - (int)hitY)) * TEXTURE_SIZE;
+                span.textureXIndex = Math::limitToInterval<int>(span.textureXIndex, 0, TEXTURE_SIZE - 1);
+            }
+        }
+
+        if (!material.isSeeThrough)
+        {
+            coveredTop = std::min(coveredTop, wallTop);
+            if (std::isinf(depth))
+                depth = correctedDistance;
+
+            // The highest wall further away can not rise above the coverage anymore
+            if (coveredTop <= 0.5 - (maximumHeight - 0.5) / (std::min(sideDistanceX, sideDistanceY) * cosRayAngleOffset))
+                break;
+        }
+    }
+    return numberOfSpans;
+}
+
 void Raycaster::SDL_renderRaycast2DMap(SDL_Renderer *renderer, MapManager &mapManager, Player &player, const unsigned int screenWidth, const unsigned int screenHeigth)
 {
     int x1 = player.getX() * screenWidth / mapManager.getWidth();
@@ -751,15 +1417,24 @@ void Raycaster::SDL_renderRaycastBackground(SDL_Renderer *renderer, const double
         brightness -= maxBrightness * 2 / screenHeigth;  
         j--;
     }
+    m_numberOfDrawCalls = 2 * (screenHeigth / 2);
 }
 
 void Raycaster::SDL_renderRaycast(SDL_Renderer *renderer, const double currentVelocity, const double time, const unsigned int screenWidth, const unsigned int screenHeigth)
 {
-    double xStep = screenWidth / m_numberOfRays;
-    int x = (m_numberOfRays - 1) * xStep;
+    if (m_isMultiHit)
+    {
+        SDL_renderRaycastSpans(renderer, screenWidth, screenHeigth);
+        return;
+    }
+
+    // Fractional column width (scaled resolution): columns cover [x, next x[ without gaps
+    const double xStep = (double)screenWidth / m_numberOfRays;
     
     for(unsigned int i = 0; i < m_numberOfRays; i++)
     {
+        const int x = (m_numberOfRays - 1 - i) * xStep;
+        const int width = (int)((m_numberOfRays - i) * xStep) - x;
         SDL_Rect rectangle;
         if (m_raysIsTextured[i])
         {
@@ -783,8 +1458,9 @@ void Raycaster::SDL_renderRaycast(SDL_Renderer *renderer, const double currentVe
                 b = color.b * (double)m_raysColorB[i] / 255;
                 a = color.a;
                 SDL_SetRenderDrawColor(renderer, r, g, b, a);
-                rectangle = { x, (int)(y + m_movingOffset), (int)xStep, (int)yStep + 1 };
+                rectangle = { x, (int)(y + m_movingOffset), width, (int)yStep + 1 };
                 SDL_RenderFillRect(renderer, &rectangle);
+                m_numberOfDrawCalls++;
                 y = nextY;
             }
         }
@@ -793,9 +1469,207 @@ void Raycaster::SDL_renderRaycast(SDL_Renderer *renderer, const double currentVe
             SDL_SetRenderDrawColor(renderer, m_raysColorR[i], m_raysColorG[i], m_raysColorB[i], 255);
             int h = m_wallHeight[i] * screenHeigth;
             int y = (screenHeigth - m_wallHeight[i] * screenHeigth) / 2;
-            rectangle = { x, (int)(y + m_movingOffset), (int)xStep, h };
+            rectangle = { x, (int)(y + m_movingOffset), width, h };
             SDL_RenderFillRect(renderer, &rectangle);
+            m_numberOfDrawCalls++;
+        }
+    }
+}
+
+void Raycaster::SDL_renderRaycastSpans(SDL_Renderer *renderer, const unsigned int screenWidth, const unsigned int screenHeigth)
+{
+    // Opaque spans never overlap (clipped by the coverage), see-through ones are blended over
+    // what is behind them: back to front within each column
+    const double xStep = (double)screenWidth / m_numberOfRays;
+    for (unsigned int i = 0; i < m_numberOfRays; i++)
+    {
+        const int x = (m_numberOfRays - 1 - i) * xStep;
+        const int width = (int)((m_numberOfRays - i) * xStep) - x;
+        const WallSpan *spans = m_spans + i * MAX_SPANS;
+        for (int k = m_numberOfSpans[i] - 1; k >= 0; k--)
+        {
+            const WallSpan &span = spans[k];
+            const double visibleTop = span.visibleTop * screenHeigth;
+            const double visibleBottom = std::min(span.visibleBottom, 1.0) * screenHeigth;
+            SDL_Rect rectangle;
+            if (!span.isTextured)
+            {
+                SDL_SetRenderDrawColor(renderer, span.color.r, span.color.g, span.color.b, span.color.a);
+                rectangle = { x, (int)(visibleTop + m_movingOffset), width, (int)(visibleBottom - visibleTop) + 1 };
+                SDL_RenderFillRect(renderer, &rectangle);
+                m_numberOfDrawCalls++;
+                continue;
+            }
+
+            // Texels of the visible part only
+            const double yStep = span.wallHeight * screenHeigth / TEXTURE_SIZE;
+            const double wallTop = span.wallTop * screenHeigth;
+            const int firstTexel = Math::limitToInterval<int>((visibleTop - wallTop) / yStep, 0, TEXTURE_SIZE - 1);
+            const int lastTexel = Math::limitToInterval<int>((visibleBottom - wallTop) / yStep, 0, TEXTURE_SIZE - 1);
+            for (int j = firstTexel; j <= lastTexel; j++)
+            {
+                const double y0 = std::max(visibleTop, wallTop + j * yStep);
+                const double y1 = std::min(visibleBottom, wallTop + (j + 1) * yStep);
+                const SDL_Color &texel = m_texture[span.textureXIndex + j * TEXTURE_SIZE];
+                SDL_SetRenderDrawColor(renderer, texel.r * span.color.r / 255, texel.g * span.color.g / 255, texel.b * span.color.b / 255, span.color.a);
+                rectangle = { x, (int)(y0 + m_movingOffset), width, (int)(y1 - y0) + 1 };
+                SDL_RenderFillRect(renderer, &rectangle);
+                m_numberOfDrawCalls++;
+            }
+        }
+    }
+}
+
+bool Raycaster::SDL_renderRaycastGeometry(SDL_Renderer *renderer, GeometryBatch &batch, const double currentVelocity, const double time, const unsigned int screenWidth, const unsigned int screenHeigth)
+{
+    m_movingOffset = MOVING_OFFSET_MAGNITUDE * currentVelocity * cos(4 * M_PI * time) / screenHeigth;
+    if (!batch.hasTexture() && !batch.SDL_loadTexture(renderer, m_texture, TEXTURE_SIZE))
+        return false;
+    batch.clear();
+    batch.reserve(2 + m_numberOfRays * (m_isMultiHit ? MAX_SPANS : 1));
+    bool isSuccess = true;
+
+    // Background: the gradients of SDL_renderRaycastBackground as vertex colors
+    const Uint8 maxBrightness = 45;
+    const Uint8 minBrightness = maxBrightness - (screenHeigth / 2) * maxBrightness * 2 / screenHeigth;
+    const SDL_Color brightColor = { maxBrightness, maxBrightness, maxBrightness, 255 };
+    const SDL_Color darkColor = { minBrightness, minBrightness, minBrightness, 255 };
+    batch.addSolidQuad(0, m_movingOffset, screenWidth, screenHeigth / 2 + m_movingOffset, brightColor, darkColor);
+    batch.addSolidQuad(0, screenHeigth - screenHeigth / 2 + m_movingOffset, screenWidth, screenHeigth + m_movingOffset, darkColor, brightColor);
+    isSuccess &= batch.SDL_submit(renderer, false);
+
+    // Walls: one quad per column (per span with multi-hit, back to front), the light as vertex color
+    const double xStep = (double)screenWidth / m_numberOfRays;
+    for (unsigned int i = 0; i < m_numberOfRays; i++)
+    {
+        const int x0 = (m_numberOfRays - 1 - i) * xStep;
+        const int x1 = (int)((m_numberOfRays - i) * xStep);
+        if (!m_isMultiHit)
+        {
+            const double wallHeight = m_wallHeight[i] * screenHeigth;
+            const double wallTop = 0.5 * (screenHeigth - wallHeight) + m_movingOffset;
+            const SDL_Color color = { m_raysColorR[i], m_raysColorG[i], m_raysColorB[i], 255 };
+            if (m_raysIsTextured[i])
+                batch.addQuad(x0, wallTop, x1, wallTop + wallHeight, color, color, m_raysTextureXIndex[i] + 0.5f, 0, TEXTURE_SIZE);
+            else
+                batch.addSolidQuad(x0, wallTop, x1, wallTop + wallHeight, color, color);
+            continue;
+        }
+
+        const WallSpan *spans = m_spans + i * MAX_SPANS;
+        for (int k = m_numberOfSpans[i] - 1; k >= 0; k--)
+        {
+            const WallSpan &span = spans[k];
+            const double visibleBottom = std::min(span.visibleBottom, 1.0);
+            const float y0 = span.visibleTop * screenHeigth + m_movingOffset;
+            const float y1 = visibleBottom * screenHeigth + m_movingOffset;
+            if (span.isTextured)
+                batch.addQuad(x0, y0, x1, y1, span.color, span.color, span.textureXIndex + 0.5f, (span.visibleTop - span.wallTop) / span.wallHeight * TEXTURE_SIZE, (visibleBottom - span.wallTop) / span.wallHeight * TEXTURE_SIZE);
+            else
+                batch.addSolidQuad(x0, y0, x1, y1, span.color, span.color);
         }
-        x -= xStep;
     }
+    isSuccess &= batch.SDL_submit(renderer, true);
+    m_numberOfDrawCalls = batch.getNumberOfDrawCalls();
+
+    return isSuccess;
+}
+
+void Raycaster::renderRaycastFrameBuffer(FrameBuffer &frameBuffer, const double currentVelocity, const double time)
+{
+    // Scaled frame buffer: the columns drawn, upscaled to the frame afterwards
+    const int width = frameBuffer.getDrawWidth();
+    const int height = frameBuffer.getHeight();
+    m_movingOffset = MOVING_OFFSET_MAGNITUDE * currentVelocity * cos(4 * M_PI * time) / height;
+    m_numberOfDrawCalls = 0;
+    const int rowOffset = m_movingOffset;
+
+    // Background: same gradient as SDL_renderRaycastBackground (rows it does not cover keep
+    // the clear color), the same for every column
+    const double maxBrightness = 45;
+    std::vector<Uint32> &background = m_backgroundColumn;
+    background.resize(height);
+    for (int y = 0; y < height; y++)
+    {
+        const int row = y - rowOffset;
+        Uint8 brightness = 70;
+        if (row >= 0 && row < height / 2)
+            brightness = maxBrightness - row * maxBrightness * 2 / height;
+        else if (row >= height - height / 2 && row < height)
+            brightness = maxBrightness - (height - 1 - row) * maxBrightness * 2 / height;
+        background[y] = FrameBuffer::packColor(brightness, brightness, brightness);
+    }
+    if (frameBuffer.isColumnMajor())
+    {
+#pragma omp parallel for
+        for (int x = 0; x < width; x++)
+            std::copy(background.begin(), background.end(), frameBuffer.getColumn(x));
+    }
+    else
+    {
+        Uint32 *pixels = frameBuffer.getColumn(0);
+#pragma omp parallel for
+        for (int y = 0; y < height; y++)
+            std::fill(pixels + y * width, pixels + (y + 1) * width, background[y]);
+    }
+
+    // Walls, ray i covers the screen columns [(N - 1 - i) * xStep, (N - i) * xStep[
+    const double xStep = (double)width / m_numberOfRays;
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int i = 0; i < (int)m_numberOfRays; i++)
+    {
+        const int firstX = (m_numberOfRays - 1 - i) * xStep;
+        const int lastX = (int)((m_numberOfRays - i) * xStep);
+        if (!m_isMultiHit)
+        {
+            if (m_wallHeight[i] <= 0)
+                continue;
+            const double wallHeight = m_wallHeight[i] * height;
+            const double wallTop = 0.5 * (height - wallHeight) + m_movingOffset;
+            drawWallSpan(frameBuffer, firstX, lastX, wallTop, wallHeight, wallTop, wallTop + wallHeight, m_raysIsTextured[i], m_raysTextureXIndex[i], SDL_Color { m_raysColorR[i], m_raysColorG[i], m_raysColorB[i], 255 });
+            continue;
+        }
+
+        // Back to front, see-through spans blend over what is behind them
+        const WallSpan *spans = m_spans + i * MAX_SPANS;
+        for (int k = m_numberOfSpans[i] - 1; k >= 0; k--)
+        {
+            const WallSpan &span = spans[k];
+            drawWallSpan(frameBuffer, firstX, lastX, span.wallTop * height + m_movingOffset, span.wallHeight * height, span.visibleTop * height + m_movingOffset, span.visibleBottom * height + m_movingOffset, span.isTextured, span.textureXIndex, span.color);
+        }
+    }
+}
+
+void Raycaster::drawWallSpan(FrameBuffer &frameBuffer, const int firstX, const int lastX, const double wallTop, const double wallHeight, double visibleTop, double visibleBottom, const bool isTextured, const int textureXIndex, const SDL_Color color)
+{
+    // Pixels whose center is in the visible part, clipped to the screen once for the whole span
+    const int height = frameBuffer.getHeight();
+    const int stride = frameBuffer.getColumnStride();
+    const int firstY = Math::limitToInterval<double>(ceil(visibleTop - 0.5), 0, height);
+    const int lastY = Math::limitToInterval<double>(ceil(visibleBottom - 0.5), 0, height);
+    const int count = lastY - firstY;
+    if (count <= 0)
+        return;
+
+    if (!isTextured)
+    {
+        const Uint32 packedColor = FrameBuffer::packColor(color.r, color.g, color.b);
+        for (int x = firstX; x < lastX; x++)
+        {
+            if (color.a == 255)
+                FrameBuffer::fillColumnSolid(frameBuffer.getColumn(x) + firstY * stride, stride, count, packedColor);
+            else
+                FrameBuffer::blendColumnSolid(frameBuffer.getColumn(x) + firstY * stride, stride, count, packedColor, color.a);
+        }
+        return;
+    }
+
+    // Texture v (16.16) at the first pixel center, the light is the white texture shade
+    const double vScale = TEXTURE_SIZE * 65536.0 / wallHeight;
+    const unsigned int v = (firstY + 0.5 - wallTop) * vScale;
+    const unsigned int vStep = vScale;
+    const unsigned int shade = (color.r * 256 + 127) / 255;
+    const Uint32 *textureColumn = m_textureColumns.data() + textureXIndex * TEXTURE_SIZE;
+    for (int x = firstX; x < lastX; x++)
+        FrameBuffer::fillColumnTextured(frameBuffer.getColumn(x) + firstY * stride, stride, count, textureColumn, TEXTURE_SIZE - 1, v, vStep, shade);
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <cmath>
+
+#include "ResolutionController.hpp"
+#include "Toolbox.hpp"
+
+ResolutionController::ResolutionController()
+{
+    m_budget = 0;
+    m_scale = MAX_SCALE;
+    m_averageFrameTime = 0;
+    m_cooldown = 0;
+}
+
+void ResolutionController::setBudget(double budgetMilliseconds)
+{
+    m_budget = std::max(0.0, budgetMilliseconds);
+    m_scale = MAX_SCALE;
+    m_averageFrameTime = m_budget;
+    m_cooldown = COOLDOWN_FRAMES;
+}
+
+bool ResolutionController::update(double frameTimeMilliseconds)
+{
+    if (!isEnabled())
+        return false;
+
+    m_averageFrameTime += SMOOTHING_FACTOR * (frameTimeMilliseconds - m_averageFrameTime);
+    if (m_cooldown > 0)
+    {
+        m_cooldown--;
+        return false;
+    }
+
+    // Casting cost is about linear in the number of rays: jump to the scale that fits
+    // (aiming inside the headroom band so it does not grow back at once), grow step by step
+    double scale = m_scale;
+    if (m_averageFrameTime > m_budget)
+        scale = m_scale * TARGET * m_budget / m_averageFrameTime;
+    else if (m_averageFrameTime < HEADROOM * m_budget)
+        scale = m_scale * SCALE_UP_FACTOR;
+    scale = Math::limitToInterval<double>(scale, MIN_SCALE, MAX_SCALE);
+
+    if (std::fabs(scale - m_scale) < 1e-3)
+        return false;
+
+    // Expected average at the new scale, the next frames correct it
+    m_averageFrameTime *= scale / m_scale;
+    m_scale = scale;
+    m_cooldown = COOLDOWN_FRAMES;
+    return true;
+}
+
+unsigned int ResolutionController::getNumberOfRays(unsigned int screenWidth) const
+{
+    return std::min(screenWidth, std::max(MIN_NUMBER_OF_RAYS, (unsigned int)std::lround(m_scale * screenWidth)));
+}
\ No newline at end of file
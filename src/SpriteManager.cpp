@@ -0,0 +1,498 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "SpriteManager.hpp"
+#include "SDL.h"
+#include "Toolbox.hpp"
+
+SpriteManager::SpriteManager()
+{
+    m_maximumSize = 0;
+    m_gridWidth = 0;
+    m_gridHeight = 0;
+    m_visibleSprites = nullptr;
+    m_drawOrder = nullptr;
+    m_depthKeys = nullptr;
+    m_depth = nullptr;
+    m_lateralOffset = nullptr;
+    m_tilesMaxDistance = nullptr;
+    m_numberOfCandidateSprites = 0;
+    m_numberOfVisibleSprites = 0;
+    m_numberOfDrawnSprites = 0;
+    m_visibilitySet = nullptr;
+    m_texture = nullptr;
+    m_textureSize = 0;
+}
+
+SpriteManager::~SpriteManager()
+{
+    SDL_releaseTextures();
+}
+
+void SpriteManager::SDL_releaseTextures()
+{
+    if (m_texture != nullptr)
+        SDL_DestroyTexture(m_texture);
+    m_texture = nullptr;
+}
+
+void SpriteManager::initialiseSprites(const MapManager &mapManager)
+{
+    clear();
+    m_gridWidth = mapManager.getWidth();
+    m_gridHeight = mapManager.getHeight();
+    m_cellSprites.assign(m_gridWidth * m_gridHeight, std::vector<unsigned int>());
+}
+
+bool SpriteManager::loadTexture(SDL_Renderer *renderer, const char *path)
+{
+    SDL_Surface *surface = SDL_LoadBMP(path);
+    if (surface == nullptr)
+        return false;
+
+    // The red background of the sprite bitmaps is transparent
+    SDL_SetColorKey(surface, SDL_TRUE, SDL_MapRGB(surface->format, 237, 28, 36));
+    m_texture = SDL_CreateTextureFromSurface(renderer, surface);
+    m_textureSize = surface->w;
+    SDL_FreeSurface(surface);
+
+    return m_texture != nullptr;
+}
+
+bool SpriteManager::loadTexture(SDL_Renderer *renderer, const Uint32 *pixels, const int size)
+{
+    SDL_releaseTextures();
+
+    m_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, size, size);
+    if (m_texture == nullptr)
+        return false;
+    if (SDL_UpdateTexture(m_texture, nullptr, pixels, size * sizeof(Uint32)) != 0)
+    {
+        SDL_releaseTextures();
+        return false;
+    }
+    SDL_SetTextureBlendMode(m_texture, SDL_BLENDMODE_BLEND);
+    m_textureSize = size;
+
+    return true;
+}
+
+unsigned int SpriteManager::addSprite(const double x, const double y, const double size, const SDL_Color color)
+{
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_size.push_back(size);
+    m_color.push_back(color);
+    m_maximumSize = std::max(m_maximumSize, size);
+
+    const unsigned int sprite = m_x.size() - 1;
+    const unsigned int cell = positionToCell(x, y);
+    m_spriteCell.push_back(cell);
+    m_spriteSlot.push_back(m_cellSprites[cell].size());
+    m_cellSprites[cell].push_back(sprite);
+
+    return sprite;
+}
+
+void SpriteManager::setSpritePosition(const unsigned int sprite, const double x, const double y)
+{
+    m_x[sprite] = x;
+    m_y[sprite] = y;
+
+    const unsigned int cell = positionToCell(x, y);
+    if (cell == m_spriteCell[sprite])
+        return;
+
+    // Swap with the old bucket's last sprite, then append to the new one
+    std::vector<unsigned int> &cellSprites = m_cellSprites[m_spriteCell[sprite]];
+    const unsigned int lastSprite = cellSprites.back();
+    cellSprites[m_spriteSlot[sprite]] = lastSprite;
+    m_spriteSlot[lastSprite] = m_spriteSlot[sprite];
+    cellSprites.pop_back();
+
+    m_spriteCell[sprite] = cell;
+    m_spriteSlot[sprite] = m_cellSprites[cell].size();
+    m_cellSprites[cell].push_back(sprite);
+}
+
+void SpriteManager::addRandomSprites(MapManager &mapManager, const unsigned int count, const unsigned long long seed)
+{
+    std::default_random_engine generator(seed);
+    std::uniform_int_distribution<int> distributionColor(64, 255);
+
+    // Where the player can walk to
+    for (unsigned int i = 0; i < count; i++)
+    {
+        unsigned int x;
+        unsigned int y;
+        if (!mapManager.getRandomFreeCell(generator, x, y))
+            return;
+
+        Uint8 r = distributionColor(generator);
+        Uint8 g = distributionColor(generator);
+        Uint8 b = distributionColor(generator);
+        addSprite(x + 0.5, y + 0.5, 0.4, SDL_Color { r, g, b, 255 });
+    }
+}
+
+void SpriteManager::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_size.clear();
+    m_color.clear();
+    m_maximumSize = 0;
+    m_spriteCell.clear();
+    m_spriteSlot.clear();
+    for (std::vector<unsigned int> &cellSprites : m_cellSprites)
+        cellSprites.clear();
+    m_numberOfCandidateSprites = 0;
+    m_numberOfVisibleSprites = 0;
+}
+
+unsigned int SpriteManager::gatherCandidates(Player &player, const unsigned int fov, unsigned int *candidates) const
+{
+    // Cells of the frustum's bounding box (up to MAX_DEPTH, one cell wider for the sprites' size)
+    const double cosAngle = cos(player.getAngle());
+    const double sinAngle = sin(player.getAngle());
+    const double halfWidth = MAX_DEPTH * tan(0.5 * fov * Math::DEGREE_TO_RADIAN);
+    double minimumX = player.getX();
+    double maximumX = player.getX();
+    double minimumY = player.getY();
+    double maximumY = player.getY();
+    for (const double side : { -1.0, 1.0 })
+    {
+        const double cornerX = player.getX() + MAX_DEPTH * cosAngle - side * halfWidth * sinAngle;
+        const double cornerY = player.getY() - MAX_DEPTH * sinAngle - side * halfWidth * cosAngle;
+        minimumX = std::min(minimumX, cornerX);
+        maximumX = std::max(maximumX, cornerX);
+        minimumY = std::min(minimumY, cornerY);
+        maximumY = std::max(maximumY, cornerY);
+    }
+    const int firstX = Math::limitToInterval<double>(minimumX - 1, 0, m_gridWidth - 1);
+    const int lastX = Math::limitToInterval<double>(maximumX + 1, 0, m_gridWidth - 1);
+    const int firstY = Math::limitToInterval<double>(minimumY - 1, 0, m_gridHeight - 1);
+    const int lastY = Math::limitToInterval<double>(maximumY + 1, 0, m_gridHeight - 1);
+
+    unsigned int numberOfCandidates = 0;
+    for (int y = firstY; y <= lastY; y++)
+    {
+        for (int x = firstX; x <= lastX; x++)
+        {
+            // Visible from the viewer's region (PVS, set up by the caller)
+            const std::vector<unsigned int> &cellSprites = m_cellSprites[x + y * m_gridWidth];
+            if (cellSprites.empty() || (m_visibilitySet != nullptr && !m_visibilitySet->isVisibleFromViewer(x, y)))
+                continue;
+
+            if (candidates != nullptr)
+                std::copy(cellSprites.begin(), cellSprites.end(), candidates + numberOfCandidates);
+            numberOfCandidates += cellSprites.size();
+        }
+    }
+
+    return numberOfCandidates;
+}
+
+void SpriteManager::cullSprites(FrameArena &arena, Player &player, const unsigned int fov)
+{
+    const double cosAngle = cos(player.getAngle());
+    const double sinAngle = sin(player.getAngle());
+    const double tanHalfFov = tan(0.5 * fov * Math::DEGREE_TO_RADIAN);
+
+    // Counted first, the per frame arrays are sized on the candidates, not on all the sprites
+    m_numberOfCandidateSprites = gatherCandidates(player, fov, nullptr);
+    unsigned int *candidates = arena.allocateArray<unsigned int>(m_numberOfCandidateSprites);
+    gatherCandidates(player, fov, candidates);
+
+    m_visibleSprites = arena.allocateArray<unsigned int>(m_numberOfCandidateSprites);
+    m_depthKeys = arena.allocateArray<unsigned short>(m_numberOfCandidateSprites);
+    m_depth = arena.allocateArray<double>(m_numberOfCandidateSprites);
+    m_lateralOffset = arena.allocateArray<double>(m_numberOfCandidateSprites);
+    m_numberOfVisibleSprites = 0;
+
+    for (unsigned int candidate = 0; candidate < m_numberOfCandidateSprites; candidate++)
+    {
+        // Camera space: depth along the view direction, lateral offset to the left
+        const unsigned int i = candidates[candidate];
+        const double dx = m_x[i] - player.getX();
+        const double dy = m_y[i] - player.getY();
+        const double depth = dx * cosAngle - dy * sinAngle;
+        const double lateralOffset = -dx * sinAngle - dy * cosAngle;
+
+        if (depth < NEAR_PLANE || depth >= MAX_DEPTH || std::fabs(lateralOffset) - 0.5 * m_size[i] > depth * tanHalfFov)
+            continue;
+
+        // Far sprites first
+        m_visibleSprites[m_numberOfVisibleSprites] = i;
+        m_depth[m_numberOfVisibleSprites] = depth;
+        m_lateralOffset[m_numberOfVisibleSprites] = lateralOffset;
+        m_depthKeys[m_numberOfVisibleSprites] = 65535 - (unsigned short)(depth / MAX_DEPTH * 65535);
+        m_numberOfVisibleSprites++;
+    }
+}
+
+void SpriteManager::sortVisibleSprites(FrameArena &arena)
+{
+    // LSD radix sort of the slots, two 8-bit passes over the 16-bit depth keys
+    const unsigned int numberOfVisibleSprites = m_numberOfVisibleSprites;
+    m_drawOrder = arena.allocateArray<unsigned int>(numberOfVisibleSprites);
+    unsigned int *sortedSlots = arena.allocateArray<unsigned int>(numberOfVisibleSprites);
+    unsigned short *sortedDepthKeys = arena.allocateArray<unsigned short>(numberOfVisibleSprites);
+    for (unsigned int i = 0; i < numberOfVisibleSprites; i++)
+        m_drawOrder[i] = i;
+
+    for (unsigned int shift = 0; shift < 16; shift += 8)
+    {
+        unsigned int offsets[256] = { 0 };
+        for (unsigned int i = 0; i < numberOfVisibleSprites; i++)
+            offsets[(m_depthKeys[i] >> shift) & 0xFF]++;
+
+        unsigned int sum = 0;
+        for (unsigned int bucket = 0; bucket < 256; bucket++)
+        {
+            unsigned int count = offsets[bucket];
+            offsets[bucket] = sum;
+            sum += count;
+        }
+
+        for (unsigned int i = 0; i < numberOfVisibleSprites; i++)
+        {
+            unsigned int destination = offsets[(m_depthKeys[i] >> shift) & 0xFF]++;
+            sortedSlots[destination] = m_drawOrder[i];
+            sortedDepthKeys[destination] = m_depthKeys[i];
+        }
+
+        std::swap(m_drawOrder, sortedSlots);
+        std::swap(m_depthKeys, sortedDepthKeys);
+    }
+}
+
+void SpriteManager::computeTilesMaxDistance(FrameArena &arena, const Raycaster &raycaster)
+{
+    // Farthest wall per tile of columns, a sprite nearer than it on no tile is fully hidden
+    const unsigned int numberOfRays = raycaster.getNumberOfRays();
+    const double *raysDistance = raycaster.getRaysDistance();
+    const unsigned int numberOfTiles = (numberOfRays + TILE_WIDTH - 1) / TILE_WIDTH;
+
+    // Multi-hit: the nearest opaque wall may be lower than the sprites, a wall hides every sprite
+    // standing behind it when it is at least half a cell high and as high as the largest sprite
+    const double hidingHeight = std::max(0.5, m_maximumSize);
+
+    m_tilesMaxDistance = arena.allocateArray<double>(numberOfTiles);
+    std::fill(m_tilesMaxDistance, m_tilesMaxDistance + numberOfTiles, 0.0);
+    for (unsigned int i = 0; i < numberOfRays; i++)
+    {
+        double distance = raysDistance[i];
+        if (raycaster.isMultiHit())
+        {
+            distance = std::numeric_limits<double>::infinity();
+            const WallSpan *spans = raycaster.getSpans(i);
+            for (unsigned int k = 0; k < raycaster.getNumberOfSpans(i); k++)
+            {
+                if (!spans[k].isSeeThrough && spans[k].wallHeight * spans[k].distance >= hidingHeight)
+                {
+                    distance = spans[k].distance;
+                    break;
+                }
+            }
+        }
+        m_tilesMaxDistance[i / TILE_WIDTH] = std::max(m_tilesMaxDistance[i / TILE_WIDTH], distance);
+    }
+}
+
+bool SpriteManager::SDL_drawSpriteSpans(SDL_Renderer *renderer, const Raycaster &raycaster, const double depth, const int firstRay, const int lastRay, const double xStep,
+                                        const double spriteLeft, const double spriteWidth, const double spriteTop, const double spriteHeight, const unsigned int screenHeight, const SDL_Color &color)
+{
+    const int numberOfRays = raycaster.getNumberOfRays();
+    const double movingOffset = raycaster.getMovingOffset();
+    const double spriteBottom = spriteTop + spriteHeight;
+    bool isDrawn = false;
+
+    // Unfaded columns clipped to the same row are merged into runs, as without multi-hit
+    int runFirstRay = -1;
+    int runLastRay = -1;
+    double runBottom = spriteBottom;
+    auto draw = [&](const int first, const int last, const double y0, const double y1, const Uint8 alpha)
+    {
+        const double x0 = (numberOfRays - 1 - last) * xStep;
+        const double x1 = (numberOfRays - first) * xStep;
+        SDL_Rect destination = { (int)x0, (int)y0, std::max(1, (int)x1 - (int)x0), std::max(1, (int)y1 - (int)y0) };
+        if (m_texture != nullptr)
+        {
+            const int sourceX0 = Math::limitToInterval<int>((x0 - spriteLeft) / spriteWidth * m_textureSize, 0, m_textureSize - 1);
+            const int sourceX1 = Math::limitToInterval<int>(ceil((x1 - spriteLeft) / spriteWidth * m_textureSize), sourceX0 + 1, m_textureSize);
+            const int sourceY0 = Math::limitToInterval<int>((y0 - spriteTop) / spriteHeight * m_textureSize, 0, m_textureSize - 1);
+            const int sourceY1 = Math::limitToInterval<int>(ceil((y1 - spriteTop) / spriteHeight * m_textureSize), sourceY0 + 1, m_textureSize);
+            SDL_Rect source = { sourceX0, sourceY0, sourceX1 - sourceX0, sourceY1 - sourceY0 };
+            SDL_SetTextureAlphaMod(m_texture, alpha);
+            SDL_RenderCopy(renderer, m_texture, &source, &destination);
+        }
+        else
+        {
+            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, alpha);
+            SDL_RenderFillRect(renderer, &destination);
+        }
+        isDrawn = true;
+    };
+    auto flushRun = [&]()
+    {
+        if (runFirstRay >= 0)
+            draw(runFirstRay, runLastRay, spriteTop, runBottom, 255);
+        runFirstRay = -1;
+    };
+
+    for (int ray = firstRay; ray <= lastRay; ray++)
+    {
+        // Spans are front to back: the opaque ones nearer than the sprite clip its bottom
+        // (they stand on the floor), the see-through ones cover a band of it
+        const WallSpan *spans = raycaster.getSpans(ray);
+        const unsigned int numberOfSpans = raycaster.getNumberOfSpans(ray);
+        double visibleBottom = spriteBottom;
+        double rows[2 * Raycaster::MAX_SPANS + 2];
+        unsigned int numberOfRows = 0;
+        unsigned int numberOfSeeThroughSpans = 0;
+        for (unsigned int k = 0; k < numberOfSpans && spans[k].distance < depth; k++)
+        {
+            if (!spans[k].isSeeThrough)
+                visibleBottom = std::min(visibleBottom, spans[k].wallTop * screenHeight + movingOffset);
+            else
+            {
+                rows[numberOfRows++] = spans[k].visibleTop * screenHeight + movingOffset;
+                rows[numberOfRows++] = spans[k].visibleBottom * screenHeight + movingOffset;
+                numberOfSeeThroughSpans++;
+            }
+        }
+
+        if (visibleBottom <= spriteTop)
+        {
+            flushRun();
+            continue;
+        }
+        if (numberOfSeeThroughSpans == 0)
+        {
+            if (runFirstRay >= 0 && (int)visibleBottom != (int)runBottom)
+                flushRun();
+            if (runFirstRay < 0)
+                runFirstRay = ray;
+            runLastRay = ray;
+            runBottom = visibleBottom;
+            continue;
+        }
+        flushRun();
+
+        // Bands between the see-through spans' edges, faded by the spans covering them
+        for (unsigned int j = 0; j < numberOfRows; j++)
+            rows[j] = Math::limitToInterval<double>(rows[j], spriteTop, visibleBottom);
+        rows[numberOfRows++] = spriteTop;
+        rows[numberOfRows++] = visibleBottom;
+        std::sort(rows, rows + numberOfRows);
+        for (unsigned int j = 0; j + 1 < numberOfRows; j++)
+        {
+            if (rows[j + 1] - rows[j] < 0.5)
+                continue;
+
+            const double middle = 0.5 * (rows[j] + rows[j + 1]);
+            double transmittance = 1;
+            for (unsigned int k = 0; k < numberOfSpans && spans[k].distance < depth; k++)
+                if (spans[k].isSeeThrough && middle >= spans[k].visibleTop * screenHeight + movingOffset && middle <= spans[k].visibleBottom * screenHeight + movingOffset)
+                    transmittance *= 1 - spans[k].color.a / 255.0;
+            if (transmittance * 255 >= 1)
+                draw(ray, ray, rows[j], rows[j + 1], transmittance * 255);
+        }
+    }
+    flushRun();
+
+    if (m_texture != nullptr)
+        SDL_SetTextureAlphaMod(m_texture, 255);
+    return isDrawn;
+}
+
+void SpriteManager::SDL_renderSprites(SDL_Renderer *renderer, FrameArena &arena, Player &player, const Raycaster &raycaster, const unsigned int fov, const unsigned int screenWidth, const unsigned int screenHeight)
+{
+    m_numberOfDrawnSprites = 0;
+    if (m_x.empty())
+        return;
+
+    cullSprites(arena, player, fov);
+    if (m_numberOfVisibleSprites == 0)
+        return;
+    sortVisibleSprites(arena);
+    computeTilesMaxDistance(arena, raycaster);
+
+    // Same ray distribution as Raycaster::calculateRaysDistance_OMP (ray 0 is on the right of the screen)
+    const int numberOfRays = raycaster.getNumberOfRays();
+    const double *raysDistance = raycaster.getRaysDistance();
+    const double xStep = (double)screenWidth / numberOfRays;
+    const double inverseLinearRayDistributionFactor = 2.0 / (numberOfRays * tan(0.5 * fov * Math::DEGREE_TO_RADIAN));
+    const double halfNumberOfRays = numberOfRays >> 1;
+    const double halfScreenHeight = 0.5 * screenHeight;
+
+    for (unsigned int i = 0; i < m_numberOfVisibleSprites; i++)
+    {
+        const unsigned int slot = m_drawOrder[i];
+        const unsigned int sprite = m_visibleSprites[slot];
+        const double depth = m_depth[slot];
+        const double centerRay = halfNumberOfRays + m_lateralOffset[slot] / (depth * inverseLinearRayDistributionFactor);
+        const double halfWidthRays = 0.5 * m_size[sprite] / (depth * inverseLinearRayDistributionFactor);
+        const int firstRay = std::max<int>(0, ceil(centerRay - halfWidthRays));
+        const int lastRay = std::min<int>(numberOfRays - 1, floor(centerRay + halfWidthRays));
+        if (firstRay > lastRay)
+            continue;
+
+        // Early rejection, fully behind nearer walls
+        bool isPotentiallyVisible = false;
+        for (int tile = firstRay / TILE_WIDTH; tile <= lastRay / (int)TILE_WIDTH && !isPotentiallyVisible; tile++)
+            isPotentiallyVisible = depth < m_tilesMaxDistance[tile];
+        if (!isPotentiallyVisible)
+            continue;
+
+        // Screen rectangle of the whole sprite, standing on the ground
+        const double spriteWidth = 2 * halfWidthRays * xStep;
+        const double spriteLeft = (numberOfRays - 1 - centerRay) * xStep - 0.5 * spriteWidth;
+        const double spriteHeight = m_size[sprite] * screenHeight / depth;
+        const double spriteBottom = halfScreenHeight + halfScreenHeight / depth + raycaster.getMovingOffset();
+        const SDL_Color &color = m_color[sprite];
+        if (m_texture != nullptr)
+            SDL_SetTextureColorMod(m_texture, color.r, color.g, color.b);
+        else
+            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
+
+        // Draw the runs of columns where the sprite is in front of the wall
+        bool isDrawn = false;
+        if (raycaster.isMultiHit())
+            isDrawn = SDL_drawSpriteSpans(renderer, raycaster, depth, firstRay, lastRay, xStep, spriteLeft, spriteWidth, spriteBottom - spriteHeight, spriteHeight, screenHeight, color);
+        else
+        {
+            int ray = firstRay;
+            while (ray <= lastRay)
+            {
+                while (ray <= lastRay && raysDistance[ray] <= depth)
+                    ray++;
+                const int runFirstRay = ray;
+                while (ray <= lastRay && raysDistance[ray] > depth)
+                    ray++;
+                if (runFirstRay == ray)
+                    continue;
+
+                const double x0 = (numberOfRays - ray) * xStep;
+                const double x1 = (numberOfRays - runFirstRay) * xStep;
+                SDL_Rect destination = { (int)x0, (int)(spriteBottom - spriteHeight), std::max(1, (int)x1 - (int)x0), (int)spriteHeight };
+                if (m_texture != nullptr)
+                {
+                    const int sourceX0 = Math::limitToInterval<int>((x0 - spriteLeft) / spriteWidth * m_textureSize, 0, m_textureSize - 1);
+                    const int sourceX1 = Math::limitToInterval<int>(ceil((x1 - spriteLeft) / spriteWidth * m_textureSize), sourceX0 + 1, m_textureSize);
+                    SDL_Rect source = { sourceX0, 0, sourceX1 - sourceX0, m_textureSize };
+                    SDL_RenderCopy(renderer, m_texture, &source, &destination);
+                }
+                else
+                    SDL_RenderFillRect(renderer, &destination);
+                isDrawn = true;
+            }
+        }
+
+        if (isDrawn)
+            m_numberOfDrawnSprites++;
+    }
+}
\ No newline at end of file
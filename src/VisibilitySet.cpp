@@ -0,0 +1,423 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <omp.h>
+
+#include "VisibilitySet.hpp"
+#include "Toolbox.hpp"
+
+namespace
+{
+    void writeU32(std::ofstream &output, unsigned int value)
+    {
+        char bytes[4] = { (char)(value & 0xFF), (char)((value >> 8) & 0xFF), (char)((value >> 16) & 0xFF), (char)(value >> 24) };
+        output.write(bytes, 4);
+    }
+
+    bool readU32(std::istream &input, unsigned int &value)
+    {
+        unsigned char bytes[4];
+        if (!input.read((char *)bytes, 4))
+            return false;
+        value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+        return true;
+    }
+
+    // Runs are mostly short: 7 bits per byte, high bit set when more bytes follow
+    void writeVarint(std::ofstream &output, unsigned int value)
+    {
+        while (value >= 0x80)
+        {
+            output.put((char)((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        output.put((char)value);
+    }
+
+    bool readVarint(std::istream &input, unsigned int &value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 35; shift += 7)
+        {
+            char byte;
+            if (!input.get(byte))
+                return false;
+            value |= (unsigned int)(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    // Reads a buffer in place
+    class MemoryBuffer : public std::streambuf
+    {
+        public:
+        MemoryBuffer(const unsigned char *bytes, const size_t size) { setg((char *)bytes, (char *)bytes, (char *)bytes + size); }
+    };
+
+    unsigned int varintSize(unsigned int value)
+    {
+        unsigned int size = 1;
+        while (value >= 0x80)
+        {
+            value >>= 7;
+            size++;
+        }
+        return size;
+    }
+}
+
+VisibilitySet::VisibilitySet()
+{
+    m_width = 0;
+    m_height = 0;
+    m_regionSize = 1;
+    m_regionsPerRow = 0;
+    m_mapHash = 0;
+    m_viewerRegion = 0;
+}
+
+unsigned int VisibilitySet::hashMap(const MapManager &mapManager)
+{
+    // FNV-1a over the size and the cells (doors as closed, whatever their state)
+    unsigned int hash = 2166136261u;
+    auto addByte = [&hash](unsigned char byte) { hash = (hash ^ byte) * 16777619u; };
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        addByte((mapManager.getWidth() >> shift) & 0xFF);
+        addByte((mapManager.getHeight() >> shift) & 0xFF);
+    }
+    for (unsigned int y = 0; y < mapManager.getHeight(); y++)
+        for (unsigned int x = 0; x < mapManager.getWidth(); x++)
+            addByte(mapManager.isDoor(x, y) ? MapManager::DOOR_ELEMENT : mapManager.getMapElement(x, y));
+
+    return hash;
+}
+
+void VisibilitySet::compute(const MapManager &mapManager, const unsigned int regionSize, unsigned int raysPerSample)
+{
+    if (raysPerSample == 0)
+        raysPerSample = Math::limitToInterval<unsigned int>(4 * M_PI * std::max(mapManager.getWidth(), mapManager.getHeight()), 360, 8192);
+
+    m_width = mapManager.getWidth();
+    m_height = mapManager.getHeight();
+    m_regionSize = std::max(1u, regionSize);
+    m_regionsPerRow = (m_width + m_regionSize - 1) / m_regionSize;
+    m_mapHash = hashMap(mapManager);
+
+    const unsigned int regionsPerColumn = (m_height + m_regionSize - 1) / m_regionSize;
+    const unsigned int numberOfRegions = m_regionsPerRow * regionsPerColumn;
+    const unsigned int numberOfWords = (m_width * m_height + 63) / 64;
+    m_regionsRuns.assign(numberOfRegions, std::vector<unsigned int>());
+    m_regionsRunEnds.assign(numberOfRegions, std::vector<unsigned int>());
+
+    // Ray directions shared by every sample point
+    std::vector<double> rayDirectionsX(raysPerSample);
+    std::vector<double> rayDirectionsY(raysPerSample);
+    for (unsigned int i = 0; i < raysPerSample; i++)
+    {
+        rayDirectionsX[i] = cos(2 * M_PI * (i + 0.5) / raysPerSample);
+        rayDirectionsY[i] = sin(2 * M_PI * (i + 0.5) / raysPerSample);
+    }
+
+    // Highest wall top above the eye (half a cell): a ray can stop once nothing further can rise
+    // above what it has already hit
+    double maximumTop = 0.5;
+    for (unsigned int y = 0; y < m_height; y++)
+        for (unsigned int x = 0; x < m_width; x++)
+            if (mapManager.getMapElement(x, y) != 0)
+                maximumTop = std::max(maximumTop, MapManager::getMaterial(mapManager.getMapElement(x, y)).height - 0.5);
+
+    // Center & points all around the (barely inset) boundary of each free cell: the viewer can stand
+    // anywhere in it, what a corner sees the middle of an edge may not
+    const unsigned int SAMPLES_PER_EDGE = 4;
+    const double INSET = 1e-3;
+    std::vector<std::pair<double, double>> sampleOffsets = { { 0.5, 0.5 } };
+    for (unsigned int i = 0; i < SAMPLES_PER_EDGE; i++)
+    {
+        const double t = INSET + (1 - 2 * INSET) * i / SAMPLES_PER_EDGE;
+        sampleOffsets.push_back({ t, INSET });
+        sampleOffsets.push_back({ 1 - INSET, t });
+        sampleOffsets.push_back({ 1 - t, 1 - INSET });
+        sampleOffsets.push_back({ INSET, 1 - t });
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for (int region = 0; region < (int)numberOfRegions; region++)
+    {
+        std::vector<unsigned long long> bits(numberOfWords, 0);
+        const unsigned int regionX = (region % m_regionsPerRow) * m_regionSize;
+        const unsigned int regionY = (region / m_regionsPerRow) * m_regionSize;
+
+        for (unsigned int cellY = regionY; cellY < std::min(regionY + m_regionSize, m_height); cellY++)
+        {
+            for (unsigned int cellX = regionX; cellX < std::min(regionX + m_regionSize, m_width); cellX++)
+            {
+                if (mapManager.getMapElement(cellX, cellY) != 0 && !mapManager.isDoor(cellX, cellY))
+                    continue;
+
+                for (const std::pair<double, double> &sampleOffset : sampleOffsets)
+                {
+                    const double originX = cellX + sampleOffset.first;
+                    const double originY = cellY + sampleOffset.second;
+
+                    for (unsigned int i = 0; i < raysPerSample; i++)
+                    {
+                        // Grid traversal (DDA), every crossed cell is visible, the wall hit too.
+                        // Doors may open at runtime, they do not stop the rays, see-through walls
+                        // neither. Opaque walls hide what is behind up to the slope of their top
+                        const double rayDirectionX = rayDirectionsX[i];
+                        const double rayDirectionY = rayDirectionsY[i];
+                        int x = cellX;
+                        int y = cellY;
+                        const int stepX = (rayDirectionX < 0) ? -1 : 1;
+                        const int stepY = (rayDirectionY < 0) ? -1 : 1;
+                        const double deltaDistanceX = std::fabs(1 / rayDirectionX);
+                        const double deltaDistanceY = std::fabs(1 / rayDirectionY);
+                        double sideDistanceX = (rayDirectionX < 0) ? (originX - x) * deltaDistanceX : (x + 1 - originX) * deltaDistanceX;
+                        double sideDistanceY = (rayDirectionY < 0) ? (originY - y) * deltaDistanceY : (y + 1 - originY) * deltaDistanceY;
+                        double distance = 0;
+                        double coveredSlope = -std::numeric_limits<double>::infinity();
+
+                        while (true)
+                        {
+                            const unsigned int index = x + y * m_width;
+                            bits[index >> 6] |= 1ull << (index & 63);
+                            const char element = mapManager.getMapElement(x, y);
+                            if (element != 0 && !mapManager.isDoor(x, y) && (x != (int)cellX || y != (int)cellY))
+                            {
+                                const Material &material = MapManager::getMaterial(element);
+                                if (!material.isSeeThrough)
+                                    coveredSlope = std::max(coveredSlope, (material.height - 0.5) / distance);
+                                if (coveredSlope * std::min(sideDistanceX, sideDistanceY) >= maximumTop)
+                                    break;
+                            }
+
+                            if (sideDistanceX < sideDistanceY)
+                            {
+                                distance = sideDistanceX;
+                                sideDistanceX += deltaDistanceX;
+                                x += stepX;
+                            }
+                            else
+                            {
+                                distance = sideDistanceY;
+                                sideDistanceY += deltaDistanceY;
+                                y += stepY;
+                            }
+                            if (mapManager.getMapElement(x, y) == MapManager::OUTSIDE_ELEMENT)
+                                break;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Sampled rays can slip past a cell corner (or a thin slit) between two directions: each
+        // visible cell makes its 8 neighbours visible too, a false positive only costs a draw
+        std::vector<unsigned long long> dilatedBits(bits);
+        for (unsigned int y = 0; y < m_height; y++)
+        {
+            for (unsigned int x = 0; x < m_width; x++)
+            {
+                const unsigned int index = x + y * m_width;
+                if (!((bits[index >> 6] >> (index & 63)) & 1))
+                    continue;
+
+                for (unsigned int neighbourY = (y == 0) ? 0 : y - 1; neighbourY <= std::min(y + 1, m_height - 1); neighbourY++)
+                {
+                    for (unsigned int neighbourX = (x == 0) ? 0 : x - 1; neighbourX <= std::min(x + 1, m_width - 1); neighbourX++)
+                    {
+                        const unsigned int neighbourIndex = neighbourX + neighbourY * m_width;
+                        dilatedBits[neighbourIndex >> 6] |= 1ull << (neighbourIndex & 63);
+                    }
+                }
+            }
+        }
+
+        encodeRegion(dilatedBits, m_regionsRuns[region]);
+        unsigned int runEnd = 0;
+        for (unsigned int run : m_regionsRuns[region])
+        {
+            runEnd += run;
+            m_regionsRunEnds[region].push_back(runEnd);
+        }
+    }
+
+    m_viewerVisibleCells.assign(numberOfWords, 0);
+    m_viewerRegion = numberOfRegions;
+}
+
+void VisibilitySet::encodeRegion(const std::vector<unsigned long long> &bits, std::vector<unsigned int> &runs) const
+{
+    // Alternating runs, starting with a (possibly empty) hidden run
+    const unsigned int numberOfCells = m_width * m_height;
+    bool currentValue = false;
+    unsigned int runLength = 0;
+    for (unsigned int i = 0; i < numberOfCells; i++)
+    {
+        bool value = (bits[i >> 6] >> (i & 63)) & 1;
+        if (value != currentValue)
+        {
+            runs.push_back(runLength);
+            runLength = 0;
+            currentValue = value;
+        }
+        runLength++;
+    }
+    runs.push_back(runLength);
+}
+
+bool VisibilitySet::isVisible(const unsigned int fromX, const unsigned int fromY, const unsigned int toX, const unsigned int toY) const
+{
+    const std::vector<unsigned int> &runEnds = m_regionsRunEnds[coordinateToRegion(fromX, fromY)];
+    const unsigned int run = std::upper_bound(runEnds.begin(), runEnds.end(), coordinateToIndex(toX, toY)) - runEnds.begin();
+
+    return run & 1;
+}
+
+void VisibilitySet::setViewerCell(const unsigned int x, const unsigned int y)
+{
+    const unsigned int region = coordinateToRegion(x, y);
+    if (region == m_viewerRegion)
+        return;
+
+    // Decode the region's runs
+    m_viewerRegion = region;
+    std::fill(m_viewerVisibleCells.begin(), m_viewerVisibleCells.end(), 0);
+    unsigned int index = 0;
+    bool value = false;
+    for (unsigned int run : m_regionsRuns[region])
+    {
+        if (value)
+            for (unsigned int i = index; i < index + run; i++)
+                m_viewerVisibleCells[i >> 6] |= 1ull << (i & 63);
+        index += run;
+        value = !value;
+    }
+}
+
+size_t VisibilitySet::getCompressedSize() const
+{
+    size_t size = 0;
+    for (const std::vector<unsigned int> &runs : m_regionsRuns)
+    {
+        size += varintSize(runs.size());
+        for (unsigned int run : runs)
+            size += varintSize(run);
+    }
+    return size;
+}
+
+bool VisibilitySet::save(const std::string &path) const
+{
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    if (!output.is_open())
+        return false;
+
+    output.write("RCPV", 4);
+    writeU32(output, FILE_VERSION);
+    writeU32(output, m_width);
+    writeU32(output, m_height);
+    writeU32(output, m_regionSize);
+    writeU32(output, m_mapHash);
+    writeU32(output, m_regionsRuns.size());
+    for (const std::vector<unsigned int> &runs : m_regionsRuns)
+    {
+        writeVarint(output, runs.size());
+        for (unsigned int run : runs)
+            writeVarint(output, run);
+    }
+
+    return output.good();
+}
+
+bool VisibilitySet::load(const std::string &path, const MapManager &mapManager)
+{
+    std::ifstream input(path, std::ios::binary);
+    if (!input.is_open())
+        return false;
+
+    return read(input, mapManager);
+}
+
+bool VisibilitySet::load(const unsigned char *bytes, const size_t size, const MapManager &mapManager)
+{
+    MemoryBuffer buffer(bytes, size);
+    std::istream input(&buffer);
+
+    return read(input, mapManager);
+}
+
+bool VisibilitySet::read(std::istream &input, const MapManager &mapManager)
+{
+    char magic[4];
+    unsigned int version, width, height, regionSize, mapHash, numberOfRegions;
+    input.read(magic, 4);
+    if (!input || magic[0] != 'R' || magic[1] != 'C' || magic[2] != 'P' || magic[3] != 'V')
+        return false;
+    if (!readU32(input, version) || !readU32(input, width) || !readU32(input, height) || !readU32(input, regionSize) || !readU32(input, mapHash) || !readU32(input, numberOfRegions))
+        return false;
+
+    // Stale file: the map changed since it was computed
+    if (version != FILE_VERSION || width != mapManager.getWidth() || height != mapManager.getHeight() || regionSize == 0 || mapHash != hashMap(mapManager))
+        return false;
+
+    m_width = width;
+    m_height = height;
+    m_regionSize = regionSize;
+    m_regionsPerRow = (m_width + m_regionSize - 1) / m_regionSize;
+    m_mapHash = mapHash;
+    if (numberOfRegions != m_regionsPerRow * ((m_height + m_regionSize - 1) / m_regionSize))
+        return false;
+
+    m_regionsRuns.assign(numberOfRegions, std::vector<unsigned int>());
+    m_regionsRunEnds.assign(numberOfRegions, std::vector<unsigned int>());
+    for (unsigned int region = 0; region < numberOfRegions; region++)
+    {
+        unsigned int numberOfRuns;
+        if (!readVarint(input, numberOfRuns) || numberOfRuns > m_width * m_height + 1)
+        {
+            m_regionsRuns.clear();
+            return false;
+        }
+
+        // The runs must cover the map exactly, setViewerCell decodes them without bound checks
+        unsigned int runEnd = 0;
+        m_regionsRuns[region].resize(numberOfRuns);
+        for (unsigned int &run : m_regionsRuns[region])
+        {
+            if (!readVarint(input, run) || run > m_width * m_height - runEnd)
+            {
+                m_regionsRuns.clear();
+                return false;
+            }
+            runEnd += run;
+            m_regionsRunEnds[region].push_back(runEnd);
+        }
+        if (runEnd != m_width * m_height)
+        {
+            m_regionsRuns.clear();
+            return false;
+        }
+    }
+
+    m_viewerVisibleCells.assign((m_width * m_height + 63) / 64, 0);
+    m_viewerRegion = numberOfRegions;
+    return true;
+}
+
+bool VisibilitySet::loadOrCompute(const std::string &path, const MapManager &mapManager, const unsigned int regionSize)
+{
+    if (load(path, mapManager) && m_regionSize == regionSize)
+        return true;
+
+    compute(mapManager, regionSize);
+    if (!save(path))
+        std::cerr << "PVS: could not save " << path << std::endl;
+
+    return isComputed();
+}
\ No newline at end of file
@@ -1,8 +1,117 @@
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include "AllocationCounter.hpp"
+#include "Benchmark.hpp"
 #include "Capp.hpp"
+#include "CpuFeatures.hpp"
+#include "GoldenImages.hpp"
 
 int main(int argc, char **argv)
 {
+    AllocationCounter::initialise();
     Capp app;
+    GoldenImages goldenImages;
+    CpuFeatures::getLevel();
+
+    // Command line
+    // --record <file>   : record inputs & frame deltas
+    // --replay <file>   : replay a recording
+    // --headless        : replay without window (rays only), prints timings
+    // --offscreen       : (with --headless) draw every frame with a software renderer, no window
+    // --capture <file>  : write the presented frames to file (.y4m: Y4M 4:2:0, else binary PPMs)
+    // --fixed-dt <us>   : simulate with a fixed time step (microseconds)
+    // --sim-rate <hz>   : run the simulation on its own thread at a fixed tick rate
+    // --pipeline <n>    : cast up to n frames ahead of their submission (2..4)
+    // --frame-budget <ms>: scale the number of rays to keep frames within the budget
+    // --adaptive <n>    : cast every n-th ray, interpolate along shared wall faces
+    // --temporal        : cast around the previous frame's face boundaries only
+    // --no-idle-wait    : keep looping when the frame did not change
+    // --frame-rate <hz> : pace the frames, sampling the input as late as the frame allows
+    // --vsync           : present on vertical sync, paced at the display's rate unless --frame-rate
+    // --no-late-latch   : do not latch the mouse motion again right before casting
+    // --special-walls   : add half walls, tall walls & grates to the map (multi-hit casting, recorded)
+    // --framebuffer     : draw background & walls in software (column span kernels)
+    // --column-major    : same, into a column-major buffer transposed before the upload
+    // --upscale <filter>: software walls under a frame budget, columns upscaled with nearest (default) or bilinear
+    // --geometry        : draw background & walls as batched quads (SDL_RenderGeometry)
+    // --simd <level>    : force the kernels' instruction set (scalar, sse4.2, avx2, avx512),
+    //                     before --benchmark. Default: RAYCASTING_SIMD or the best the CPU has
+    // --benchmark <name>: run a headless benchmark ("all" runs every benchmark)
+    // --golden <dir>    : headless regression test, rays & software frames against the golden files
+    // --update-golden   : (before --golden) write the golden files instead
+    // --ray-tolerance <cells> / --ray-mismatches <n> / --pixel-tolerance <levels> / --pixel-mismatches <ratio>:
+    //                     (before --golden) allowed differences, default: pixel exact
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc)
+        {
+            Benchmark benchmark;
+            return benchmark.run(argv[i + 1]) ? 0 : -1;
+        }
+        else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc)
+            return goldenImages.run(argv[i + 1]) ? 0 : -1;
+        else if (strcmp(argv[i], "--update-golden") == 0)
+            goldenImages.setUpdate(true);
+        else if (strcmp(argv[i], "--ray-tolerance") == 0 && i + 1 < argc)
+            goldenImages.getTolerances().ray = atof(argv[++i]);
+        else if (strcmp(argv[i], "--ray-mismatches") == 0 && i + 1 < argc)
+            goldenImages.getTolerances().rayMismatches = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--pixel-tolerance") == 0 && i + 1 < argc)
+            goldenImages.getTolerances().pixel = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--pixel-mismatches") == 0 && i + 1 < argc)
+            goldenImages.getTolerances().pixelMismatchRatio = atof(argv[++i]);
+        else if (strcmp(argv[i], "--simd") == 0 && i + 1 < argc)
+        {
+            if (!CpuFeatures::setLevel(argv[++i]))
+                return -1;
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            app.setRecordFile(argv[++i]);
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            app.setReplayFile(argv[++i]);
+        else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+            app.setCaptureFile(argv[++i]);
+        else if (strcmp(argv[i], "--headless") == 0)
+            app.setHeadless(true);
+        else if (strcmp(argv[i], "--offscreen") == 0)
+            app.setOffscreen(true);
+        else if (strcmp(argv[i], "--fixed-dt") == 0 && i + 1 < argc)
+            app.setFixedTimestep(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--sim-rate") == 0 && i + 1 < argc)
+            app.setSimulationRate(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--pipeline") == 0 && i + 1 < argc)
+            app.setPipelineDepth(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--frame-budget") == 0 && i + 1 < argc)
+            app.setFrameBudget(atof(argv[++i]));
+        else if (strcmp(argv[i], "--adaptive") == 0 && i + 1 < argc)
+            app.setAdaptiveStride(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--temporal") == 0)
+            app.setTemporal(true);
+        else if (strcmp(argv[i], "--no-idle-wait") == 0)
+            app.setIdleWait(false);
+        else if (strcmp(argv[i], "--frame-rate") == 0 && i + 1 < argc)
+            app.setFrameRate(atof(argv[++i]));
+        else if (strcmp(argv[i], "--vsync") == 0)
+            app.setVsync(true);
+        else if (strcmp(argv[i], "--no-late-latch") == 0)
+            app.setLateLatch(false);
+        else if (strcmp(argv[i], "--special-walls") == 0)
+            app.setSpecialWalls(true);
+        else if (strcmp(argv[i], "--framebuffer") == 0)
+            app.setFrameBufferRendering(true);
+        else if (strcmp(argv[i], "--geometry") == 0)
+            app.setGeometryRendering(true);
+        else if (strcmp(argv[i], "--column-major") == 0)
+            app.setColumnMajor(true);
+        else if (strcmp(argv[i], "--upscale") == 0 && i + 1 < argc && (strcmp(argv[i + 1], "nearest") == 0 || strcmp(argv[i + 1], "bilinear") == 0))
+            app.setUpscaleFilter((strcmp(argv[++i], "bilinear") == 0) ? UpscaleFilter::bilinear : UpscaleFilter::nearest);
+        else
+        {
+            std::cerr << "Unknown argument: " << argv[i] << std::endl;
+            return -1;
+        }
+    }
+
     return app.run() ? 0 : -1;
 }
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "SDL.h"
+#include "SDL_ttf.h"
+#include "GlyphAtlas.hpp"
+#include "MapManager.hpp"
+#include "VisibilitySet.hpp"
+
+// Asset baker ("make bake"): converts the imported assets into the formats the engine uses
+// at runtime & writes them as constexpr tables, compiled in with RAYCASTING_BAKED_ASSETS.
+// Usage: assetbaker <imports directory> <output header>
+// - Sprite texture: ARGB8888, the color key turned into transparency
+// - FPS font: glyph atlas (GlyphAtlas::rasteriseFont), ARGB8888 & glyph rectangles
+// - Default map PVS: the .pvs file image (computed & saved first if missing or stale)
+
+namespace
+{
+    // Same as Capp (FPS text) & SpriteManager::loadTexture (color key)
+    const int FONT_SIZE = 64;
+    const SDL_Color FONT_COLOR = { 255, 255, 255, 255 };
+    const SDL_Color SPRITE_COLOR_KEY = { 237, 28, 36, 255 };
+
+    void writeArray(std::ofstream &output, const char *name, const Uint32 *values, const size_t count)
+    {
+        output << "    constexpr Uint32 " << name << "[] =\n    {\n" << std::hex << std::uppercase << std::setfill('0');
+        for (size_t i = 0; i < count; i++)
+            output << ((i % 8 == 0) ? "        " : " ") << "0x" << std::setw(8) << values[i] << ((i + 1 < count) ? "," : "") << ((i % 8 == 7 || i + 1 == count) ? "\n" : "");
+        output << std::dec << std::setfill(' ') << "    };\n";
+    }
+
+    void writeArray(std::ofstream &output, const char *name, const unsigned char *values, const size_t count)
+    {
+        output << "    constexpr unsigned char " << name << "[] =\n    {\n";
+        for (size_t i = 0; i < count; i++)
+            output << ((i % 16 == 0) ? "        " : " ") << (unsigned int)values[i] << ((i + 1 < count) ? "," : "") << ((i % 16 == 15 || i + 1 == count) ? "\n" : "");
+        output << "    };\n";
+    }
+
+    // ARGB8888 pixels, without the row padding
+    std::vector<Uint32> getPixels(SDL_Surface *surface)
+    {
+        std::vector<Uint32> pixels(surface->w * surface->h);
+        SDL_LockSurface(surface);
+        for (int y = 0; y < surface->h; y++)
+            for (int x = 0; x < surface->w; x++)
+                pixels[x + y * surface->w] = ((const Uint32 *)((const Uint8 *)surface->pixels + y * surface->pitch))[x];
+        SDL_UnlockSurface(surface);
+        return pixels;
+    }
+
+    bool bakeSpriteTexture(std::ofstream &output, const std::string &path)
+    {
+        SDL_Surface *bitmap = SDL_LoadBMP(path.c_str());
+        if (bitmap == nullptr)
+        {
+            std::cerr << "Could not load " << path << ": " << SDL_GetError() << std::endl;
+            return false;
+        }
+
+        SDL_SetColorKey(bitmap, SDL_TRUE, SDL_MapRGB(bitmap->format, SPRITE_COLOR_KEY.r, SPRITE_COLOR_KEY.g, SPRITE_COLOR_KEY.b));
+        SDL_Surface *surface = SDL_ConvertSurfaceFormat(bitmap, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(bitmap);
+        if (surface == nullptr || surface->w != surface->h)
+        {
+            std::cerr << "Sprite texture " << path << " must be square" << std::endl;
+            SDL_FreeSurface(surface);
+            return false;
+        }
+
+        std::vector<Uint32> pixels = getPixels(surface);
+        output << "    // " << path << "\n";
+        output << "    const int SPRITE_TEXTURE_SIZE = " << surface->w << ";\n";
+        writeArray(output, "SPRITE_TEXTURE", pixels.data(), pixels.size());
+        SDL_FreeSurface(surface);
+
+        return true;
+    }
+
+    bool bakeFontAtlas(std::ofstream &output, const std::string &path)
+    {
+        TTF_Font *font = TTF_OpenFont(path.c_str(), FONT_SIZE);
+        if (font == nullptr)
+        {
+            std::cerr << "Could not open " << path << ": " << SDL_GetError() << std::endl;
+            return false;
+        }
+
+        SDL_Rect glyphs[GlyphAtlas::NUMBER_OF_GLYPHS];
+        int glyphHeight = 0;
+        SDL_Surface *atlas = GlyphAtlas::rasteriseFont(font, FONT_COLOR, glyphs, glyphHeight);
+        TTF_CloseFont(font);
+        if (atlas == nullptr)
+        {
+            std::cerr << "Could not rasterise " << path << std::endl;
+            return false;
+        }
+
+        std::vector<Uint32> pixels = getPixels(atlas);
+        output << "\n    // " << path << ", " << FONT_SIZE << " points\n";
+        output << "    const int FONT_ATLAS_WIDTH = " << atlas->w << ";\n";
+        output << "    const int FONT_ATLAS_HEIGHT = " << atlas->h << ";\n";
+        output << "    const int FONT_GLYPH_HEIGHT = " << glyphHeight << ";\n";
+        output << "    constexpr SDL_Rect FONT_GLYPHS[] =\n    {\n";
+        for (int i = 0; i < GlyphAtlas::NUMBER_OF_GLYPHS; i++)
+            output << "        { " << glyphs[i].x << ", " << glyphs[i].y << ", " << glyphs[i].w << ", " << glyphs[i].h << " }" << ((i + 1 < GlyphAtlas::NUMBER_OF_GLYPHS) ? "," : "") << "\n";
+        output << "    };\n";
+        writeArray(output, "FONT_ATLAS", pixels.data(), pixels.size());
+        SDL_FreeSurface(atlas);
+
+        return true;
+    }
+
+    bool bakeVisibilitySet(std::ofstream &output, const std::string &path)
+    {
+        MapManager mapManager;
+        VisibilitySet visibilitySet;
+        if (!visibilitySet.loadOrCompute(path, mapManager))
+        {
+            std::cerr << "Could not compute the PVS of the default map" << std::endl;
+            return false;
+        }
+
+        std::ifstream input(path, std::ios::binary);
+        std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        if (bytes.empty())
+        {
+            std::cerr << "Could not read " << path << std::endl;
+            return false;
+        }
+
+        output << "\n    // " << path << "\n";
+        writeArray(output, "DEFAULT_PVS", bytes.data(), bytes.size());
+
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: assetbaker <imports directory> <output header>" << std::endl;
+        return -1;
+    }
+    const std::string importsPath = argv[1];
+    const std::string outputPath = argv[2];
+
+    if (TTF_Init() != 0)
+    {
+        std::cerr << "Could not initialise SDL_ttf: " << SDL_GetError() << std::endl;
+        return -1;
+    }
+
+    std::ofstream output(outputPath, std::ios::trunc);
+    if (!output.is_open())
+    {
+        std::cerr << "Could not create " << outputPath << std::endl;
+        TTF_Quit();
+        return -1;
+    }
+
+    output << "#pragma once\n\n// Generated by tools/AssetBaker.cpp (\"make bake\"), do not edit\n\n#include \"SDL.h\"\n\nnamespace BakedAssets\n{\n";
+    bool isSuccess = bakeSpriteTexture(output, importsPath + "/texture/circle.bmp")
+                  && bakeFontAtlas(output, importsPath + "/fonts/retro_computer_personal_use.ttf")
+                  && bakeVisibilitySet(output, importsPath + "/default.pvs");
+    output << "}\n";
+    output.close();
+    TTF_Quit();
+
+    if (!isSuccess || !output)
+    {
+        std::remove(outputPath.c_str());
+        return -1;
+    }
+
+    std::cout << "Baked " << outputPath << std::endl;
+    return 0;
+}
\ No newline at end of file